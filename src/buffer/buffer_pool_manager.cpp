@@ -15,6 +15,7 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
 }
 
 BufferPoolManager::~BufferPoolManager() {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     for (auto page : page_table_) {
         FlushPage(page.first);
     }
@@ -26,6 +27,7 @@ BufferPoolManager::~BufferPoolManager() {
  * TODO: Student Implement
  */
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     if (page_id >= MAX_VALID_PAGE_ID || page_id <= INVALID_PAGE_ID) {
         LOG(ERROR) << "Invalid page id: " << page_id;
         return nullptr;
@@ -65,6 +67,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
  * TODO: Student Implement
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     frame_id_t frame_id = FindFreePage();
     if (frame_id == INVALID_PAGE_ID) return nullptr;
 
@@ -91,6 +94,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
  * TODO: Student Implement
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     auto it = page_table_.find(page_id);
 
     // 不再buffer pool中
@@ -116,6 +120,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
  * TODO: Student Implement
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     auto it = page_table_.find(page_id);
     if (it == page_table_.end()) return false;
 
@@ -142,6 +147,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
  * TODO: Student Implement
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     auto it = page_table_.find(page_id);
     if (it == page_table_.end()) return false;
 
@@ -176,11 +182,13 @@ void BufferPoolManager::DeallocatePage(__attribute__((unused)) page_id_t page_id
 }
 
 bool BufferPoolManager::IsPageFree(page_id_t page_id) {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     return disk_manager_->IsPageFree(page_id);
 }
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
     bool res = true;
     for (size_t i = 0; i < pool_size_; i++) {
         if (pages_[i].pin_count_ != 0) {
@@ -113,7 +113,8 @@ CatalogManager::~CatalogManager() {
 /**
  * TODO: Student Implement
  */
-dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info) {
+dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Txn *txn, TableInfo *&table_info,
+                                    TableLayout layout) {
   // 检查表名是否已存在，防止重复创建
   if (table_names_.find(table_name) != table_names_.end()) {
     return DB_TABLE_ALREADY_EXIST;  // 若表名已存在，返回错误码
@@ -133,7 +134,7 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
 
   // 创建表堆，用于实际存储表的数据
   TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, copied_schema, txn, log_manager_,
-                                            lock_manager_);  // 这个Create函数会自动分配有一个root_page_id
+                                            lock_manager_, layout);  // 这个Create函数会自动分配有一个root_page_id
   if (table_heap == nullptr) {
     // 如果表堆创建失败，释放之前分配的元数据页
     buffer_pool_manager_->DeletePage(meta_page_id);
@@ -146,7 +147,7 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   // root_page_id是表堆的第一个页面ID
   
   // 创建表的元数据，包括表ID、表名、根页ID和表结构
-  TableMetadata *table_meta = TableMetadata::Create(table_id, table_name, root_page_id, copied_schema);
+  TableMetadata *table_meta = TableMetadata::Create(table_id, table_name, root_page_id, copied_schema, layout);
   if (table_meta == nullptr) {
     // 如果表元数据创建失败，释放之前分配的表堆和元数据页
     table_heap->DeleteTable();
@@ -209,7 +210,7 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
  */
 dberr_t CatalogManager::CreateIndex(const string &table_name, const string &index_name,
                                     const vector<string> &index_keys, Txn *txn, IndexInfo *&index_info,
-                                    const string &index_type) {
+                                    const string &index_type, bool unique) {
   // 检查表是否存在
   TableInfo *table_info = nullptr;
   if (GetTable(table_name, table_info) != DB_SUCCESS) {
@@ -219,6 +220,11 @@ dberr_t CatalogManager::CreateIndex(const string &table_name, const string &inde
   if (index_names_[table_name].find(index_name) != index_names_[table_name].end()) {
     return DB_INDEX_ALREADY_EXIST;
   }
+  // 支持 B+ 树索引、哈希索引、LSM 索引和学习索引
+  if (index_type != "bptree" && index_type != "hash" && index_type != "lsm" && index_type != "learned") {
+    LOG(WARNING) << "Unknown index type: " << index_type;
+    return DB_FAILED;
+  }
 
   // 检查索引键是否有效，并生成 key_map_
   // key_map_ 用于将索引键映射到表的列索引(就是第几列)
@@ -231,6 +237,15 @@ dberr_t CatalogManager::CreateIndex(const string &table_name, const string &inde
     }
     key_map.push_back(col_index);
   }
+  // 键长超过索引页能放下的上限时拒绝建索引
+  uint32_t projected_size = 0;
+  for (auto col_index : key_map) {
+    projected_size += KeyProjector::GetColumnKeySize(schema->GetColumn(col_index));
+  }
+  if (IndexInfo::GetKeySize(projected_size, unique, index_type) == 0) {
+    LOG(WARNING) << "Index key of " << projected_size << " bytes is too large for a " << index_type << " index";
+    return DB_FAILED;
+  }
 
   // 步骤5: 分配新的索引ID
   index_id_t index_id = next_index_id_.fetch_add(1);  // 原子操作，获取唯一索引ID
@@ -241,7 +256,7 @@ dberr_t CatalogManager::CreateIndex(const string &table_name, const string &inde
   if (meta_page == nullptr) return DB_FAILED;
 
   // 创建索引的元数据
-  IndexMetadata *index_meta = IndexMetadata::Create(index_id, index_name, table_info->GetTableId(), key_map);
+  IndexMetadata *index_meta = IndexMetadata::Create(index_id, index_name, table_info->GetTableId(), key_map, unique, index_type);
   // 序列化索引的元数据到页面
   index_meta->SerializeTo(meta_page->GetData());
   
@@ -431,7 +446,7 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
 
   // 创建表堆
   TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->GetSchema(),
-                                            log_manager_, lock_manager_);
+                                            log_manager_, lock_manager_, table_meta->GetLayout());
 
   // 创建表信息对象
   TableInfo *table_info = TableInfo::Create();
@@ -1,12 +1,17 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, bool unique, const std::string &index_type)
+    : index_id_(index_id),
+      index_name_(index_name),
+      table_id_(table_id),
+      key_map_(key_map),
+      unique_(unique),
+      index_type_(index_type) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, bool unique, const std::string &index_type) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, unique, index_type);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -35,6 +40,14 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf, col_index);
     buf += 4;
   }
+  // unique
+  MACH_WRITE_TO(char, buf, static_cast<char>(unique_));
+  buf += 1;
+  // index type
+  MACH_WRITE_UINT32(buf, index_type_.length());
+  buf += 4;
+  MACH_WRITE_STRING(buf, index_type_);
+  buf += index_type_.length();
   ASSERT(buf - p == ofs, "Unexpected serialize size.");
   return ofs;
 }
@@ -48,7 +61,9 @@ uint32_t IndexMetadata::GetSerializedSize() const {
          MACH_STR_SERIALIZED_SIZE(index_name_) +  // index_name_ 的大小
          4 +                                      // table_id_ 的大小
          4 +                                      // key count : key_map_ 数组大小字段的大小
-         4 * key_map_.size();                     // key_map_ 数组内容的大小 (每个uint32_t占4字节)
+         4 * key_map_.size() +                    // key_map_ 数组内容的大小 (每个uint32_t占4字节)
+         1 +                                      // unique_
+         MACH_STR_SERIALIZED_SIZE(index_type_);   // index_type_
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
@@ -59,6 +74,11 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
   // magic num
   uint32_t magic_num = MACH_READ_UINT32(buf);
   buf += 4;
+  if (magic_num == INDEX_METADATA_MAGIC_NUM_V0) {
+    // 旧格式索引的 B+ 树页还是原来的键编码，读不了，只能删掉重建
+    LOG(ERROR) << "Index metadata in an old format, drop and recreate the index." << std::endl;
+    return buf - p;
+  }
   ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM, "Failed to deserialize index info.");
   // index id
   index_id_t index_id = MACH_READ_FROM(index_id_t, buf);
@@ -81,40 +101,55 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     buf += 4;
     key_map.push_back(key_index);
   }
+  // unique
+  bool unique = static_cast<bool>(MACH_READ_FROM(char, buf));
+  buf += 1;
+  // index type
+  uint32_t type_len = MACH_READ_UINT32(buf);
+  buf += 4;
+  std::string index_type(buf, type_len);
+  buf += type_len;
   // allocate space for index meta data
-  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, unique, index_type);
   return buf - p;
 }
 
-Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  uint32_t column_cnt = key_schema_->GetColumns().size();
-  size_t size_bitmap = (column_cnt % 8) ? column_cnt / 8 + 1 : column_cnt / 8;
-  // column_cnt + bitmap
-  max_size += 4 + sizeof(unsigned char) * size_bitmap;
-  for (auto col : key_schema_->GetColumns()) {
-    // length of char column
-    if (col->GetType() == TypeId::kTypeChar) max_size += 4;
-    max_size += col->GetLength();
+size_t IndexInfo::GetKeySize(uint32_t projected_size, bool unique, const std::string &index_type) {
+  // normalized key: null flag + fixed width value per column, rounded up to keep the values behind it aligned.
+  // 非唯一 B+ 树和 LSM 索引的键后面还要拼上 8 字节的 RowId，哈希桶和学习索引的条目本身就带着 RowId
+  bool row_id_suffix = !unique && index_type != "hash" && index_type != "learned";
+  size_t key_size = (projected_size + (row_id_suffix ? sizeof(int64_t) : 0) + 3) / 4 * 4;
+  // B+ 树页中的键去掉了公共前缀和末尾的 0，按实际长度存放，这里只限制最坏情况下一页要放得下的键长
+  size_t max_key_size = BPlusTreePage::MAX_KEY_SIZE;
+  if (index_type == "hash") {
+    max_key_size = HashTableBucketPage::MAX_KEY_SIZE;
+  } else if (index_type == "lsm") {
+    max_key_size = LsmRunPage::MAX_KEY_SIZE;
+  } else if (index_type == "learned") {
+    // 学习索引把键当作整数来拟合，只支持 8 字节以内的键，即单个 INT 或 FLOAT 列
+    max_key_size = sizeof(uint64_t);
   }
+  return key_size <= max_key_size ? key_size : 0;
+}
 
-  if (index_type == "bptree") {
-    if (max_size <= 8)
-      max_size = 16;
-    else if (max_size <= 24)
-      max_size = 32;
-    else if (max_size <= 56)
-      max_size = 64;
-    else if (max_size <= 120)
-      max_size = 128;
-    else if (max_size <= 248)
-      max_size = 256;
-    else {
-      LOG(ERROR) << "GenericKey size is too large";
-      return nullptr;
-    }
-  } else {
+Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
+  bool unique = meta_data_->IsUnique();
+  size_t max_size = GetKeySize(key_projector_.GetKeySize(), unique, index_type);
+  if (max_size == 0) {
+    LOG(ERROR) << "GenericKey size is too large";
     return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  if (index_type == "bptree") {
+    return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique);
+  }
+  if (index_type == "hash") {
+    return new HashIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique);
+  }
+  if (index_type == "lsm") {
+    return new LsmIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique);
+  }
+  if (index_type == "learned") {
+    return new LearnedIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique);
+  }
+  return nullptr;
 }
@@ -15,16 +15,32 @@ void DeleteExecutor::Init() {
   txn_ = exec_ctx_->GetTransaction();
 }
 
+/*
+ * 第一次调用时删除全部行，每个索引的条目再批量删除：按 key 排序后一次走完 B+ 树
+ */
 bool DeleteExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-  if (child_executor_->Next(row, rid)) {
-    if (!table_info_->GetTableHeap()->MarkDelete(*rid, txn_)) {
-      return false;
+  if (!deleted_) {
+    deleted_ = true;
+    Row child_row;
+    RowId child_rid;
+    while (child_executor_->Next(&child_row, &child_rid)) {
+      if (!table_info_->GetTableHeap()->MarkDelete(child_rid, txn_)) {
+        break;
+      }
+      child_row.SetRowId(child_rid);
+      deleted_rows_.push_back(child_row);
+    }
+    std::vector<const Row *> rows;
+    for (const auto &deleted_row : deleted_rows_) {
+      rows.push_back(&deleted_row);
     }
-    Row key_row;
     for (auto info : index_info_) {  // 更新索引
-      row->GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-      info->GetIndex()->RemoveEntry(key_row, *rid, txn_);
+      info->GetIndex()->RemoveRowEntries(rows, info->GetKeyProjector(), txn_);
     }
+  }
+  if (next_row_ < deleted_rows_.size()) {
+    *row = deleted_rows_[next_row_++];
+    *rid = row->GetRowId();
     return true;
   }
   return false;
@@ -106,7 +106,7 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
     Row row{};
     while (executor->Next(&row, &rid)) {
       if (result_set != nullptr) {
-        result_set->push_back(row);
+        result_set->push_back(std::move(row));
       }
     }
   } catch (const exception &ex) {
@@ -155,6 +155,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteTrxRollback(ast, context.get());
     case kNodeExecFile:
       return ExecuteExecfile(ast, context.get());
+    case kNodeVacuum:
+      return ExecuteVacuum(ast, context.get());
     case kNodeQuit:
       return ExecuteQuit(ast, context.get());
     default:
@@ -167,6 +169,14 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
     planner.PlanQuery(ast);
     // Execute the query.
     ExecutePlan(planner.plan_, &result_set, nullptr, context.get());
+    // Vacuum the table once enough dead tuples piled up.
+    if (ast->type_ == kNodeDelete || ast->type_ == kNodeUpdate) {
+      TableInfo *table_info = nullptr;
+      if (context->GetCatalog()->GetTable(ast->child_->val_, table_info) == DB_SUCCESS &&
+          table_info->GetTableHeap()->GetDeadTupleCount() >= AUTO_VACUUM_THRESHOLD) {
+        VacuumTable(table_info, context.get());
+      }
+    }
   } catch (const exception &ex) {
     std::cout << "Error Encountered in Planner: " << ex.what() << std::endl;
     return DB_FAILED;
@@ -557,12 +567,26 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     index++;
   }
 
+  // 解析表的存储布局 with (layout = row | pax)
+  TableLayout layout = TableLayout::kRow;
+  pSyntaxNode layout_node = col_def_list_node->next_;
+  if (layout_node != nullptr && layout_node->type_ == kNodeTableLayout) {
+    std::string layout_str(layout_node->val_);
+    if (layout_str == "pax") {
+      layout = TableLayout::kPax;
+    } else if (layout_str != "row") {
+      LOG(ERROR) << "Syntax error: Unknown table layout '" << layout_str << "', expected row or pax.";
+      for (auto column : columns) delete column;
+      return DB_FAILED;
+    }
+  }
+
   // 根据columns创建Schema
   TableSchema *schema = new TableSchema(columns, true);
 
   // 调用CatalogManager的CreateTable方法
   TableInfo *table_info = nullptr;
-  dberr_t create_result = catalog_manager->CreateTable(table_name, schema, txn, table_info);
+  dberr_t create_result = catalog_manager->CreateTable(table_name, schema, txn, table_info, layout);
 
   delete schema; // 释放Schema内存(如果CreateTable成功，里面是深拷贝会开新的Schema对象)
   schema = nullptr;
@@ -657,6 +681,9 @@ dberr_t ExecuteEngine::ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *conte
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteShowIndexes" << std::endl;
 #endif
+  if (ast->val_ != nullptr && strcmp(ast->val_, "stats") == 0) {
+    return ExecuteShowIndexStats(context);
+  }
   
   // 验证执行上下文和数据库选择状态
   if (context == nullptr || current_db_.empty()) {
@@ -762,6 +789,74 @@ dberr_t ExecuteEngine::ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *conte
   return DB_SUCCESS;
 }
 
+dberr_t ExecuteEngine::ExecuteShowIndexStats(ExecuteContext *context) {
+  if (context == nullptr || current_db_.empty()) {
+    std::cout << "No database selected." << std::endl;
+    return DB_FAILED;
+  }
+  std::vector<std::string> header{"Table", "Index", "Type", "Height", "Leaf_pages", "Internal_pages", "Entries",
+                                  "Leaf_fill", "Internal_fill", "Splits", "Merges"};
+  std::vector<std::vector<std::string>> rows;
+  auto percent = [](double fill) {
+    std::stringstream ss;
+    ss << fixed << setprecision(1) << fill * 100 << "%";
+    return ss.str();
+  };
+  std::vector<TableInfo *> tables;
+  context->GetCatalog()->GetTables(tables);
+  for (auto table_info : tables) {
+    std::vector<IndexInfo *> indexes;
+    context->GetCatalog()->GetTableIndexes(table_info->GetTableName(), indexes);
+    for (auto index_info : indexes) {
+      std::vector<std::string> row{table_info->GetTableName(), index_info->GetIndexName(),
+                                   index_info->GetIndexType()};
+      IndexStats stats;
+      if (index_info->GetIndex()->GetStats(&stats) == DB_SUCCESS) {
+        row.insert(row.end(), {std::to_string(stats.height_), std::to_string(stats.leaf_pages_),
+                               std::to_string(stats.internal_pages_), std::to_string(stats.entries_),
+                               percent(stats.leaf_fill_factor_), percent(stats.internal_fill_factor_),
+                               std::to_string(stats.splits_), std::to_string(stats.merges_)});
+      } else {
+        // 不是页组成的树，没有这些统计
+        row.resize(header.size(), "-");
+      }
+      rows.push_back(std::move(row));
+    }
+  }
+  if (rows.empty()) {
+    std::cout << "No index exists in database '" << current_db_ << "'." << std::endl;
+    return DB_SUCCESS;
+  }
+  std::vector<int> widths;
+  for (const auto &name : header) {
+    widths.push_back(static_cast<int>(name.length()));
+  }
+  for (const auto &row : rows) {
+    for (size_t i = 0; i < row.size(); i++) {
+      widths[i] = std::max(widths[i], static_cast<int>(row[i].length()));
+    }
+  }
+  std::stringstream output_stream;
+  ResultWriter writer(output_stream);
+  writer.Divider(widths);
+  writer.BeginRow();
+  for (size_t i = 0; i < header.size(); i++) {
+    writer.WriteHeaderCell(header[i], widths[i]);
+  }
+  writer.EndRow();
+  writer.Divider(widths);
+  for (const auto &row : rows) {
+    writer.BeginRow();
+    for (size_t i = 0; i < row.size(); i++) {
+      writer.WriteCell(row[i], widths[i]);
+    }
+    writer.EndRow();
+  }
+  writer.Divider(widths);
+  std::cout << output_stream.str();
+  return DB_SUCCESS;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -790,6 +885,8 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     return DB_FAILED;
   }
   std::string index_name(ast->child_->val_);
+  // CREATE UNIQUE INDEX 拒绝重复键，普通索引允许同一个键对应多行
+  bool unique = ast->val_ != nullptr && strcmp(ast->val_, "unique") == 0;
 
   // 解析表名
   pSyntaxNode table_name_node = ast->child_->next_;
@@ -864,7 +961,7 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
   // 在CatalogManager中创建索引
   IndexInfo *created_index_info = nullptr;
   dberr_t create_index_result = catalog_manager->CreateIndex(
-      table_name, index_name, index_column_names, txn, created_index_info, index_type);
+      table_name, index_name, index_column_names, txn, created_index_info, index_type, unique);
 
   if (create_index_result != DB_SUCCESS) {
     ExecuteInformation(create_index_result);
@@ -888,35 +985,25 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     return DB_FAILED;
   }
 
-  // 遍历表中现有记录并插入到索引中
-  for (TableIterator table_iter = table_heap->Begin(txn); table_iter != table_heap->End(); ++table_iter) {
-    Row current_row(table_iter->GetRowId());
-    if (!table_heap->GetTuple(&current_row, txn)) {
-      LOG(WARNING) << "Failed to get tuple for rowid (Page: " << table_iter->GetRowId().GetPageId() 
-                   << ", Slot: " << table_iter->GetRowId().GetSlotNum() << ") during index population for " << index_name;
-      continue; 
-    }
-    
-    RowId row_id = current_row.GetRowId();
-
-    // 构建索引键行
-    std::vector<Field> index_key_fields;
-    index_key_fields.reserve(column_index_mapping.size());
-    for (uint32_t column_index : column_index_mapping) {
-      index_key_fields.push_back(*(current_row.GetField(column_index))); 
-    }
-    Row index_key_row(index_key_fields);
-
-    // 将记录插入索引
-    if (index_structure->InsertEntry(index_key_row, row_id, txn) != DB_SUCCESS) {
-      LOG(ERROR) << "Failed to insert entry into index '" << index_name << "' for rowid (Page: " 
-                 << row_id.GetPageId() << ", Slot: " << row_id.GetSlotNum()
-                 << ") during initial population.";
-      catalog_manager->DropIndex(table_name, index_name);
-      return DB_FAILED;
+  // 遍历表中现有记录，排序后自底向上批量构建索引，键直接从整行投影得到
+  const KeyProjector &key_projector = created_index_info->GetKeyProjector();
+  TableIterator table_iter = table_heap->Begin(txn);
+  bool started = false;
+  auto next_row = [&]() -> const Row * {
+    if (started) {
+      ++table_iter;
     }
+    started = true;
+    return table_iter == table_heap->End() ? nullptr : &*table_iter;
+  };
+  if (index_structure->BulkLoad(next_row, key_projector, txn) != DB_SUCCESS) {
+    // 唯一索引遇到重复键会使批量构建失败
+    LOG(ERROR) << "Failed to populate index '" << index_name << "' from the existing rows of table '" << table_name
+               << "'.";
+    catalog_manager->DropIndex(table_name, index_name);
+    return DB_FAILED;
   }
-  
+
   std::cout << "Index [" << index_name << "] created successfully on table [" << table_name << "]." << std::endl;
   return DB_SUCCESS;
 }
@@ -1153,6 +1240,85 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
 /**
  * TODO: Student Implement
  */
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteVacuum" << std::endl;
+#endif
+  if (context == nullptr || current_db_.empty()) {
+    std::cout << "No database selected." << std::endl;
+    return DB_FAILED;
+  }
+  if (ast->val_ != nullptr && strcmp(ast->val_, "index") == 0) {
+    return ExecuteVacuumIndex(ast->child_->val_, context);
+  }
+  std::string table_name(ast->child_->val_);
+  TableInfo *table_info = nullptr;
+  dberr_t res = context->GetCatalog()->GetTable(table_name, table_info);
+  if (res != DB_SUCCESS) {
+    ExecuteInformation(res);
+    return res;
+  }
+  auto start_time = std::chrono::system_clock::now();
+  uint32_t released = VacuumTable(table_info, context);
+  auto stop_time = std::chrono::system_clock::now();
+  double duration_time =
+      double((std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time)).count());
+  std::cout << "Table [" << table_name << "] vacuumed, " << released << " page(s) released (" << fixed
+            << setprecision(4) << duration_time / 1000 << " sec)." << std::endl;
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteVacuumIndex(const std::string &index_name, ExecuteContext *context) {
+  std::vector<TableInfo *> tables;
+  context->GetCatalog()->GetTables(tables);
+  for (auto table_info : tables) {
+    IndexInfo *index_info = nullptr;
+    if (context->GetCatalog()->GetIndex(table_info->GetTableName(), index_name, index_info) != DB_SUCCESS) {
+      continue;
+    }
+    auto start_time = std::chrono::system_clock::now();
+    int released = 0;
+    dberr_t res = index_info->GetIndex()->Vacuum(&released, context->GetTransaction());
+    if (res != DB_SUCCESS) {
+      ExecuteInformation(res);
+      return res;
+    }
+    auto stop_time = std::chrono::system_clock::now();
+    double duration_time =
+        double((std::chrono::duration_cast<std::chrono::milliseconds>(stop_time - start_time)).count());
+    std::cout << "Index [" << index_name << "] vacuumed, " << std::max(released, 0) << " page(s) released (" << fixed
+              << setprecision(4) << duration_time / 1000 << " sec)." << std::endl;
+    return DB_SUCCESS;
+  }
+  ExecuteInformation(DB_INDEX_NOT_FOUND);
+  return DB_INDEX_NOT_FOUND;
+}
+
+uint32_t ExecuteEngine::VacuumTable(TableInfo *table_info, ExecuteContext *context) {
+  Txn *txn = context->GetTransaction();
+  std::vector<std::pair<RowId, RowId>> moved_rows;
+  uint32_t released = table_info->GetTableHeap()->Vacuum(txn, &moved_rows);
+  if (moved_rows.empty()) {
+    return released;
+  }
+  // 被搬动的行需要同步更新索引中的RowId
+  std::vector<IndexInfo *> indexes;
+  context->GetCatalog()->GetTableIndexes(table_info->GetTableName(), indexes);
+  for (const auto &moved : moved_rows) {
+    Row row(moved.second);
+    if (!table_info->GetTableHeap()->GetTuple(&row, txn)) {
+      LOG(WARNING) << "Vacuumed row (Page: " << moved.second.GetPageId() << ", Slot: " << moved.second.GetSlotNum()
+                   << ") not found.";
+      continue;
+    }
+    for (auto index_info : indexes) {
+      index_info->GetIndex()->RemoveRowEntry(row, index_info->GetKeyProjector(), moved.first, txn);
+      index_info->GetIndex()->InsertRowEntry(row, index_info->GetKeyProjector(), moved.second, txn);
+    }
+  }
+  return released;
+}
+
 dberr_t ExecuteEngine::ExecuteQuit(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteQuit" << std::endl;
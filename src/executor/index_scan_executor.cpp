@@ -1,18 +1,159 @@
 #include "executor/executors/index_scan_executor.h"
 
-class RowidCompare {
- public:
-  bool operator()(RowId rid1, RowId rid2) { return rid1.Get() < rid2.Get(); }
-};
+#include <algorithm>
+
+#include "index/skip_scan_iterator.h"
 
 IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
+/**
+ * The scan is driven by a single index: the one whose key columns take the tightest key range from the predicate,
+ * equalities first and a hash index for them, then one covering the query. An index skip-scanned past its first key
+ * column only comes before a full scan. Its row ids are read lazily from the index, the other conditions are checked
+ * on the rows. Rows of a covering index are rebuilt from its keys.
+ */
 void IndexScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  result_ = IndexScan(plan_->GetPredicate());
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), plan_->OutputSchema());
+  vector<AbstractExpressionRef> conditions;
+  CollectConditions(plan_->GetPredicate(), conditions);
+  auto covers = [this](IndexInfo *index) {
+    const auto &covering = plan_->covering_indexes_;
+    return std::find(covering.begin(), covering.end(), index) != covering.end();
+  };
+  auto score = [&covers](IndexInfo *index, const KeyRange &range) {
+    int bounds = static_cast<int>(range.prefix_.size()) * 3 + (range.lower_ ? 1 : 0) + (range.upper_ ? 1 : 0);
+    bool hash = index->GetIndexType() == "hash";
+    // a hash index reads all of its buckets for anything but an equality on every key column
+    if (hash && range.prefix_.size() != index->GetKeyProjector().GetKeyMap().size()) return -1;
+    int rank = range.skip_ ? 1 : (bounds > 0 ? 2 : 0);
+    return rank * 1000 + bounds * 4 + (hash ? 2 : 0) + (covers(index) ? 1 : 0);
+  };
+  IndexInfo *scan_index = nullptr;
+  KeyRange scan_range;
+  for (auto index : plan_->indexes_) {
+    KeyRange range = MakeRange(index, conditions);
+    if (scan_index == nullptr || score(index, range) > score(scan_index, scan_range)) {
+      scan_index = index;
+      scan_range = std::move(range);
+    }
+  }
+  index_only_ = covers(scan_index);
+  key_map_ = scan_index->GetKeyProjector().GetKeyMap();
+  char_widths_.clear();
+  for (auto col_id : key_map_) {
+    const Column *column = table_info_->GetSchema()->GetColumn(col_id);
+    char_widths_.push_back(column->GetType() == TypeId::kTypeChar ? column->GetLength() : 0);
+  }
+  if (index_only_) {
+    null_fields_.clear();
+    for (auto column : table_info_->GetSchema()->GetColumns()) {
+      null_fields_.emplace_back(column->GetType());
+    }
+  }
+  // a bound of the prefix alone takes in every key starting with it
+  std::vector<Field> lower(scan_range.prefix_);
+  std::vector<Field> upper(scan_range.prefix_);
+  bool lower_inclusive = !scan_range.lower_ || scan_range.lower_inclusive_;
+  bool upper_inclusive = !scan_range.upper_ || scan_range.upper_inclusive_;
+  if (scan_range.lower_) lower.push_back(*scan_range.lower_);
+  if (scan_range.upper_) upper.push_back(*scan_range.upper_);
+  if (scan_range.skip_) {
+    iterator_ = std::make_unique<SkipScanIterator>(scan_index->GetIndex(), std::move(lower), lower_inclusive,
+                                                   std::move(upper), upper_inclusive);
+  } else {
+    std::optional<Row> lower_key;
+    std::optional<Row> upper_key;
+    if (!lower.empty()) lower_key.emplace(std::move(lower));
+    if (!upper.empty()) upper_key.emplace(std::move(upper));
+    iterator_ = scan_index->GetIndex()->Scan(lower_key ? &*lower_key : nullptr, lower_inclusive,
+                                             upper_key ? &*upper_key : nullptr, upper_inclusive, nullptr);
+  }
+  // nulls sort first in the index, a range open below meets them and they match no comparison; a cut bound widens
+  // the range past what the predicate matches
+  filter_ = plan_->need_filter_ || scan_range.conditions_used_ < conditions.size() ||
+            (scan_range.upper_ && !scan_range.lower_) || scan_range.cut_;
+}
+
+void IndexScanExecutor::CollectConditions(const AbstractExpressionRef &predicate,
+                                          vector<AbstractExpressionRef> &conditions) {
+  if (predicate->GetType() == ExpressionType::LogicExpression) {
+    CollectConditions(predicate->GetChildAt(0), conditions);
+    CollectConditions(predicate->GetChildAt(1), conditions);
+  } else {
+    conditions.push_back(predicate);
+  }
+}
+
+/*
+ * Key columns are taken in order while each is compared = to a constant, the first one that is not takes the other
+ * comparisons against constants as bounds. <>, is, not, a second equality on a column and a second bound on the same
+ * end are left to the filter.
+ */
+IndexScanExecutor::KeyRange IndexScanExecutor::MakeRange(IndexInfo *index,
+                                                         const vector<AbstractExpressionRef> &conditions) {
+  KeyRange range;
+  const auto &key_map = index->GetKeyProjector().GetKeyMap();
+  // comparisons of a column against a constant, with their comparison operator
+  vector<std::pair<uint32_t, std::string>> comparisons(conditions.size(), {UINT32_MAX, ""});
+  for (size_t i = 0; i < conditions.size(); i++) {
+    const auto &condition = conditions[i];
+    if (condition->GetType() != ExpressionType::ComparisonExpression) continue;
+    auto column = dynamic_pointer_cast<ColumnValueExpression>(condition->GetChildAt(0));
+    if (column == nullptr || condition->GetChildAt(1)->GetType() != ExpressionType::ConstantExpression) continue;
+    std::string op = dynamic_pointer_cast<ComparisonExpression>(condition)->GetComparisonType();
+    if (op == "=" || op == "<" || op == "<=" || op == ">" || op == ">=") {
+      comparisons[i] = {column->GetColIdx(), op};
+    }
+  }
+  auto compared = [&comparisons](uint32_t col_id) {
+    return std::any_of(comparisons.begin(), comparisons.end(),
+                       [col_id](const std::pair<uint32_t, std::string> &c) { return c.first == col_id; });
+  };
+  // the constant of conditions[i] as a bound on key column key_col; a char constant longer than the column is cut
+  // to it in the key, which only stored values up to the column length can match
+  auto bound = [&](size_t i, size_t key_col, bool *cut) {
+    Field value = conditions[i]->GetChildAt(1)->Evaluate(nullptr);
+    const Column *column = index->GetIndexKeySchema()->GetColumn(key_col);
+    *cut = value.GetTypeId() == TypeId::kTypeChar && !value.IsNull() && value.GetLength() > column->GetLength();
+    range.cut_ = range.cut_ || *cut;
+    return value;
+  };
+  size_t key_col = 0;
+  // an ordered index skips its first key column if the predicate leaves it out
+  if (index->GetIndexType() != "hash" && key_map.size() > 1 && !compared(key_map[0])) {
+    range.skip_ = true;
+    key_col = 1;
+  }
+  for (; key_col < key_map.size(); key_col++) {
+    auto equality = std::find(comparisons.begin(), comparisons.end(), std::make_pair(key_map[key_col], string("=")));
+    if (equality == comparisons.end()) break;
+    bool cut;
+    range.prefix_.push_back(bound(equality - comparisons.begin(), key_col, &cut));
+    range.conditions_used_++;
+  }
+  if (key_col == key_map.size()) {
+    return range;
+  }
+  for (size_t i = 0; i < conditions.size(); i++) {
+    if (comparisons[i].first != key_map[key_col]) continue;
+    const std::string &op = comparisons[i].second;
+    bool lower = op == ">" || op == ">=";
+    if ((lower && range.lower_) || (!lower && range.upper_)) continue;
+    bool cut;
+    Field value = bound(i, key_col, &cut);
+    // a cut constant sorts after its cut key, which then has to be taken in: < "abcx" holds "abc" in a char(3)
+    if (lower) {
+      range.lower_.emplace(value);
+      range.lower_inclusive_ = op == ">=" || cut;
+    } else {
+      range.upper_.emplace(value);
+      range.upper_inclusive_ = op == "<=" || cut;
+    }
+    range.conditions_used_++;
+  }
+  return range;
 }
 
 bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *output_schema) {
@@ -41,68 +182,49 @@ void IndexScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *
     auto idx = column->GetTableInd();
     dest_row.emplace_back(*row->GetField(idx));
   }
-  *output_row = Row(dest_row);
-}
-
-vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
-  switch (predicate->GetType()) {
-    case ExpressionType::LogicExpression: {
-      vector<RowId> lhs = IndexScan(predicate->GetChildAt(0));
-      vector<RowId> rhs = IndexScan(predicate->GetChildAt(1));
-      // The function cannot differentiate between the case where the number of rows that
-      // meet the criteria in the indexed column is zero and the case where the column is
-      // not indexed. Writing it this way will ignore the filtering effect brought about
-      // by having zero rows that meet the criteria in the indexed column.
-      if (plan_->need_filter_) {
-        if (lhs.empty()) return rhs;
-        if (rhs.empty()) return lhs;
-      }
-      sort(lhs.begin(), lhs.end(), RowidCompare());
-      sort(rhs.begin(), rhs.end(), RowidCompare());
-      vector<RowId> result;
-      set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), back_inserter(result), RowidCompare());
-      return result;
-    }
-    case ExpressionType::ComparisonExpression: {
-      std::vector<RowId> ret;
-      std::vector<Field> fields{predicate->GetChildAt(1)->Evaluate(nullptr)};
-      Row key(fields);
-      for (auto index : plan_->indexes_) {
-        uint32_t col_idx = dynamic_pointer_cast<ColumnValueExpression>(predicate->GetChildAt(0))->GetColIdx();
-        if (col_idx == index->GetIndexKeySchema()->GetColumn(0)->GetTableInd()) {
-          index->GetIndex()->ScanKey(key, ret, nullptr,
-                                     dynamic_pointer_cast<ComparisonExpression>(predicate)->GetComparisonType());
-          break;
-        }
-      }
-      return ret;
-    }
-    default:
-      break;
-  }
+  *output_row = Row(std::move(dest_row));
 }
 
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
   auto table_schema = table_info_->GetSchema();
-  while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
-    if (plan_->need_filter_) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        cursor_++;
-        delete p_row;
+  RowId row_id;
+  Row key;
+  while (index_only_ ? iterator_->NextEntry(&row_id, &key) : iterator_->Next(&row_id)) {
+    Row p_row(row_id);
+    // a char key as long as its column may have been cut from a longer value stored before lengths were checked,
+    // such a row is read from the table heap and checked against the predicate
+    bool cut = false;
+    for (size_t i = 0; index_only_ && !cut && i < char_widths_.size(); i++) {
+      const Field *field = key.GetField(i);
+      cut = char_widths_[i] != 0 && !field->IsNull() && field->GetLength() >= char_widths_[i];
+    }
+    if (index_only_ && !cut) {
+      // the columns outside the key are never read, they stay null
+      std::vector<Field> fields(null_fields_);
+      for (size_t i = 0; i < key_map_.size(); i++) {
+        fields[key_map_[i]] = *key.GetField(i);
+      }
+      p_row = Row(std::move(fields));
+      p_row.SetRowId(row_id);
+    } else {
+      table_info_->GetTableHeap()->GetTuple(&p_row, nullptr);
+      for (size_t i = 0; !cut && i < char_widths_.size(); i++) {
+        const Field *field = p_row.GetField(key_map_[i]);
+        cut = char_widths_[i] != 0 && !field->IsNull() && field->GetLength() > char_widths_[i];
+      }
+    }
+    if (filter_ || cut) {
+      if (!predicate->Evaluate(&p_row).CompareEquals(Field(kTypeInt, 1))) {
         continue;
       }
     }
-    *rid = result_[cursor_];
+    *rid = row_id;
     if (!is_schema_same_) {
-      TupleTransfer(table_schema, plan_->OutputSchema(), p_row, row);
+      TupleTransfer(table_schema, plan_->OutputSchema(), &p_row, row);
     } else {
-      *row = *p_row;
+      *row = std::move(p_row);
     }
-    delete p_row;
-    cursor_++;
     return true;
   }
   return false;
@@ -4,6 +4,9 @@
 
 #include "executor/executors/insert_executor.h"
 
+#include <string>
+#include <unordered_set>
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -15,28 +18,70 @@ void InsertExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->GetTableName(), index_info_);
 }
 
+/*
+ * 第一次调用时插入全部行：唯一索引先批量检查所有 key，行按顺序插入到第一个重复 key 之前
+ * （与表中已有的 key 重复，或与前面要插入的行重复），然后每个索引批量插入
+ */
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
+  if (!inserted_) {
+    inserted_ = true;
+    Txn *txn = exec_ctx_->GetTransaction();
+    std::vector<Row> insert_rows;
     Row insert_row;
     RowId insert_rid;
-    if (child_executor_->Next(&insert_row, &insert_rid)) {
-        for (auto info: index_info_) {
-            Row key_row;
-            insert_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), key_row);
-            std::vector<RowId> result;
-            if (!key_row.GetFields().empty() &&
-                info->GetIndex()->ScanKey(key_row, result, exec_ctx_->GetTransaction()) == DB_SUCCESS) {
-                std::cout << "key already exists" << std::endl;
-                return false;
-            }
-        }
-        if (table_info_->GetTableHeap()->InsertTuple(insert_row, exec_ctx_->GetTransaction())) {
-            Row key_row;
-            for (auto info: index_info_) {  // 更新索引
-                insert_row.GetKeyFromRow(schema_, info->GetIndexKeySchema(), key_row);
-                info->GetIndex()->InsertEntry(key_row, insert_row.GetRowId(), exec_ctx_->GetTransaction());
-            }
-            return true;
+    while (child_executor_->Next(&insert_row, &insert_rid)) {
+      insert_rows.push_back(insert_row);
+    }
+    std::vector<const Row *> rows;
+    for (const auto &r : insert_rows) {
+      rows.push_back(&r);
+    }
+    size_t end = rows.size();
+    // 超过列长度的字符串会在索引 key 里被截断，和列长度内的值混在一起，不允许插入
+    for (size_t i = 0; i < end; i++) {
+      const Column *column = rows[i]->GetOverlongColumn(schema_);
+      if (column != nullptr) {
+        std::cout << "value too long for column '" << column->GetName() << "'" << std::endl;
+        end = i;
+        break;
+      }
+    }
+    size_t checked = end;
+    for (auto info : index_info_) {
+      const KeyProjector &projector = info->GetKeyProjector();
+      if (!info->IsUnique() || projector.GetKeyMap().empty()) {
+        continue;
+      }
+      std::vector<std::vector<RowId>> result;
+      info->GetIndex()->ScanRowKeys(rows, projector, result, txn);
+      std::unordered_set<std::string> keys;
+      for (size_t i = 0; i < end; i++) {
+        std::string key(projector.GetKeySize(), '\0');
+        projector.Project(*rows[i], key.data());
+        if (!result[i].empty() || !keys.insert(key).second) {
+          end = i;
+          break;
         }
+      }
+    }
+    if (end < checked) {
+      std::cout << "key already exists" << std::endl;
+    }
+    for (size_t i = 0; i < end; i++) {
+      if (!table_info_->GetTableHeap()->InsertTuple(insert_rows[i], txn)) {
+        end = i;
+        break;
+      }
+    }
+    rows.resize(end);
+    for (auto info : index_info_) {  // 更新索引
+      info->GetIndex()->InsertRowEntries(rows, info->GetKeyProjector(), txn);
+    }
+    inserted_rows_ = end;
+  }
+  if (next_row_ < inserted_rows_) {
+    next_row_++;
+    return true;
   }
   return false;
 }
\ No newline at end of file
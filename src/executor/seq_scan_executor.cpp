@@ -3,6 +3,10 @@
 //
 #include "executor/executors/seq_scan_executor.h"
 
+#include <algorithm>
+
+#include "planner/expressions/column_value_expression.h"
+
 SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan)
     : AbstractExecutor(exec_ctx),
       plan_(plan),
@@ -35,29 +39,93 @@ void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *ou
     auto idx = column->GetTableInd();
     dest_row.emplace_back(*row->GetField(idx));
   }
-  *output_row = Row(dest_row);
+  *output_row = Row(std::move(dest_row));
+}
+
+void SeqScanExecutor::CollectColumns(const AbstractExpressionRef &expr, std::vector<uint32_t> *columns) {
+  if (expr->GetType() == ExpressionType::ColumnExpression) {
+    auto col_idx = dynamic_cast<const ColumnValueExpression *>(expr.get())->GetColIdx();
+    if (std::find(columns->begin(), columns->end(), col_idx) == columns->end()) {
+      columns->push_back(col_idx);
+    }
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
 }
 
 void SeqScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
+  if (table_info_->GetTableHeap()->GetLayout() == TableLayout::kPax) {
+    // PAX表按页扫描：先在列数组上计算谓词，只为满足条件的tuple拼整行
+    pax_rows_.clear();
+    pax_cursor_ = 0;
+    pax_page_id_ = table_info_->GetTableHeap()->GetFirstPageId();
+    filter_columns_.clear();
+    auto predicate = plan_->GetPredicate();
+    if (predicate != nullptr) {
+      CollectColumns(predicate, &filter_columns_);
+      filter_ = [predicate](const Row &row) {
+        return predicate->Evaluate(&row).CompareEquals(Field(kTypeInt, 1)) == CmpBool::kTrue;
+      };
+    }
+    schema_ = plan_->OutputSchema();
+    is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
+    return;
+  }
+  // 溢出页中的长字段先保留为引用，只在被谓词读取或被投影输出时才读出来
+  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction(), false));
   schema_ = plan_->OutputSchema();
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
+  filter_columns_.clear();
+  if (plan_->GetPredicate() != nullptr) {
+    CollectColumns(plan_->GetPredicate(), &filter_columns_);
+  }
+  output_columns_.clear();
+  for (const auto column : schema_->GetColumns()) {
+    output_columns_.push_back(column->GetTableInd());
+  }
+}
+
+bool SeqScanExecutor::NextPaxRow(Row *row, RowId *rid) {
+  while (pax_cursor_ >= pax_rows_.size()) {
+    if (pax_page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    pax_rows_.clear();
+    pax_cursor_ = 0;
+    pax_page_id_ = table_info_->GetTableHeap()->ScanPaxPage(pax_page_id_, filter_columns_, filter_, &pax_rows_,
+                                                            exec_ctx_->GetTransaction());
+  }
+  Row &p_row = pax_rows_[pax_cursor_++];
+  *rid = p_row.GetRowId();
+  if (!is_schema_same_) {
+    TupleTransfer(table_info_->GetSchema(), schema_, &p_row, row);
+  } else {
+    // 这一行已经交出去，不会再被读取
+    *row = std::move(p_row);
+  }
+  return true;
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
+  if (table_info_->GetTableHeap()->GetLayout() == TableLayout::kPax) {
+    return NextPaxRow(row, rid);
+  }
   auto predicate = plan_->GetPredicate();
   auto table_schema = table_info_->GetSchema();
-  while (iterator_ != table_info_->GetTableHeap()->End()) {
-    auto p_row = &(*iterator_);
+  auto table_heap = table_info_->GetTableHeap();
+  while (iterator_ != table_heap->End()) {
+    auto p_row = iterator_.operator->();
     if (predicate != nullptr) {
+      table_heap->LoadOverflowFields(p_row, &filter_columns_);
       if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
         iterator_++;
         continue;
       }
     }
     *rid = iterator_->GetRowId();
+    table_heap->LoadOverflowFields(p_row, is_schema_same_ ? nullptr : &output_columns_);
     if (!is_schema_same_) {
       TupleTransfer(table_schema, schema_, p_row, row);
     } else {
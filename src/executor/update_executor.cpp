@@ -15,22 +15,50 @@ void UpdateExecutor::Init() {
   txn_ = exec_ctx_->GetTransaction();
 }
 
+/*
+ * 第一次调用时更新全部行，每个索引先批量删除旧 key，再批量插入新 key。
+ * 要更新的行先全部读出来：放不下原页的行会挪到表尾，边扫边改会再次扫到它
+ */
 bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-  Row src_row;
-  RowId src_rid;
-  if (child_executor_->Next(&src_row, &src_rid)) {
-    Row dest_row = GenerateUpdatedTuple(src_row);
-    if (!table_info_->GetTableHeap()->UpdateTuple(dest_row, src_rid, txn_)) {
-      return false;
+  if (!updated_) {
+    updated_ = true;
+    std::vector<Row> matched_rows;
+    Row src_row;
+    RowId src_rid;
+    while (child_executor_->Next(&src_row, &src_rid)) {
+      src_row.SetRowId(src_rid);
+      matched_rows.push_back(std::move(src_row));
+    }
+    std::vector<Row> src_rows;
+    std::vector<Row> dest_rows;
+    for (auto &matched_row : matched_rows) {
+      Row dest_row = GenerateUpdatedTuple(matched_row);
+      const Column *column = dest_row.GetOverlongColumn(table_info_->GetSchema());
+      if (column != nullptr) {
+        std::cout << "value too long for column '" << column->GetName() << "'" << std::endl;
+        break;
+      }
+      if (!table_info_->GetTableHeap()->UpdateTuple(dest_row, matched_row.GetRowId(), txn_)) {
+        break;
+      }
+      // a row that no longer fits its page moves, UpdateTuple leaves its new RowId in dest_row
+      src_rows.push_back(std::move(matched_row));
+      dest_rows.push_back(std::move(dest_row));
+    }
+    std::vector<const Row *> src_ptrs;
+    std::vector<const Row *> dest_ptrs;
+    for (size_t i = 0; i < src_rows.size(); i++) {
+      src_ptrs.push_back(&src_rows[i]);
+      dest_ptrs.push_back(&dest_rows[i]);
     }
-    Row src_key_row;
-    Row dest_key_row;
     for (auto info : index_info_) {  // 更新索引
-      src_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), src_key_row);
-      dest_row.GetKeyFromRow(table_info_->GetSchema(), info->GetIndexKeySchema(), dest_key_row);
-      info->GetIndex()->RemoveEntry(src_key_row, src_rid, txn_);
-      info->GetIndex()->InsertEntry(dest_key_row, src_rid, txn_);
+      info->GetIndex()->RemoveRowEntries(src_ptrs, info->GetKeyProjector(), txn_);
+      info->GetIndex()->InsertRowEntries(dest_ptrs, info->GetKeyProjector(), txn_);
     }
+    updated_rows_ = src_rows.size();
+  }
+  if (next_row_ < updated_rows_) {
+    next_row_++;
     return true;
   }
   return false;
@@ -41,6 +69,7 @@ Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row) {
   Schema *schema = table_info_->GetSchema();
   uint32_t col_count = schema->GetColumnCount();
   std::vector<Field> values;
+  values.reserve(col_count);
   for (uint32_t idx = 0; idx < col_count; idx++) {
     if (update_attrs.find(idx) == update_attrs.cend()) {
       values.emplace_back(*src_row.GetField(idx));
@@ -49,5 +78,5 @@ Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row) {
       values.emplace_back(expr->Evaluate(&src_row));
     }
   }
-  return Row{values};
+  return Row{std::move(values)};
 }
\ No newline at end of file
@@ -15,10 +15,11 @@ bool ValuesExecutor::Next(Row *row, RowId *rid) {
   if (cursor_ < value_size_) {
     std::vector<Field> values;
     auto exprs = plan_->GetValues().at(cursor_);
+    values.reserve(exprs.size());
     for (auto expr : exprs) {
       values.emplace_back(expr->Evaluate(nullptr));
     }
-    *row = Row{values};
+    *row = Row{std::move(values)};
     cursor_++;
     return true;
   }
@@ -12,6 +12,10 @@
 
 using namespace std;
 
+/**
+ * Every public method holds latch_, so the buffer pool can be shared by threads. The content of a fetched page is
+ * protected by the page latch (Page::RLatch / Page::WLatch), which the buffer pool never takes.
+ */
 class BufferPoolManager {
  public:
   explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
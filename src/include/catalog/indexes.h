@@ -8,6 +8,9 @@
 #include "common/rowid.h"
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
+#include "index/hash_index.h"
+#include "index/learned_index.h"
+#include "index/lsm_index.h"
 #include "record/schema.h"
 
 class IndexMetadata {
@@ -15,7 +18,8 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, bool unique = true,
+                               const std::string &index_type = "bptree");
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,18 +37,28 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  // a non-unique index may hold several entries with the same key
+  inline bool IsUnique() const { return unique_; }
+
+  // "bptree", "hash", "lsm" or "learned"
+  inline const std::string &GetIndexType() const { return index_type_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, bool unique, const std::string &index_type);
 
  private:
-  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344530;
+  /** metadata written before uniqueness and index type were stored, its tree pages use the old key format */
+  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM_V0 = 344528;
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  bool unique_;
+  std::string index_type_;
 };
 
 /**
@@ -72,10 +86,12 @@ class IndexInfo {
     
     // 创建索引键模式 - 从表模式中选择特定的列作为索引键
     key_schema_ = Schema::ShallowCopySchema(schema, key_map);
+    // 键投影只编译一次，维护索引时直接从整行写出键
+    key_projector_ = KeyProjector(key_schema_, key_map);
     
     // Step3: call CreateIndex to create the index
-    // 根据索引类型创建实际的索引对象 (默认使用B+树索引)
-    index_ = CreateIndex(buffer_pool_manager, "bptree");
+    // 根据索引类型创建实际的索引对象 (B+树索引或哈希索引)
+    index_ = CreateIndex(buffer_pool_manager, meta_data_->GetIndexType());
     
     // 确保索引创建成功
     ASSERT(index_ != nullptr, "Failed to create index.");
@@ -85,8 +101,20 @@ class IndexInfo {
 
   std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
+  bool IsUnique() const { return meta_data_->IsUnique(); }
+
+  const std::string &GetIndexType() const { return meta_data_->GetIndexType(); }
+
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  const KeyProjector &GetKeyProjector() const { return key_projector_; }
+
+  /**
+   * Key size of an index whose projected key takes projected_size bytes, see CreateIndex.
+   * @return 0 if the pages of index_type can not hold keys that large
+   */
+  static size_t GetKeySize(uint32_t projected_size, bool unique, const std::string &index_type);
+
  private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr} {}
 
@@ -96,6 +124,7 @@ class IndexInfo {
   IndexMetadata *meta_data_;
   Index *index_;
   IndexSchema *key_schema_;
+  KeyProjector key_projector_;
 };
 
 #endif  // MINISQL_INDEXES_H
@@ -17,7 +17,24 @@ static constexpr int PAGE_SIZE = 4096;                  // size of a data page i
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE * 64;  // max length of varchar
+static constexpr uint32_t OVERFLOW_THRESHOLD = 256;  // char values longer than this are moved to overflow pages
+static constexpr uint32_t OVERFLOW_LEN_FLAG = 1U << 31;  // set in the serialized length of an overflow reference
+
+static constexpr uint32_t AUTO_VACUUM_THRESHOLD = 1024;  // dead tuples in a table before it is vacuumed automatically
+
+static constexpr double INDEX_FILL_FACTOR = 0.9;  // fraction of a b+ tree node filled when an index is bulk loaded
+static constexpr uint32_t INDEX_SORT_BUFFER_SIZE = 64 << 20;  // bytes of index entries sorted in memory before spilling
+static constexpr uint32_t INDEX_BLOOM_BITS_PER_KEY = 10;  // bloom filter bits per key of a b+ tree index, 0 for none
+// a b+ tree node is merged once it holds less than this fraction of a page: 0.5 merges eagerly, 0 only empty nodes
+static constexpr double INDEX_MERGE_THRESHOLD = 0.25;
+static constexpr uint32_t LSM_MEMTABLE_SIZE = 4 << 20;  // bytes of entries an lsm index buffers before writing a run
+static constexpr uint32_t LSM_GROWTH_FACTOR = 4;  // lsm runs are merged until each is this many times the newer one
+static constexpr uint32_t LEARNED_INDEX_ERROR = 32;  // max entries between the predicted and actual key position
+// a learned index is rebuilt once the entries inserted or removed since its last build reach this fraction of it
+static constexpr double LEARNED_INDEX_REBUILD_RATIO = 0.1;
+// a composite index is skip-scanned past its unconstrained first column if that column has at most this many values
+static constexpr uint32_t SKIP_SCAN_MAX_VALUES = 64;
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
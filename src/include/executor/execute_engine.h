@@ -59,6 +59,9 @@ class ExecuteEngine {
 
   dberr_t ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *context);
 
+  // SHOW INDEX STATS: height, page counts, entry count and fill factors of every index, see Index::GetStats
+  dberr_t ExecuteShowIndexStats(ExecuteContext *context);
+
   dberr_t ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context);
@@ -71,6 +74,17 @@ class ExecuteEngine {
 
   dberr_t ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
+  // VACUUM INDEX: rebuild the named index of any table of the current database
+  dberr_t ExecuteVacuumIndex(const std::string &index_name, ExecuteContext *context);
+
+  /**
+   * Vacuum the heap of a table and re-point the index entries of every row that moved.
+   * @return number of heap pages released
+   */
+  static uint32_t VacuumTable(TableInfo *table_info, ExecuteContext *context);
+
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
  private:
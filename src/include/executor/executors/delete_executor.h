@@ -51,6 +51,10 @@ class DeleteExecutor : public AbstractExecutor {
   std::vector<IndexInfo *> index_info_;
   /** The child executor from which RIDs for deleted rows are pulled */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Rows deleted by the first call to Next, yielded one per call */
+  std::vector<Row> deleted_rows_;
+  size_t next_row_{0};
+  bool deleted_{false};
 };
 
 #endif  // MINISQL_DELETE_EXECUTOR_H
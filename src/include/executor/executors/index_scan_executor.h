@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "executor/execute_context.h"
@@ -39,12 +41,39 @@ class IndexScanExecutor : public AbstractExecutor {
   void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
 
  private:
-  vector<RowId> IndexScan(AbstractExpressionRef predicate);
+  /**
+   * Key range of an index, folded from the comparisons of the predicate: equalities on its first key columns, then
+   * bounds on the next one. With skip_ the first key column is left out, the range is scanned under each of its values.
+   */
+  struct KeyRange {
+    std::vector<Field> prefix_;
+    std::optional<Field> lower_;
+    bool lower_inclusive_{false};
+    std::optional<Field> upper_;
+    bool upper_inclusive_{false};
+    bool skip_{false};
+    bool cut_{false};  // a char constant was cut to the key column length, the range holds more than it matches
+    size_t conditions_used_{0};
+  };
+
+  // the comparisons of the predicate, which only joins them with and
+  static void CollectConditions(const AbstractExpressionRef &predicate, vector<AbstractExpressionRef> &conditions);
+
+  static KeyRange MakeRange(IndexInfo *index, const vector<AbstractExpressionRef> &conditions);
 
   /** The sequential scan plan node to be executed */
   const IndexScanPlanNode *plan_;
   TableInfo *table_info_{};
-  vector<RowId> result_;
-  size_t cursor_ = 0;
+  // row ids of the key range, pulled one at a time
+  std::unique_ptr<IndexScanIterator> iterator_;
+  // whether rows are checked against the predicate, unless the key range covers it
+  bool filter_{true};
+  // the scanned index covers the query: rows are made of its keys, the table heap is not read
+  bool index_only_{false};
+  // key columns of the scanned index in the table, and a row of nulls to place them in
+  std::vector<uint32_t> key_map_;
+  std::vector<Field> null_fields_;
+  // length of each char key column, 0 for the other types: longer values are cut in the keys
+  std::vector<uint32_t> char_widths_;
   bool is_schema_same_;
 };
\ No newline at end of file
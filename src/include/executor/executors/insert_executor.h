@@ -5,6 +5,8 @@
 #ifndef MINISQL_INSERT_EXECUTOR_H
 #define MINISQL_INSERT_EXECUTOR_H
 
+#include <vector>
+
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/insert_plan.h"
@@ -48,6 +50,10 @@ class InsertExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   const Schema *schema_{};
   std::vector<IndexInfo *> index_info_;
+  /** Rows inserted by the first call to Next, yielded one per call */
+  size_t inserted_rows_{0};
+  size_t next_row_{0};
+  bool inserted_{false};
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -5,6 +5,7 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <functional>
 #include <vector>
 
 #include "executor/execute_context.h"
@@ -41,6 +42,13 @@ class SeqScanExecutor : public AbstractExecutor {
 
   void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
 
+ private:
+  /** Yield the next row of a PAX table, scanning it one page at a time */
+  bool NextPaxRow(Row *row, RowId *rid);
+
+  /** Collect the table columns an expression reads */
+  static void CollectColumns(const AbstractExpressionRef &expr, std::vector<uint32_t> *columns);
+
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
@@ -48,6 +56,15 @@ class SeqScanExecutor : public AbstractExecutor {
   TableIterator iterator_;
   const Schema *schema_{};
   bool is_schema_same_;
+  /** PAX tables: qualifying rows of the current page, and the page to scan next */
+  std::vector<Row> pax_rows_;
+  size_t pax_cursor_{0};
+  page_id_t pax_page_id_{INVALID_PAGE_ID};
+  std::function<bool(const Row &)> filter_;
+  /** Table columns the predicate reads */
+  std::vector<uint32_t> filter_columns_;
+  /** Table columns of the output schema, loaded from overflow pages before a row is emitted */
+  std::vector<uint32_t> output_columns_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
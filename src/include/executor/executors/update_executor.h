@@ -5,6 +5,8 @@
 #ifndef MINISQL_UPDATE_EXECUTOR_H
 #define MINISQL_UPDATE_EXECUTOR_H
 
+#include <vector>
+
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/update_plan.h"
@@ -59,6 +61,10 @@ class UpdateExecutor : public AbstractExecutor {
   std::vector<IndexInfo *> index_info_;
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Rows updated by the first call to Next, yielded one per call */
+  size_t updated_rows_{0};
+  size_t next_row_{0};
+  bool updated_{false};
 };
 
 #endif  // MINISQL_UPDATE_EXECUTOR_H
@@ -18,12 +18,13 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param table_name The identifier of table to be scanned
    */
   IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<IndexInfo *> indexes, bool need_filter,
-                    AbstractExpressionRef filter_predicate = nullptr)
+                    AbstractExpressionRef filter_predicate = nullptr, std::vector<IndexInfo *> covering_indexes = {})
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
         indexes_(std::move(indexes)),
         need_filter_(need_filter),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        covering_indexes_(std::move(covering_indexes)) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::IndexScan; }
@@ -44,4 +45,7 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   /** The predicate to filter in IndexScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** The indexes whose key holds every column of the output and the predicate, scanned without the table heap */
+  std::vector<IndexInfo *> covering_indexes_;
 };
\ No newline at end of file
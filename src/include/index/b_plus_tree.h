@@ -1,11 +1,17 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <functional>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
 #include "concurrency/txn.h"
+#include "index/index.h"
 #include "index/index_iterator.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
@@ -16,10 +22,24 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key, BPlusTreeIndex makes a non-unique index unique by appending the row id to its keys
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Insert, Remove and GetValue can be called from several threads. Readers crab down with read latches. Writers
+ *     first try optimistically: read latches down to the leaf and a write latch on the leaf only, which is enough
+ *     when the leaf will not split or underflow. Otherwise they restart, taking write latches from the root and
+ *     releasing the ancestors as soon as a child is safe. root_latch_ guards root_page_id_ the same way.
+ *     Index iterators do not latch, a range scan must not run next to writers of the same tree.
+ * (6) Keys appended past the end of the tree (auto increment ids, timestamps) skip the traversal: the rightmost leaf
+ *     is remembered and write latched directly. Its splits, and those of the rightmost internal pages above it, keep
+ *     INDEX_FILL_FACTOR of the page on the left instead of half, the left page will not be inserted into again.
+ * (7) Batches of keys (GetValues, InsertBatch, RemoveBatch) keep the leaf of the last key latched and go on with it
+ *     while the next key lies between its fences, keys given in increasing order go down the tree once per leaf.
+ *     A key that would split or underflow the leaf goes through Insert or Remove on its own.
+ * (8) Remove merges a node only once it holds less than merge_threshold of a page (INDEX_MERGE_THRESHOLD), not as
+ *     soon as it is half empty: keys removed and inserted again in the same range do not merge and split the same
+ *     nodes over and over. The space left in underfull nodes is given back by Vacuum.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -27,7 +47,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
-                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
+                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE,
+                     double merge_threshold = INDEX_MERGE_THRESHOLD);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -38,17 +59,71 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const GenericKey *key, Txn *transaction = nullptr);
 
+  /**
+   * Build an empty tree bottom-up from count entries in strictly increasing key order: the leaves are filled left
+   * to right to fill_factor of their max size and of their bytes, then every internal level is built over the one
+   * below it.
+   * @param next Writes the next entry into the key buffer and row id, false if there is none left
+   * @return false if the tree is not empty or the keys are not strictly increasing, nothing is built then
+   */
+  bool BulkLoad(uint64_t count, const std::function<bool(GenericKey *, RowId *)> &next,
+                double fill_factor = INDEX_FILL_FACTOR);
+
+  /**
+   * Rebuild the tree bottom-up from its own entries, filling the nodes to fill_factor, to give back the space left
+   * in underfull nodes. Other operations on the tree wait until the new tree replaces the old one.
+   * @return the pages released, negative if the new tree is larger
+   */
+  int Vacuum(double fill_factor = INDEX_FILL_FACTOR);
+
+  // nodes split, and underfull nodes merged or redistributed with a sibling, since the tree was opened
+  uint64_t GetSplitCount() const { return splits_; }
+
+  uint64_t GetMergeCount() const { return merges_; }
+
+  /**
+   * Walk every page of the tree for its height, page counts, entry count and fill factors. Read latches are crabbed
+   * down and a page stays latched until its subtree is walked, so no page is freed under the walk: splits and merges
+   * wait for it, inserts and removes within a leaf may still land in leaves already counted.
+   */
+  IndexStats GetStats();
+
   // return the value associated with a given key
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction = nullptr);
 
+  /**
+   * Batched lookup, best with ranges sorted by their lower key.
+   * @param ranges Lower and upper key of every range, both included; a point lookup is a range of one key
+   * @param result result[i] gets the values of ranges[i] in key order
+   */
+  void GetValues(const std::vector<std::pair<const GenericKey *, const GenericKey *>> &ranges,
+                 std::vector<std::vector<RowId>> &result, Txn *transaction = nullptr);
+
+  /**
+   * Batched Insert, best with keys in increasing order. Of equal keys the first one is inserted.
+   * @param inserted inserted[i] is false if keys[i] was a duplicate
+   */
+  void InsertBatch(const std::vector<GenericKey *> &keys, const std::vector<RowId> &values,
+                   std::vector<bool> &inserted, Txn *transaction = nullptr);
+
+  // Batched Remove, best with keys in increasing order
+  void RemoveBatch(const std::vector<const GenericKey *> &keys, Txn *transaction = nullptr);
+
   IndexIterator Begin();
 
   IndexIterator Begin(const GenericKey *key);
 
   IndexIterator End();
 
+  // iterator at the greatest key, moved towards smaller keys with operator--
+  IndexIterator RBegin();
+
+  // iterator at the greatest key not greater than key, moved towards smaller keys with operator--
+  IndexIterator RBegin(const GenericKey *key);
+
   // expose for test purpose
-  Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
+  // NOTE: the leaf page is pinned and latched, read latched unless exclusive is set
+  Page *FindLeafPage(const GenericKey *key, bool leftMost = false, bool exclusive = false, bool rightMost = false);
 
   // used to check whether all pages are unpinned
   bool Check();
@@ -68,33 +143,107 @@ class BPlusTree {
   }
 
  private:
+  enum class Operation { kInsert, kRemove };
+
+  /**
+   * Latches held by a pessimistic write: root_latch_ and the write latched pages from the topmost unsafe ancestor
+   * down to the leaf. Pages emptied by merges are deleted once every latch is released.
+   */
+  struct LatchContext {
+    bool root_latched_{false};
+    std::vector<Page *> pages_;
+    std::vector<page_id_t> deleted_pages_;
+  };
+
+  /**
+   * Find the leaf for a write, keeping the latches of the ancestors that the write may modify. root_latch_ is kept
+   * as well when the tree is empty or the root may change.
+   * @return the write latched leaf page, nullptr if the tree is empty
+   */
+  Page *FindLeafPageForWrite(const GenericKey *key, Operation op, LatchContext &context);
+
+  // @return true if the operation can not split or underflow the node, so its ancestors are left untouched
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
+  // Unlatch and unpin the pages held by context, then delete the pages it emptied
+  void ReleaseLatches(LatchContext &context, bool is_dirty);
+
+  /**
+   * Leaf latched by a batch between two of its keys, with the fences it was latched with: a key in [lower_, upper_)
+   * belongs to it. Read latched for lookups, write latched for writes.
+   */
+  struct LeafCursor {
+    Page *page_{nullptr};
+    bool exclusive_{false};
+    bool dirty_{false};
+    bool has_upper_{false};
+    std::vector<char> lower_;
+    std::vector<char> upper_;
+  };
+
+  // latch page, nullptr for none, into cursor once its previous leaf is released
+  void MoveCursor(LeafCursor &cursor, Page *page);
+
+  bool CursorCovers(const LeafCursor &cursor, const GenericKey *key) const;
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction = nullptr);
+  /**
+   * Rightmost leaf fast path: the remembered rightmost leaf, if key goes past its last key.
+   * @return the write latched leaf page, nullptr if the key has to be looked up from the root
+   */
+  Page *FindRightmostLeafForAppend(const GenericKey *key);
 
-  void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction = nullptr);
+  bool InsertIntoLeaf(GenericKey *key, const RowId &value, LeafPage *leaf_page);
 
-  LeafPage *Split(LeafPage *node, Txn *transaction);
+  void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node);
 
-  InternalPage *Split(InternalPage *node, Txn *transaction);
+  // point the leaf page_id (if valid) back at prev_page_id, once the leaf before it changed
+  void SetPrevLeaf(page_id_t page_id, page_id_t prev_page_id);
+
+  // at_right_edge: the entry that overflowed node was appended to the rightmost page of its level
+  LeafPage *Split(LeafPage *node, bool at_right_edge);
+
+  InternalPage *Split(InternalPage *node, bool at_right_edge);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Txn *transaction = nullptr);
+  void CoalesceOrRedistribute(N *node, LatchContext &context);
 
-  bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  bool Coalesce(InternalPage *left, InternalPage *right, InternalPage *parent, int index, LatchContext &context);
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Txn *transaction = nullptr);
+  bool Coalesce(LeafPage *left, LeafPage *right, InternalPage *parent, int index, LatchContext &context);
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *left, LeafPage *right, InternalPage *parent, int index);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *left, InternalPage *right, InternalPage *parent, int index);
 
-  bool AdjustRoot(BPlusTreePage *node);
+  void AdjustRoot(BPlusTreePage *node, LatchContext &context);
 
   void UpdateRootPageId(int insert_record = 0);
 
+  /**
+   * BulkLoad without the root: build a tree from next that nothing points to yet.
+   * @param root Set to the root of the new tree
+   * @param rightmost_leaf Set to the last leaf of the new tree
+   * @return false if the keys are not strictly increasing, the pages built so far are deleted then
+   */
+  bool BuildTree(uint64_t count, const std::function<bool(GenericKey *, RowId *)> &next, double fill_factor,
+                 page_id_t *root, page_id_t *rightmost_leaf);
+
+  /**
+   * Write latch the subtree under page_id top-down, one path at a time, to wait out the operations already in it, and
+   * forget the rightmost leaf when passing it.
+   * @return the entries in the leaves of the subtree
+   */
+  uint64_t LatchSubtree(page_id_t page_id);
+
+  // pages of the subtree under page_id
+  int CountPages(page_id_t page_id);
+
+  // add the pages of the subtree under page, at depth levels below the root, to stats; fills hold the used bytes.
+  // page comes read latched and pinned, both are released once its subtree is walked
+  void CollectStats(Page *page, uint32_t depth, IndexStats *stats, uint64_t *leaf_used, uint64_t *internal_used);
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out, Schema *schema) const;
 
@@ -103,10 +252,16 @@ class BPlusTree {
   // member variable
   index_id_t index_id_;
   page_id_t root_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch root_latch_;  // guards root_page_id_
+  // rightmost leaf, set and cleared only under its write latch, INVALID_PAGE_ID if unknown
+  std::atomic<page_id_t> rightmost_leaf_id_{INVALID_PAGE_ID};
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  double merge_threshold_;
+  std::atomic<uint64_t> splits_{0};
+  std::atomic<uint64_t> merges_{0};
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -1,13 +1,50 @@
 #ifndef MINISQL_B_PLUS_TREE_INDEX_H
 #define MINISQL_B_PLUS_TREE_INDEX_H
 
+#include <memory>
+
+#include "common/rwlatch.h"
 #include "index/b_plus_tree.h"
+#include "index/bloom_filter.h"
 #include "index/generic_key.h"
 #include "index/index.h"
 
+/**
+ * Range scan over the leaves of a B+ tree, stopping at the upper bound. A reverse scan walks towards smaller keys
+ * instead and stops at the lower bound.
+ */
+class BPlusTreeScanIterator : public IndexScanIterator {
+ public:
+  // bound is copied, nullptr for no bound
+  BPlusTreeScanIterator(const KeyManager &key_manager, IndexIterator iterator, const GenericKey *bound,
+                        bool bound_inclusive, bool reverse = false);
+
+  bool Next(RowId *row_id) override;
+
+  bool NextEntry(RowId *row_id, Row *key) override;
+
+ private:
+  KeyManager key_manager_;
+  IndexIterator iterator_;
+  std::vector<char> bound_;  // empty if the range has no bound on the side the scan goes to
+  bool bound_inclusive_;
+  bool reverse_;
+};
+
+/**
+ * A non-unique index keys its tree by the key followed by the row id of the entry (see KeyManager::SetRowId), so
+ * the tree itself stays unique: the entries of one key are a range of the tree and are removed by (key, row id).
+ *
+ * An in-memory bloom filter over the key columns answers most lookups of absent keys, such as the uniqueness check
+ * of an insert, without going down the tree. It is built from the leaves when the index is opened and takes every
+ * inserted key. Keys can not be taken out of it: it is rebuilt from the leaves once half of its keys were removed,
+ * or once it is over capacity.
+ */
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  // bloom_bits_per_key 0 for no bloom filter
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true, uint32_t bloom_bits_per_key = INDEX_BLOOM_BITS_PER_KEY);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
 
@@ -15,6 +52,34 @@ class BPlusTreeIndex : public Index {
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
 
+  std::unique_ptr<IndexScanIterator> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                          bool upper_inclusive, Txn *txn) override;
+
+  // the same range as Scan, from the greatest key down
+  std::unique_ptr<IndexScanIterator> ScanReverse(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                 bool upper_inclusive, Txn *txn);
+
+  dberr_t InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result, Txn *txn) override;
+
+  dberr_t ScanRowKeys(const std::vector<const Row *> &rows, const KeyProjector &projector,
+                      std::vector<std::vector<RowId>> &result, Txn *txn) override;
+
+  dberr_t InsertRowEntries(const std::vector<const Row *> &rows, const KeyProjector &projector, Txn *txn) override;
+
+  dberr_t RemoveRowEntries(const std::vector<const Row *> &rows, const KeyProjector &projector, Txn *txn) override;
+
+  dberr_t BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) override;
+
+  // rebuild the tree without its underfull nodes, see BPlusTree::Vacuum
+  dberr_t Vacuum(int *pages_released, Txn *txn) override;
+
+  // see BPlusTree::GetStats
+  dberr_t GetStats(IndexStats *stats) override;
+
   dberr_t Destroy() override;
 
   IndexIterator GetBeginIterator();
@@ -24,10 +89,39 @@ class BPlusTreeIndex : public Index {
   IndexIterator GetEndIterator();
 
  protected:
+  // all the row ids of the serialized index_key, whose row id suffix is overwritten
+  void LookupKey(GenericKey *index_key, std::vector<RowId> &result, Txn *txn);
+
+  // insert into the tree and the bloom filter, rebuilding the filter once it is over capacity
+  bool InsertKey(GenericKey *index_key, RowId row_id, Txn *txn);
+
+  void RemoveKey(GenericKey *index_key, Txn *txn);
+
+  /**
+   * Serialize the keys of rows one after another into keys, with the row id of the row as suffix or, if with_row_id
+   * is not set, the smallest one.
+   * @param order the rows in key order, rows of equal keys in their order in rows
+   */
+  void SerializeRows(const std::vector<const Row *> &rows, const KeyProjector &projector, bool with_row_id,
+                     std::vector<char> &keys, std::vector<size_t> &order);
+
+  // rebuild the bloom filter once it is over capacity or half of its keys were removed, unless another writer did
+  void RebuildStaleFilter();
+
+  // rebuild the bloom filter from the leaves, filter_latch_ write latched by the caller or not shared yet
+  void RebuildFilter();
+
   // comparator for key
   KeyManager processor_;
   // container
   BPlusTree container_;
+  uint32_t bloom_bits_per_key_;
+  // write latched to replace the filter, read latched by every insert, remove and lookup so that the tree does not
+  // change while it is scanned for a new filter
+  ReaderWriterLatch filter_latch_;
+  std::unique_ptr<BloomFilter> filter_;    // nullptr without bloom filter
+  std::atomic<uint64_t> filter_keys_{0};   // keys added to the filter
+  std::atomic<uint64_t> removed_keys_{0};  // keys removed from the tree since the filter was built
 };
 
 #endif  // MINISQL_B_PLUS_TREE_INDEX_H
@@ -0,0 +1,34 @@
+#ifndef MINISQL_BLOOM_FILTER_H
+#define MINISQL_BLOOM_FILTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Bloom filter over 64 bit key hashes: MayContain is false only for a hash that was never added, and true for a
+ * hash that was not with a probability of about 0.6185^bits_per_key once capacity hashes are in.
+ *
+ * Bit positions are h1 + i * h2 (i < hash count) for the two 32 bit halves of the hash. Bits are set with atomic or,
+ * Add and MayContain can run from several threads. Hashes can not be taken out, a filter of a shrinking set is
+ * rebuilt from scratch instead.
+ */
+class BloomFilter {
+ public:
+  BloomFilter(uint64_t capacity, uint32_t bits_per_key);
+
+  void Add(uint64_t hash);
+
+  bool MayContain(uint64_t hash) const;
+
+  // number of hashes the filter is sized for
+  uint64_t GetCapacity() const { return capacity_; }
+
+ private:
+  uint64_t capacity_;
+  uint64_t bit_count_;
+  uint32_t hash_count_;
+  std::vector<std::atomic<uint64_t>> words_;
+};
+
+#endif  // MINISQL_BLOOM_FILTER_H
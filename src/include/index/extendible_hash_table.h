@@ -0,0 +1,75 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "index/generic_key.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+
+/**
+ * Disk based extendible hash table of (key, row id) entries.
+ *
+ * The directory page maps the low global depth bits of the hash of a key to a bucket page, so a point lookup reads
+ * the directory and one bucket whatever the size of the table. A full bucket splits in two by the next bit of the
+ * hash, doubling the directory when its local depth reaches the global depth; an emptied bucket merges back into
+ * its split image. The directory page id is kept in the index roots page, like the root of a B+ tree.
+ * (1) With unique set, a key has at most one entry; otherwise only a (key, row id) pair is unique
+ * (2) A single latch serializes writers against readers. Scans copy one bucket at a time and must not run next to
+ *     writers of the same table
+ */
+class ExtendibleHashTable {
+ public:
+  ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
+                      bool unique);
+
+  // @return false if the entry, or the key of a unique table, is already there
+  bool Insert(const GenericKey *key, const RowId &value);
+
+  // @return false if there is no such entry
+  bool Remove(const GenericKey *key, const RowId &value);
+
+  // append the row ids of key to result, @return false if there is none
+  bool GetValue(const GenericKey *key, std::vector<RowId> &result);
+
+  // the first page of every bucket, each once
+  std::vector<page_id_t> GetBucketPageIds();
+
+  // the first page of the bucket of key
+  page_id_t GetBucketPageId(const GenericKey *key);
+
+  /**
+   * Copy the entries of a bucket and its overflow pages, keys one after another in keys.
+   */
+  void ReadBucket(page_id_t bucket_page_id, std::vector<char> &keys, std::vector<RowId> &values);
+
+  uint32_t GetGlobalDepth();
+
+  // delete every page of the table
+  void Destroy();
+
+ private:
+  HashTableDirectoryPage *FetchDirectory();
+
+  HashTableBucketPage *FetchBucket(page_id_t bucket_page_id);
+
+  // @return true if the hash of every entry is the same, no split can spread them
+  bool IsSameHash(const HashTableBucketPage *bucket) const;
+
+  // split the bucket of bucket_idx, it must have no overflow page
+  bool SplitBucket(HashTableDirectoryPage *dir, uint32_t bucket_idx);
+
+  // merge the emptied bucket of bucket_idx into its split image, as long as they have the same local depth
+  void MergeBucket(HashTableDirectoryPage *dir, uint32_t bucket_idx);
+
+  index_id_t index_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyManager processor_;
+  bool unique_;
+  page_id_t directory_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch latch_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
@@ -2,15 +2,56 @@
 #define MINISQL_GENERIC_KEY_H
 
 #include <cstring>
+#include <functional>
+#include <string_view>
 
+#include "index/key_projector.h"
 #include "record/field.h"
 #include "record/row.h"
 
 class GenericKey {
   friend class KeyManager;
+  friend struct MemcmpKeyComparator;
+  template <typename UInt>
+  friend struct FixedKeyComparator;
   char data[0];
 };
 
+/**
+ * Comparators of normalized keys. The B+ tree pages run their binary searches with the comparator picked by
+ * KeyManager::VisitComparator, so the fixed width ones inline into the search loop.
+ */
+struct MemcmpKeyComparator {
+  inline int operator()(const GenericKey *lhs, const GenericKey *rhs) const {
+    return memcmp(lhs->data, rhs->data, key_size_);
+  }
+  uint32_t key_size_;
+};
+
+/**
+ * Keys of exactly sizeof(UInt) bytes, compared as one big-endian unsigned integer.
+ */
+template <typename UInt>
+struct FixedKeyComparator {
+  static_assert(sizeof(UInt) == 4 || sizeof(UInt) == 8, "Unsupported key width.");
+
+  inline int operator()(const GenericKey *lhs, const GenericKey *rhs) const {
+    UInt l = Load(lhs);
+    UInt r = Load(rhs);
+    return (l > r) - (l < r);
+  }
+
+  static inline UInt Load(const GenericKey *key) {
+    UInt val;
+    memcpy(&val, key->data, sizeof(UInt));
+    if constexpr (sizeof(UInt) == 4) {
+      return __builtin_bswap32(val);
+    } else {
+      return __builtin_bswap64(val);
+    }
+  }
+};
+
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,42 +59,93 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    // initialize to 0, bytes after the normalized key take part in memcmp too
+    memset(key_buf->data, 0, key_size_);
+    key_projector_.Project(key, key_buf->data);
+  }
+
+  /**
+   * Serialize the key of a full table row, projected by projector, without building a key row.
+   */
+  inline void SerializeFromRow(GenericKey *key_buf, const Row &row, const KeyProjector &projector) const {
+    ASSERT(projector.GetKeySize() == key_projector_.GetKeySize(), "Projector does not match the key schema.");
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    projector.Project(row, key_buf->data);
   }
 
-  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  /**
+   * Serialize the bound of a key range, a key row that may hold the first key columns only. The columns it leaves
+   * out are set to their smallest bytes, or to their greatest ones if greatest is set, so that every key starting
+   * with the prefix lies between its two forms.
+   */
+  inline void SerializeFromPrefix(GenericKey *key_buf, const Row &prefix, bool greatest) const {
+    memset(key_buf->data, 0, key_size_);
+    uint32_t size = key_projector_.ProjectPrefix(prefix, key_buf->data);
+    memset(key_buf->data + size, greatest ? 0xff : 0, key_projector_.GetKeySize() - size);
+  }
+
+  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, [[maybe_unused]] Schema *schema) const {
+    key_projector_.Restore(key_buf->data, key);
   }
 
-  // compare
+  /**
+   * Write the row id suffix of a key of a non-unique index, order preserving: the page id with its sign bit
+   * flipped and the slot, both big-endian.
+   */
+  inline void SetRowId(GenericKey *key_buf, const RowId &row_id) const {
+    ASSERT(row_id_suffix_, "Key has no row id suffix.");
+    uint32_t page = __builtin_bswap32(static_cast<uint32_t>(row_id.GetPageId()) ^ 0x80000000u);
+    uint32_t slot = __builtin_bswap32(row_id.GetSlotNum());
+    memcpy(key_buf->data + key_projector_.GetKeySize(), &page, sizeof(page));
+    memcpy(key_buf->data + key_projector_.GetKeySize() + sizeof(page), &slot, sizeof(slot));
+  }
+
+  /**
+   * Set the row id suffix below (or above) the one of every entry, the key then bounds a range of equal keys.
+   */
+  inline void SetRowIdBound(GenericKey *key_buf, bool upper) const {
+    ASSERT(row_id_suffix_, "Key has no row id suffix.");
+    memset(key_buf->data + key_projector_.GetKeySize(), upper ? 0xff : 0, sizeof(int64_t));
+  }
+
+  inline bool HasRowIdSuffix() const { return row_id_suffix_; }
+
+  // compare, keys are normalized so that memcmp order is the key order
   [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
-      }
+    return memcmp(lhs->data, rhs->data, compare_size_);
+  }
+
+  // hash of the key columns, the row id suffix excluded, so every entry of a key lands in the same bucket
+  [[nodiscard]] inline uint32_t HashKey(const GenericKey *key) const {
+    return static_cast<uint32_t>(
+        std::hash<std::string_view>()(std::string_view(key->data, key_projector_.GetKeySize())));
+  }
+
+  // 64 bit hash of the key columns, for the bloom filter of an index
+  [[nodiscard]] inline uint64_t HashKeyColumns(const GenericKey *key) const {
+    return std::hash<std::string_view>()(std::string_view(key->data, key_projector_.GetKeySize()));
+  }
+
+  // compare the key columns only, ignoring the row id suffix
+  [[nodiscard]] inline int CompareKeyColumns(const GenericKey *lhs, const GenericKey *rhs) const {
+    return memcmp(lhs->data, rhs->data, key_projector_.GetKeySize());
+  }
+
+  /**
+   * Call visitor with the comparator specialized for the width of the keys: 4 and 8 byte keys (a single not null
+   * INT or FLOAT, a pair of them) are compared as one big-endian integer, anything else with memcmp.
+   */
+  template <typename Visitor>
+  inline decltype(auto) VisitComparator(Visitor &&visitor) const {
+    switch (compare_size_) {
+      case sizeof(uint32_t):
+        return visitor(FixedKeyComparator<uint32_t>());
+      case sizeof(uint64_t):
+        return visitor(FixedKeyComparator<uint64_t>());
+      default:
+        return visitor(MemcmpKeyComparator{compare_size_});
     }
-    // equals
-    return 0;
   }
 
   inline int GetKeySize() const { return key_size_; }
@@ -61,14 +153,38 @@ class KeyManager {
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->key_projector_ = other.key_projector_;
+    this->row_id_suffix_ = other.row_id_suffix_;
+    this->compare_size_ = other.compare_size_;
   }
 
-  // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  /**
+   * @param row_id_suffix Keys of a non-unique index end with the row id of their entry, so equal keys still make
+   *                      distinct entries: | Normalized key | RowId (8) |
+   */
+  KeyManager(Schema *key_schema, size_t key_size, bool row_id_suffix = false)
+      : key_size_(key_size),
+        key_schema_(key_schema),
+        key_projector_(key_schema, IdentityKeyMap(key_schema)),
+        row_id_suffix_(row_id_suffix),
+        compare_size_(key_projector_.GetKeySize() + (row_id_suffix ? sizeof(int64_t) : 0)) {
+    ASSERT(compare_size_ <= key_size, "Index key size exceed max key size.");
+  }
 
  private:
+  static std::vector<uint32_t> IdentityKeyMap(const Schema *key_schema) {
+    std::vector<uint32_t> key_map(key_schema->GetColumnCount());
+    for (uint32_t i = 0; i < key_map.size(); i++) {
+      key_map[i] = i;
+    }
+    return key_map;
+  }
+
   int key_size_;
   Schema *key_schema_;
+  KeyProjector key_projector_; /** key row -> normalized key */
+  bool row_id_suffix_{false};
+  uint32_t compare_size_; /** bytes taken by the key and its row id suffix, the rest of the key buffer is zero */
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
@@ -0,0 +1,74 @@
+#ifndef MINISQL_HASH_INDEX_H
+#define MINISQL_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Entries of an extendible hash table between two bounds, one bucket at a time and in no particular order. An
+ * equality range reads the bucket of its key only.
+ */
+class HashScanIterator : public IndexScanIterator {
+ public:
+  // lower and upper are copied, nullptr for no bound
+  HashScanIterator(ExtendibleHashTable *table, const KeyManager &key_manager, std::vector<page_id_t> bucket_page_ids,
+                   const GenericKey *lower, bool lower_inclusive, const GenericKey *upper, bool upper_inclusive);
+
+  bool Next(RowId *row_id) override;
+
+  bool NextEntry(RowId *row_id, Row *key) override;
+
+ private:
+  bool InRange(const GenericKey *key) const;
+
+  ExtendibleHashTable *table_;
+  KeyManager key_manager_;
+  std::vector<page_id_t> bucket_page_ids_;
+  size_t next_bucket_{0};
+  // entries of the bucket being read
+  std::vector<char> keys_;
+  std::vector<RowId> values_;
+  size_t pos_{0};
+  std::vector<char> lower_;  // empty if the range has no lower bound
+  bool lower_inclusive_;
+  std::vector<char> upper_;  // empty if the range has no upper bound
+  bool upper_inclusive_;
+};
+
+/**
+ * Index on an extendible hash table: a point lookup reads the directory and one bucket. Any other range has to
+ * read every bucket, the planner only picks it for equality.
+ */
+class HashIndex : public Index {
+ public:
+  HashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+            bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanIterator> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                          bool upper_inclusive, Txn *txn) override;
+
+  dberr_t InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result, Txn *txn) override;
+
+  dberr_t BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) override;
+
+  dberr_t Destroy() override;
+
+  uint32_t GetGlobalDepth() { return container_.GetGlobalDepth(); }
+
+ protected:
+  KeyManager processor_;
+  ExtendibleHashTable container_;
+};
+
+#endif  // MINISQL_HASH_INDEX_H
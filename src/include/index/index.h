@@ -1,12 +1,49 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "common/dberr.h"
 #include "concurrency/txn.h"
+#include "index/key_projector.h"
 #include "record/row.h"
 
+/**
+ * Row ids of the entries of an index key range, read one at a time in key order.
+ */
+class IndexScanIterator {
+ public:
+  virtual ~IndexScanIterator() {}
+
+  // @return false once the range is exhausted
+  virtual bool Next(RowId *row_id) = 0;
+
+  /**
+   * Next, also restoring the key of the entry into key, one field per key column, so a query reading only key
+   * columns does not need the row itself.
+   */
+  virtual bool NextEntry(RowId *row_id, Row *key) = 0;
+};
+
+/**
+ * Shape of an index, for deciding when to vacuum it and how costly a scan of it is. Read from the pages while
+ * writers may run, so it can be off by the entries they move meanwhile.
+ */
+struct IndexStats {
+  uint32_t height_{0};  // levels of pages from the root to the leaves, 0 for an empty index
+  uint64_t leaf_pages_{0};
+  uint64_t internal_pages_{0};
+  uint64_t entries_{0};
+  // average fraction of the page space taken by entries, over the leaves and over the internal pages
+  double leaf_fill_factor_{0};
+  double internal_fill_factor_{0};
+  // nodes split and merged since the index was opened
+  uint64_t splits_{0};
+  uint64_t merges_{0};
+};
+
 class Index {
  public:
   explicit Index(index_id_t index_id, IndexSchema *key_schema) : index_id_(index_id), key_schema_(key_schema) {}
@@ -19,6 +56,87 @@ class Index {
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") = 0;
 
+  /**
+   * Scan the entries whose key lies between lower and upper, each bound included or not. A null bound leaves that
+   * end open. A bound may hold the first key columns only, it then stands for every key starting with it.
+   * The entries are read lazily as the iterator advances, so a scan stopped early reads no further.
+   */
+  virtual std::unique_ptr<IndexScanIterator> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                  bool upper_inclusive, Txn *txn) = 0;
+
+  /**
+   * Index maintenance from a full table row: the key is projected by projector straight into the key buffer
+   * of the index, no key row is built.
+   */
+  virtual dberr_t InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) = 0;
+
+  virtual dberr_t RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) = 0;
+
+  /**
+   * Equality lookup of the key of a full table row.
+   */
+  virtual dberr_t ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result,
+                             Txn *txn) = 0;
+
+  /**
+   * Batched ScanRowKey, InsertRowEntry and RemoveRowEntry over the rows of one statement, each row indexed by its
+   * own row id. The default goes row by row, an index that can do better visits the keys in key order so that
+   * neighbouring keys share the work of finding them.
+   * @param result result[i] gets the row ids of the key of rows[i]
+   * @return DB_KEY_NOT_FOUND if no key was found; DB_FAILED if some entry could not be inserted, the others are
+   *         inserted all the same
+   */
+  virtual dberr_t ScanRowKeys(const std::vector<const Row *> &rows, const KeyProjector &projector,
+                              std::vector<std::vector<RowId>> &result, Txn *txn) {
+    result.assign(rows.size(), {});
+    bool found = false;
+    for (size_t i = 0; i < rows.size(); i++) {
+      found = ScanRowKey(*rows[i], projector, result[i], txn) == DB_SUCCESS || found;
+    }
+    return found ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+  }
+
+  virtual dberr_t InsertRowEntries(const std::vector<const Row *> &rows, const KeyProjector &projector, Txn *txn) {
+    dberr_t status = DB_SUCCESS;
+    for (auto row : rows) {
+      if (InsertRowEntry(*row, projector, row->GetRowId(), txn) != DB_SUCCESS) {
+        status = DB_FAILED;
+      }
+    }
+    return status;
+  }
+
+  virtual dberr_t RemoveRowEntries(const std::vector<const Row *> &rows, const KeyProjector &projector, Txn *txn) {
+    for (auto row : rows) {
+      RemoveRowEntry(*row, projector, row->GetRowId(), txn);
+    }
+    return DB_SUCCESS;
+  }
+
+  /**
+   * Index every row given by next_row, which returns nullptr after the last one. An empty index is built in one
+   * pass from the sorted keys instead of one insert per row.
+   */
+  virtual dberr_t BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) = 0;
+
+  /**
+   * Give back the space an index leaves unused after deletes. Nothing to do by default.
+   * @param pages_released pages the index gave back, negative if it grew
+   */
+  virtual dberr_t Vacuum(int *pages_released, Txn *txn) {
+    (void)txn;
+    *pages_released = 0;
+    return DB_SUCCESS;
+  }
+
+  /**
+   * @return DB_FAILED if the index is not a tree of pages, stats is left untouched then
+   */
+  virtual dberr_t GetStats(IndexStats *stats) {
+    (void)stats;
+    return DB_FAILED;
+  }
+
   virtual dberr_t Destroy() = 0;
 
  protected:
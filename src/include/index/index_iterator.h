@@ -1,6 +1,8 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 class IndexIterator {
@@ -10,16 +12,32 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   explicit IndexIterator();
 
+  // index past the last entry of the leaf starts at the next leaf, index -1 at the last entry of the previous leaf
   explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
 
   ~IndexIterator();
 
-  /** Return the key/value pair this iterator is currently pointing at. */
+  // an iterator pins its leaf, it is moved but never copied
+  IndexIterator(IndexIterator &&other) noexcept;
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
+  IndexIterator(const IndexIterator &other) = delete;
+
+  IndexIterator &operator=(const IndexIterator &other) = delete;
+
+  /**
+   * Return the key/value pair this iterator is currently pointing at.
+   * NOTE: keys are compressed in the page, the key points to a buffer of the iterator that the next call reuses
+   */
   std::pair<GenericKey *, RowId> operator*();
 
   /** Move to the next key/value pair.*/
   IndexIterator &operator++();
 
+  /** Move to the previous key/value pair, past the first one the iterator is End() */
+  IndexIterator &operator--();
+
   /** Return whether two iterators are equal */
   bool operator==(const IndexIterator &itr) const;
 
@@ -32,6 +50,7 @@ class IndexIterator {
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
   // add your own private member variables here
+  std::vector<char> key_;
 };
 
 #endif  // MINISQL_INDEX_ITERATOR_H
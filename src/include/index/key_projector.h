@@ -0,0 +1,75 @@
+#ifndef MINISQL_KEY_PROJECTOR_H
+#define MINISQL_KEY_PROJECTOR_H
+
+#include <vector>
+
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Projection of a row onto the key of one index, compiled once from the key schema and the key map of the index.
+ * Project() writes the key columns of a row straight into a key buffer in the normalized key format, so no key
+ * Row is built and no column is looked up by name.
+ *
+ * Normalized key format, every column has a fixed width so two keys of an index compare with a single memcmp:
+ * | Column-1 | Column-2 | ... | Column-N |
+ * Column: | Null flag (1) | Value (width) |
+ *  - null flag 0 for null, 1 otherwise, so null sorts first; the value bytes of a null are all zero. Columns that
+ *    are not nullable have no null flag, a single INT or FLOAT primary key is then stored as its raw 4 bytes
+ *  - int: big-endian with the sign bit flipped, 4 bytes
+ *  - float: big-endian IEEE bits, sign bit set for positive values and all bits inverted for negative ones, 4 bytes
+ *  - char: the string padded with '\0' to the column length; only the first column length bytes are compared
+ */
+class KeyProjector {
+ public:
+  KeyProjector() = default;
+
+  /**
+   * @param key_schema Schema of the key
+   * @param key_map Column of the projected row for every key column
+   */
+  KeyProjector(const Schema *key_schema, const std::vector<uint32_t> &key_map);
+
+  /**
+   * Serialize the key of row into buf.
+   * @param row Row holding every column of the key map
+   * @param buf Key buffer, at least GetKeySize() bytes
+   * @return number of bytes written
+   */
+  uint32_t Project(const Row &row, char *buf) const;
+
+  /**
+   * Serialize a key row that holds the first key columns only, one field per column, into buf.
+   * @return number of bytes written
+   */
+  uint32_t ProjectPrefix(const Row &key, char *buf) const;
+
+  /**
+   * Deserialize a key written by Project into a key row, which has one field per key column.
+   */
+  void Restore(const char *buf, Row &key) const;
+
+  /**
+   * @return size of every key once projected
+   */
+  inline uint32_t GetKeySize() const { return key_size_; }
+
+  inline const std::vector<uint32_t> &GetKeyMap() const { return key_map_; }
+
+  /**
+   * @return bytes taken by a column of the given schema in a normalized key
+   */
+  static uint32_t GetColumnKeySize(const Column *column);
+
+ private:
+  // serialize field as key column i into buf, @return number of bytes written
+  uint32_t ProjectColumn(const Field *field, uint32_t i, char *buf) const;
+
+  std::vector<uint32_t> key_map_; /** column of the projected row for every key column */
+  std::vector<TypeId> types_;
+  std::vector<uint32_t> widths_; /** value bytes of every key column, the null flag excluded */
+  std::vector<bool> nullable_;   /** whether the key column starts with a null flag */
+  uint32_t key_size_{0};
+};
+
+#endif  // MINISQL_KEY_PROJECTOR_H
@@ -0,0 +1,80 @@
+#ifndef MINISQL_KEY_SORTER_H
+#define MINISQL_KEY_SORTER_H
+
+#include <cstdio>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * External sort of the (key, row id) entries of an index being bulk loaded.
+ *
+ * Entries are buffered in memory up to buffer_size bytes. A full buffer is sorted and spilled to a temporary file
+ * as one run; Sort() sorts what is left in memory and Next() merges the runs, returning the entries in key order.
+ * Entry format, fixed width: | Key (key size) | RowId (8) |
+ */
+class KeySorter {
+ public:
+  explicit KeySorter(const KeyManager &key_manager, uint32_t buffer_size = INDEX_SORT_BUFFER_SIZE);
+
+  ~KeySorter();
+
+  KeySorter(const KeySorter &other) = delete;
+
+  KeySorter &operator=(const KeySorter &other) = delete;
+
+  void Add(const GenericKey *key, const RowId &row_id);
+
+  /**
+   * Sort the entries added so far. No entry can be added afterwards.
+   */
+  void Sort();
+
+  /**
+   * Read the next entry in key order.
+   * @param key Key buffer, at least the key size of the key manager
+   * @return false once every entry has been read
+   */
+  bool Next(GenericKey *key, RowId *row_id);
+
+  uint64_t GetSize() const { return size_; }
+
+  // number of runs spilled to disk
+  size_t GetSpilledRunCount() const { return spilled_run_count_; }
+
+ private:
+  /**
+   * A sorted run, either spilled to file or kept in memory. buffer_ holds the part of the run being read.
+   */
+  struct Run {
+    FILE *file_{nullptr};
+    std::vector<char> buffer_;
+    size_t pos_{0};
+  };
+
+  // sort the buffered entries into a new run
+  void SortBuffer();
+
+  // @return false if the run is exhausted
+  bool FillRun(Run &run);
+
+  const char *Current(const Run &run) const { return run.buffer_.data() + run.pos_; }
+
+  // heap order of heap_: true if the current key of run lhs is greater than the one of run rhs
+  bool RunGreater(size_t lhs, size_t rhs) const;
+
+  KeyManager key_manager_;
+  uint32_t entry_size_;
+  uint32_t buffer_size_;
+  std::vector<char> buffer_;
+  std::vector<Run> runs_;
+  size_t spilled_run_count_{0};
+  uint64_t size_{0};
+  bool sorted_{false};
+  // index of the runs not yet exhausted, smallest current key first
+  std::vector<size_t> heap_;
+};
+
+#endif  // MINISQL_KEY_SORTER_H
@@ -0,0 +1,200 @@
+#ifndef MINISQL_LEARNED_INDEX_H
+#define MINISQL_LEARNED_INDEX_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+#include "page/learned_data_page.h"
+
+// (key, row id) entry of a learned index, ordered by key and then row id
+using LearnedEntry = std::pair<uint64_t, int64_t>;
+
+/**
+ * Segment of the model of a learned index: the first entry of a key from first_key_ up to the first key of the next
+ * segment is predicted at first_position_ + slope_ * (key - first_key_), LEARNED_INDEX_ERROR positions away at most.
+ */
+struct LearnedSegment {
+  uint64_t first_key_;
+  uint64_t first_position_;
+  double slope_;
+};
+
+/**
+ * One build of a learned index: its data pages, its model pages and the segments read back from them. A build is
+ * never changed, a rebuild makes a new one; the pages of the old one are deleted once the last scan reading it lets
+ * it go.
+ */
+struct LearnedVersion {
+  explicit LearnedVersion(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  ~LearnedVersion();
+
+  // position of the first entry whose key is not less than key, entry_count_ if there is none
+  uint64_t LowerBound(uint64_t key) const;
+
+  // copy the entries of the data page at index
+  void ReadPage(size_t index, std::vector<uint64_t> &keys, std::vector<RowId> &values) const;
+
+  // bytes of the model kept in memory
+  size_t GetModelSize() const {
+    return segments_.size() * sizeof(LearnedSegment) + data_page_ids_.size() * sizeof(page_id_t);
+  }
+
+  BufferPoolManager *buffer_pool_manager_;
+  std::vector<LearnedSegment> segments_;
+  std::vector<page_id_t> data_page_ids_;
+  std::vector<page_id_t> model_page_ids_;
+  uint64_t entry_count_{0};
+  std::atomic<bool> obsolete_{false};  // rebuilt, its pages are deleted with it
+};
+
+/**
+ * Entries of a learned index between two keys in key order, merged from the data pages of a build and a copy of the
+ * entries inserted and removed since then.
+ */
+class LearnedScanIterator : public IndexScanIterator {
+ public:
+  /**
+   * @param position position of the first entry of the range in the data pages of version
+   * @param upper greatest key of the range
+   * @param inserted entries of the range inserted since the build, in order
+   * @param removed entries of the range removed since the build
+   */
+  LearnedScanIterator(const KeyManager &key_manager, std::shared_ptr<LearnedVersion> version, uint64_t position,
+                      uint64_t upper, std::vector<LearnedEntry> inserted, std::set<LearnedEntry> removed);
+
+  bool Next(RowId *row_id) override;
+
+  bool NextEntry(RowId *row_id, Row *key) override;
+
+ private:
+  // @return false once the data pages hold no entry of the range left, the next page is read first
+  bool ValidBase();
+
+  KeyManager key_manager_;
+  std::shared_ptr<LearnedVersion> version_;
+  uint64_t position_;
+  uint64_t upper_;
+  // entries of the data page being read
+  size_t page_{0};
+  std::vector<uint64_t> keys_;
+  std::vector<RowId> values_;
+  std::vector<LearnedEntry> inserted_;
+  size_t inserted_pos_{0};
+  std::set<LearnedEntry> removed_;
+};
+
+/**
+ * Learned index for read-mostly tables: the keys are read as integers (the normalized key of at most 8 bytes as a
+ * big-endian number, a single INT or FLOAT column), and instead of a tree of separator keys a piecewise linear model
+ * predicts where the entries of a key are.
+ * (1) The entries are written in key order into densely packed data pages. Segments are fitted greedily over the
+ *     first position of every key, each one as long as some slope keeps all of its keys within LEARNED_INDEX_ERROR
+ *     positions of their prediction. A lookup finds its segment by binary search, predicts the position and binary
+ *     searches the 2 * LEARNED_INDEX_ERROR entries around it, one or two data pages.
+ * (2) The segments and the data page ids are all that is kept in memory, a few bytes per data page for smooth key
+ *     distributions. They are written to model pages, listed on a meta page whose id is kept in the index roots page.
+ * (3) Inserts and removes go to an in-memory delta that lookups and scans merge in. Once the delta reaches
+ *     LEARNED_INDEX_REBUILD_RATIO of the index, the data pages and the model are rebuilt from scratch; VACUUM INDEX
+ *     rebuilds at once, and so does closing the index, so the delta is never lost.
+ * (4) latch_ guards the delta and the current build. A scan holds on to the build it started with.
+ */
+class LearnedIndex : public Index {
+ public:
+  LearnedIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+               bool unique = true);
+
+  ~LearnedIndex() override;
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanIterator> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                          bool upper_inclusive, Txn *txn) override;
+
+  dberr_t InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result, Txn *txn) override;
+
+  dberr_t BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) override;
+
+  dberr_t Vacuum(int *pages_released, Txn *txn) override;
+
+  dberr_t Destroy() override;
+
+  /**
+   * Rebuild the data pages and the model with the delta folded in.
+   * @return the pages released, negative if the index grew
+   */
+  int Rebuild();
+
+  size_t GetSegmentCount();
+
+  // bytes of the model kept in memory
+  size_t GetModelSize();
+
+  // entries inserted or removed since the last build
+  size_t GetDeltaSize();
+
+  uint64_t GetRebuildCount() const { return rebuilds_; }
+
+ protected:
+  // the normalized key as a big-endian integer
+  uint64_t KeyToInt(const GenericKey *key) const;
+
+  uint64_t RowToInt(const Row &key);
+
+  // a range bound that may hold the first key columns only, see KeyManager::SerializeFromPrefix
+  uint64_t BoundToInt(const Row &bound, bool greatest);
+
+  dberr_t Insert(uint64_t key, const RowId &row_id);
+
+  void Remove(uint64_t key, const RowId &row_id);
+
+  // row ids of key, latch_ latched by the caller
+  void LookupLocked(uint64_t key, std::vector<RowId> &result);
+
+  // entries with keys in [lower, upper]
+  std::unique_ptr<IndexScanIterator> ScanRange(uint64_t lower, uint64_t upper);
+
+  /**
+   * Write the entries given by next, in order, into new data pages and fit the model over them.
+   * @return the build, its model not written yet
+   */
+  std::shared_ptr<LearnedVersion> Build(const std::function<bool(uint64_t *, RowId *)> &next);
+
+  // write the model of version and point the meta page at it, then make it the current build
+  void Install(std::shared_ptr<LearnedVersion> version);
+
+  // read the build the meta page points at
+  void Open();
+
+  // latch_ write latched by the caller
+  int RebuildLocked();
+
+  KeyManager processor_;
+  bool unique_;
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t meta_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch latch_;
+  std::shared_ptr<LearnedVersion> version_;
+  std::set<LearnedEntry> inserted_;
+  std::set<LearnedEntry> removed_;  // entries of the data pages
+  std::atomic<uint64_t> rebuilds_{0};
+  bool destroyed_{false};
+};
+
+#endif  // MINISQL_LEARNED_INDEX_H
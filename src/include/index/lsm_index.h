@@ -0,0 +1,66 @@
+#ifndef MINISQL_LSM_INDEX_H
+#define MINISQL_LSM_INDEX_H
+
+#include <memory>
+
+#include "index/generic_key.h"
+#include "index/lsm_tree.h"
+#include "index/index.h"
+
+/**
+ * Range scan over an LSM tree.
+ */
+class LsmScanIterator : public IndexScanIterator {
+ public:
+  LsmScanIterator(const KeyManager &key_manager, std::unique_ptr<LsmTreeIterator> iterator);
+
+  bool Next(RowId *row_id) override;
+
+  bool NextEntry(RowId *row_id, Row *key) override;
+
+ private:
+  KeyManager key_manager_;
+  std::unique_ptr<LsmTreeIterator> iterator_;
+};
+
+/**
+ * Index on an LSM tree, for tables that are mostly inserted into: an entry goes to the memtable and reaches the
+ * pages with a whole run, written sequentially. Keys of a non-unique index end with the row id like those of
+ * BPlusTreeIndex, its entries are written blindly; a unique index looks the key up first, which the bloom filters
+ * of the runs keep cheap for new keys.
+ */
+class LsmIndex : public Index {
+ public:
+  LsmIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+           bool unique = true, uint32_t memtable_size = LSM_MEMTABLE_SIZE);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator = "=") override;
+
+  std::unique_ptr<IndexScanIterator> Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                          bool upper_inclusive, Txn *txn) override;
+
+  dberr_t InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) override;
+
+  dberr_t ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result, Txn *txn) override;
+
+  dberr_t BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) override;
+
+  dberr_t Destroy() override;
+
+  LsmTree &GetContainer() { return container_; }
+
+ protected:
+  // all the row ids of the serialized index_key, whose row id suffix is overwritten
+  void LookupKey(GenericKey *index_key, std::vector<RowId> &result);
+
+  KeyManager processor_;
+  LsmTree container_;
+};
+
+#endif  // MINISQL_LSM_INDEX_H
@@ -0,0 +1,216 @@
+#ifndef MINISQL_LSM_TREE_H
+#define MINISQL_LSM_TREE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "index/bloom_filter.h"
+#include "index/generic_key.h"
+#include "page/lsm_manifest_page.h"
+#include "page/lsm_run_page.h"
+
+/**
+ * Sorted run of an LSM tree, its pages chained in key order and never changed once written. The first key of every
+ * page (its fence) and a bloom filter over the key columns are kept in memory, a point lookup reads one page of the
+ * run at most. The pages of a run merged away are deleted once the last scan reading it lets it go.
+ */
+struct LsmRun {
+  LsmRun(BufferPoolManager *buffer_pool_manager, int key_size)
+      : buffer_pool_manager_(buffer_pool_manager), key_size_(key_size) {}
+
+  ~LsmRun();
+
+  // index of the page that may hold key: the last one whose fence is not greater than key
+  size_t FindPage(const GenericKey *key, const KeyManager &KM) const;
+
+  const GenericKey *FenceAt(size_t index) const {
+    return reinterpret_cast<const GenericKey *>(fences_.data() + index * key_size_);
+  }
+
+  BufferPoolManager *buffer_pool_manager_;
+  int key_size_;
+  std::vector<page_id_t> page_ids_;
+  std::vector<char> fences_;
+  uint64_t entry_count_{0};
+  std::unique_ptr<BloomFilter> filter_;
+  std::atomic<bool> obsolete_{false};  // merged away, its pages are deleted with it
+};
+
+/**
+ * Entries of an LSM tree between two keys in key order, merged from a copy of the memtable and the runs the tree had
+ * when the scan started. Of the entries of one key the newest one wins, tombstones are skipped unless a merge asks
+ * for them.
+ */
+class LsmTreeIterator {
+ public:
+  // lower and upper are copied, nullptr for no bound
+  LsmTreeIterator(const KeyManager &key_manager, std::vector<char> memtable_keys, std::vector<RowId> memtable_values,
+                  std::vector<std::shared_ptr<LsmRun>> runs, const GenericKey *lower, bool lower_inclusive,
+                  const GenericKey *upper, bool upper_inclusive, bool skip_tombstones = true);
+
+  /**
+   * @param key set to the key of the entry, valid until the next call
+   * @return false once the range is exhausted
+   */
+  bool Next(const GenericKey **key, RowId *value);
+
+ private:
+  // the memtable copy, or a run read one page at a time
+  struct Source {
+    std::shared_ptr<LsmRun> run_;
+    size_t page_{0};
+    std::vector<char> keys_;
+    std::vector<RowId> values_;
+    size_t pos_{0};
+  };
+
+  // @return false if the source is exhausted, the next page of a run is read first
+  bool Valid(Source &source);
+
+  void ReadPage(Source &source);
+
+  const GenericKey *KeyOf(const Source &source) const {
+    return reinterpret_cast<const GenericKey *>(source.keys_.data() + source.pos_ * key_manager_.GetKeySize());
+  }
+
+  KeyManager key_manager_;
+  std::vector<Source> sources_;  // newest first
+  std::vector<char> key_;        // key of the entry last returned
+  std::vector<char> lower_;      // empty if the range has no lower bound
+  bool lower_inclusive_;
+  std::vector<char> upper_;  // empty if the range has no upper bound
+  bool upper_inclusive_;
+  bool skip_tombstones_;
+};
+
+/**
+ * Log-structured merge tree of (key, row id) entries. Like BPlusTree it only holds unique keys, an index makes a
+ * non-unique one unique by appending the row id to its keys.
+ * (1) Writes go to an in-memory sorted memtable. A full memtable is written out as a new sorted run, its pages
+ *     allocated and filled one after another: an insert never writes a page in the middle of the index.
+ * (2) Remove writes a tombstone (INVALID_ROWID), which hides the older entries of its key. Both are dropped once
+ *     they are merged into the oldest run.
+ * (3) Runs are kept newest first. A background thread merges a run into the next older one as long as that one is
+ *     less than LSM_GROWTH_FACTOR times larger, so run sizes grow geometrically and there are O(log n) runs.
+ * (4) The fences and bloom filter of a run are rebuilt from its pages when the tree is opened. The runs are listed
+ *     on a manifest page whose id is kept in the index roots page; the memtable is written out when the tree is
+ *     closed.
+ * (5) latch_ guards the memtable and the run list. Writers hold it exclusively, a memtable written out blocks
+ *     readers until its run is in. Compaction only holds it to swap the merged run in.
+ */
+class LsmTree {
+ public:
+  // memtable_size: bytes of entries kept in memory before they are written out
+  LsmTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
+          uint32_t memtable_size = LSM_MEMTABLE_SIZE);
+
+  ~LsmTree();
+
+  LsmTree(const LsmTree &other) = delete;
+
+  LsmTree &operator=(const LsmTree &other) = delete;
+
+  /**
+   * @param check false to write the entry blindly, it then replaces any entry of the key
+   * @return false if check is set and the key is already there
+   */
+  bool Insert(const GenericKey *key, const RowId &value, bool check = true);
+
+  void Remove(const GenericKey *key);
+
+  bool IsEmpty();
+
+  // @return false if the key is not there
+  bool GetValue(const GenericKey *key, RowId *value);
+
+  /**
+   * Scan the entries between lower and upper, each bound included or not, nullptr for no bound. A range within one
+   * value of the key columns skips the runs whose bloom filter does not have it.
+   */
+  std::unique_ptr<LsmTreeIterator> Scan(const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                                        bool upper_inclusive);
+
+  /**
+   * Write count entries in strictly increasing key order into an empty tree as a single run.
+   * @return false if the tree is not empty or the keys are not strictly increasing, nothing is written then
+   */
+  bool BulkLoad(uint64_t count, const std::function<bool(GenericKey *, RowId *)> &next);
+
+  // write the memtable out as a run
+  void Flush();
+
+  // wait until the background thread has no run left to merge
+  void WaitForCompaction();
+
+  size_t GetRunCount();
+
+  // runs written from the memtable and runs merged, since the tree was opened
+  uint64_t GetFlushCount() const { return flushes_; }
+
+  uint64_t GetCompactionCount() const { return compactions_; }
+
+  // delete every page of the tree
+  void Destroy();
+
+ private:
+  // the memtable as a run, latch_ write latched by the caller
+  void FlushLocked();
+
+  // rewrite the manifest from runs_, latch_ write latched by the caller
+  void WriteManifest();
+
+  /**
+   * Write the entries given by next into a new run.
+   * @param capacity entries next gives at most, the bloom filter is sized for them
+   * @return the run, nullptr if no entry was written
+   */
+  std::shared_ptr<LsmRun> WriteRun(uint64_t capacity, const std::function<bool(GenericKey *, RowId *)> &next);
+
+  // read the fences and bloom filter of a run back from its pages
+  std::shared_ptr<LsmRun> OpenRun(page_id_t first_page_id, uint32_t entry_count);
+
+  // @return false if the run has no entry of key, value is INVALID_ROWID for a tombstone
+  bool LookupRun(const LsmRun &run, const GenericKey *key, uint64_t hash, RowId *value);
+
+  // newest entry of key, latch_ latched by the caller
+  bool LookupLocked(const GenericKey *key, RowId *value);
+
+  // body of the background thread
+  void CompactionLoop();
+
+  // merge the first run that is not much smaller than the next older one into it, @return false if none is
+  bool CompactOnce();
+
+  // stop the background thread, without waiting for the merges left
+  void StopCompaction();
+
+  index_id_t index_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyManager processor_;
+  uint32_t memtable_size_;
+  page_id_t manifest_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch latch_;
+  std::map<std::string, RowId> memtable_;
+  std::vector<std::shared_ptr<LsmRun>> runs_;  // newest first
+  std::atomic<uint64_t> flushes_{0};
+  std::atomic<uint64_t> compactions_{0};
+  bool destroyed_{false};
+  // background compaction
+  std::mutex compaction_mutex_;
+  std::condition_variable compaction_cv_;
+  bool compaction_pending_{false};
+  bool compacting_{false};
+  std::atomic<bool> stop_{false};
+  std::thread compactor_;
+};
+
+#endif  // MINISQL_LSM_TREE_H
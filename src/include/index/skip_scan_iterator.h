@@ -0,0 +1,53 @@
+#ifndef MINISQL_SKIP_SCAN_ITERATOR_H
+#define MINISQL_SKIP_SCAN_ITERATOR_H
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/index.h"
+
+/**
+ * Skip-scan of an ordered index whose first key column is not constrained: the range on the key columns after it
+ * is scanned once under every value of the first column. The next value is found by a scan starting right after the
+ * current one, so an index with few values of its first column is read in a few short ranges instead of in full.
+ */
+class SkipScanIterator : public IndexScanIterator {
+ public:
+  /**
+   * @param lower bound on the key columns after the first one, empty for none
+   * @param upper bound on the key columns after the first one, empty for none
+   */
+  SkipScanIterator(Index *index, std::vector<Field> lower, bool lower_inclusive, std::vector<Field> upper,
+                   bool upper_inclusive);
+
+  bool Next(RowId *row_id) override;
+
+  bool NextEntry(RowId *row_id, Row *key) override;
+
+  /**
+   * Count the values of the first key column of index, one short scan each.
+   * @return the count, limit + 1 if there are more than limit values
+   */
+  static size_t CountValues(Index *index, size_t limit);
+
+  // values of the first key column scanned so far
+  size_t GetValueCount() const { return values_; }
+
+ private:
+  // move to the value of the first key column after the current one and open its range, false if there is none
+  bool NextValue();
+
+  Index *index_;
+  std::vector<Field> lower_;
+  bool lower_inclusive_;
+  std::vector<Field> upper_;
+  bool upper_inclusive_;
+  std::optional<Field> value_;
+  std::unique_ptr<IndexScanIterator> range_;  // entries of the range under value_
+  size_t values_{0};
+  bool done_{false};
+};
+
+#endif  // MINISQL_SKIP_SCAN_ITERATOR_H
@@ -8,19 +8,15 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
  * K(i) <= K < K(i+1).
  * NOTE: since the number of keys does not equal to number of child pointers,
- * the first key always remains invalid. That is to say, any search/lookup
- * should ignore the first key.
+ * the first key is not stored. KeyAt(0) reads the lower fence of the page instead, which is also the lower
+ * fence of the first child; any search/lookup ignores it.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Entries are laid out by BPlusTreePage: | Key (prefix and trailing zeros dropped) | PAGE_ID (4) |.
  */
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
@@ -28,9 +24,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
             int max_size = UNDEFINED_SIZE);
 
-  GenericKey *KeyAt(int index);
+  void KeyAt(int index, GenericKey *key) const;
 
-  void SetKeyAt(int index, GenericKey *key);
+  // @return false if the page has no room for the new key
+  bool SetKeyAt(int index, const GenericKey *key);
 
   int ValueIndex(const page_id_t &value) const;
 
@@ -38,11 +35,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void SetValueAt(int index, page_id_t value);
 
-  void *PairPtrAt(int index);
-
-  void PairCopy(void *dest, void *src, int pair_num = 1);
-
-  page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
+  page_id_t Lookup(const GenericKey *key, const KeyManager &KP) const;
 
   void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
 
@@ -53,24 +46,18 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   page_id_t RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
+  bool MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
 
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
 
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                        BufferPoolManager *buffer_pool_manager);
-
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                         BufferPoolManager *buffer_pool_manager);
-
- private:
-  void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
-
-  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+  // keep fill_factor of the bytes and move the rest to recipient, for splits at the right edge of a level
+  void MoveTailTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager, double fill_factor);
 
-  void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
+  bool RebalanceWith(BPlusTreeInternalPage *right, BPlusTreeInternalPage *parent, int index,
+                     BufferPoolManager *buffer_pool_manager);
 
-  char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
+  // set this page as the parent of the children [begin, end)
+  void Adopt(int begin, int end, BufferPoolManager *buffer_pool_manager);
 };
 
 using InternalPage = BPlusTreeInternalPage;
@@ -7,19 +7,10 @@
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
-
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * Leaves are chained both ways through NextPageId and PrevPageId, for scans in either direction.
  *
- *  Header format (size in byte, 24 bytes in total):
- *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
- *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ * Entries are laid out by BPlusTreePage: | Key (prefix and trailing zeros dropped) | RowId (8) |.
+ * Keys are read into a caller buffer of the key size, the page holds no full key to point at.
  */
 #include <utility>
 #include <vector>
@@ -27,7 +18,7 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
+class BPlusTreeInternalPage;
 
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
@@ -41,48 +32,37 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   void SetNextPageId(page_id_t next_page_id);
 
-  GenericKey *KeyAt(int index);
+  page_id_t GetPrevPageId() const;
+
+  void SetPrevPageId(page_id_t prev_page_id);
 
-  void SetKeyAt(int index, GenericKey *key);
+  void KeyAt(int index, GenericKey *key) const;
 
   RowId ValueAt(int index) const;
 
   void SetValueAt(int index, RowId value);
 
-  int KeyIndex(const GenericKey *key, const KeyManager &comparator);
-
-  void *PairPtrAt(int index);
+  int KeyIndex(const GenericKey *key, const KeyManager &comparator) const;
 
-  void PairCopy(void *dest, void *src, int pair_num = 1);
-
-  std::pair<GenericKey *, RowId> GetItem(int index);
+  // index of the last key not greater than key, -1 if there is none
+  int LastKeyIndex(const GenericKey *key, const KeyManager &comparator) const;
 
   // insert and delete methods
   int Insert(GenericKey *key, const RowId &value, const KeyManager &comparator);
 
-  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator);
+  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator) const;
 
   int RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &comparator);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
 
-  void MoveAllTo(BPlusTreeLeafPage *recipient);
-
-  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
-
-  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
-
- private:
-  void CopyNFrom(void *src, int size);
-
-  void CopyLastFrom(GenericKey *key, const RowId value);
-
-  void CopyFirstFrom(GenericKey *key, const RowId value);
+  // keep fill_factor of the bytes and move the rest to recipient, for splits at the right edge of a level
+  void MoveTailTo(BPlusTreeLeafPage *recipient, double fill_factor);
 
-  page_id_t next_page_id_{INVALID_PAGE_ID};
+  bool MoveAllTo(BPlusTreeLeafPage *recipient);
 
-  char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
+  bool RebalanceWith(BPlusTreeLeafPage *right, BPlusTreeInternalPage *parent, int index);
 };
 
 using LeafPage = BPlusTreeLeafPage;
@@ -5,28 +5,81 @@
 #include <climits>
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "index/generic_key.h"
 
 // define page type enum
 enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
 
 #define UNDEFINED_SIZE 0
+#define BPLUS_TREE_PAGE_HEADER_SIZE 48
 /**
  * Both internal and leaf page are inherited from this page.
  *
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
+ * It also lays out the entries of both: keys have variable length, so every entry is reached through a slot.
  *
- * Header format (size in byte, 28 bytes in total):
+ * Header format (size in byte, 48 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | NextPageId (4) | PrevPageId (4) | HeapOffset (2) | HeapSize (2) |
  * ----------------------------------------------------------------------------
+ * | PrefixSize (2) | LowerFenceSize (2) | UpperFenceSize (2) | Reserved (2) |
+ * ----------------------------------------------------------------------------
+ *
+ * Data format, slots grow forward and entries backward:
+ * -------------------------------------------------------------------------------------------
+ * | SLOT(1) | ... | SLOT(n) | FREE SPACE | ENTRIES (any order) | LOWER FENCE | UPPER FENCE |
+ * -------------------------------------------------------------------------------------------
+ * Slot: | EntryOffset (2) | KeySize (2) | Head (4) |, in key order. Entry: | Key (KeySize) | Value |
+ *
+ * Keys are normalized (see KeyProjector) and compare with memcmp over the key size of the tree. A key is stored
+ * without
+ *  - the prefix of the page: the fences are the separators around the page in its parent, every key routed to the
+ *    page lies in [lower fence, upper fence) and shares their common prefix, kept once as the head of the lower fence
+ *  - its trailing zero bytes: a shorter key stands for itself padded with zeros
+ * Head is the first 4 stored bytes read as a big-endian integer, most comparisons of a search end on it. A search
+ * runs over the heads of the slot array first, with AVX2 or SSE2 compares when the cpu has them, and compares full
+ * keys only among the slots sharing the head of the search key.
+ * The fences are kept the same way, without trailing zeros. The leftmost page of a level has an empty lower fence,
+ * the rightmost one no upper fence.
  */
 class BPlusTreePage {
  public:
+  /**
+   * Full keys and values of a run of entries, taken out of pages to be laid out again under other fences.
+   */
+  class EntryList {
+   public:
+    EntryList(int key_size, int value_size) : key_size_(key_size), value_size_(value_size) {}
+
+    void Append(const GenericKey *key, const void *value);
+
+    // drop the first count entries
+    void EraseFront(int count);
+
+    int GetCount() const { return static_cast<int>(trimmed_sizes_.size()); }
+
+    const GenericKey *KeyAt(int index) const { return reinterpret_cast<const GenericKey *>(EntryAt(index)); }
+
+    const char *ValueAt(int index) const { return EntryAt(index) + key_size_; }
+
+    // bytes of the key left once its trailing zeros are dropped
+    int GetTrimmedSize(int index) const { return trimmed_sizes_[index]; }
+
+   private:
+    const char *EntryAt(int index) const { return data_.data() + index * (key_size_ + value_size_); }
+
+    int key_size_;
+    int value_size_;
+    std::vector<char> data_;
+    std::vector<uint16_t> trimmed_sizes_;
+  };
+
   bool IsLeafPage() const;
 
   bool IsRootPage() const;
@@ -59,7 +112,166 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  // bytes of page data taken by slots, entries and fences
+  int GetUsedSpace() const;
+
+  int GetFreeSpace() const { return DATA_SIZE - GetUsedSpace(); }
+
+  // bytes taken by an entry whose key shares nothing with the page prefix
+  int GetMaxEntrySize() const { return SLOT_SIZE + GetKeySize() + GetValueSize(); }
+
+  /**
+   * @return true if a page of count entries taking used_space bytes does not overflow: it stays below max size and
+   * still has room for one more entry of any key
+   */
+  bool CanHold(int count, int used_space) const;
+
+  /**
+   * A page is split once it overflows, so an insert into a page that does not overflow always fits.
+   */
+  bool IsOverflow() const { return !CanHold(GetSize(), GetUsedSpace()); }
+
+  // below half of max size and merge_threshold of the page space, or left with no entry (no two children)
+  bool IsUnderflow(double merge_threshold) const;
+
+  int GetPrefixSize() const { return prefix_size_; }
+
+  // the lower fence, padded with zeros to the key size
+  void GetLowerFence(GenericKey *key) const;
+
+  bool HasUpperFence() const { return upper_fence_size_ != NO_UPPER_FENCE; }
+
+  void GetUpperFence(GenericKey *key) const;
+
+  /**
+   * Append the entries in [begin, end) to list. The key of the first entry of an internal page is its lower fence.
+   */
+  void DecodeEntries(int begin, int end, EntryList *list) const;
+
+  /**
+   * @return bytes taken by the entries [begin, end) of list laid out under the fences lower and upper
+   * (nullptr for no upper fence)
+   */
+  int EncodedSize(const EntryList &list, int begin, int end, const GenericKey *lower, const GenericKey *upper) const;
+
+  /**
+   * Replace the content of the page by the entries [begin, end) of list under the given fences. The entries must fit
+   * and lie between the fences.
+   */
+  void Build(const EntryList &list, int begin, int end, const GenericKey *lower, const GenericKey *upper);
+
+  /**
+   * Bulk loading: build the page from the longest run of list entries starting at begin that fills no more than
+   * fill_factor of it, one entry at least. The run ends before the last entry of list unless last is set, its upper
+   * fence is then written to upper.
+   * @return number of entries taken
+   */
+  int BuildFrom(const EntryList &list, int begin, bool last, const GenericKey *lower, double fill_factor,
+                GenericKey *upper);
+
+  /**
+   * Separator of the entries index - 1 and index of list: the shortest prefix of the key at index greater than the
+   * key before it for leaf pages, the key at index itself for internal pages.
+   */
+  void MakeSeparator(const EntryList &list, int index, GenericKey *separator) const;
+
+  // @return true if the key at index can be replaced by key without making the page overflow
+  bool CanReplaceKey(int index, const GenericKey *key) const;
+
+  // name of the head search kernel picked for this cpu: avx2, sse2 or scalar
+  static const char *GetSearchKernel();
+
+  static constexpr int DATA_SIZE = PAGE_SIZE - BPLUS_TREE_PAGE_HEADER_SIZE;
+  static constexpr int SLOT_SIZE = 8;
+  /**
+   * Largest key size of a tree, values take 8 bytes at most. A page then holds its two fences and four entries of
+   * the largest size, so an overflowed page has four entries at least and splits into two pages of two entries.
+   * Keys are stored without their trailing zeros: short values of a wide key column take only their own bytes.
+   */
+  static constexpr int MAX_KEY_SIZE = (DATA_SIZE - 4 * (SLOT_SIZE + 8)) / 6 / 4 * 4;
+
+ protected:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t key_size_;
+    uint32_t head_;
+  };
+
+  /** A search key split against the prefix of the page */
+  struct SearchKey {
+    const char *rest_;  // key bytes after the prefix
+    int significant_;   // bytes of rest_ up to its last non zero byte
+    uint32_t head_;
+  };
+
+  void InitPage(IndexPageType page_type, page_id_t page_id, page_id_t parent_id, int key_size, int max_size);
+
+  int GetValueSize() const { return IsLeafPage() ? sizeof(RowId) : sizeof(page_id_t); }
+
+  const Slot &SlotAt(int index) const { return reinterpret_cast<const Slot *>(data_)[index]; }
+
+  Slot &SlotAt(int index) { return reinterpret_cast<Slot *>(data_)[index]; }
+
+  const char *ValuePtrAt(int index) const { return data_ + SlotAt(index).offset_ + SlotAt(index).key_size_; }
+
+  char *ValuePtrAt(int index) { return data_ + SlotAt(index).offset_ + SlotAt(index).key_size_; }
+
+  // write the key at index padded to the key size, the lower fence for the first entry of an internal page
+  void ReadKey(int index, GenericKey *key) const;
+
+  // compare key with the key at index, which must not be the first entry of an internal page
+  int CompareKeyAt(const GenericKey *key, int index) const;
+
+  // @return first index from begin whose key is not less than key
+  int LowerBound(const GenericKey *key, int begin) const;
+
+  // @return first index from begin whose key is greater than key
+  int UpperBound(const GenericKey *key, int begin) const;
+
+  /**
+   * Insert an entry at index, key nullptr for the first entry of an internal page, which has none.
+   * @return false if the page has no room left
+   */
+  bool InsertEntry(int index, const GenericKey *key, const void *value);
+
+  void RemoveEntry(int index);
+
+  void ReplaceKey(int index, const GenericKey *key);
+
+  // @return index splitting list into two runs, the first one with about fraction of the bytes, with one entry at
+  // least on each side
+  static int MiddleOf(const EntryList &list, double fraction = 0.5);
+
+  static int TrimmedSize(const char *key, int size);
+
+  static uint32_t KeyHead(const char *key, int size);
+
  private:
+  // -1 if key is below the prefix of the page, 1 if above, 0 if it starts with it
+  int ComparePrefix(const GenericKey *key) const;
+
+  SearchKey MakeSearchKey(const GenericKey *key) const;
+
+  // compare the search key with the key at index
+  int CompareAt(const SearchKey &key, int index) const;
+
+  // @return first index in [begin, end) whose head is not below head
+  int HeadLowerBound(uint32_t head, int begin, int end) const;
+
+  // [first, last): the entries from begin sharing the head of key, the ones before are less and the ones after greater
+  void HeadRange(const SearchKey &key, int begin, int *first, int *last) const;
+
+  int GetFenceSize() const { return lower_fence_size_ + (HasUpperFence() ? upper_fence_size_ : 0); }
+
+  const char *LowerFencePtr() const { return data_ + DATA_SIZE - GetFenceSize(); }
+
+  // gather the entries at the end of the free space
+  void Compact();
+
+  int FencePrefixSize(const GenericKey *lower, const GenericKey *upper) const;
+
+  static constexpr uint16_t NO_UPPER_FENCE = UINT16_MAX;
+
   // member variable, attributes that both internal and leaf page share
   [[maybe_unused]] IndexPageType page_type_;
   [[maybe_unused]] int key_size_;
@@ -68,6 +280,23 @@ class BPlusTreePage {
   [[maybe_unused]] int max_size_;
   [[maybe_unused]] page_id_t parent_page_id_;
   [[maybe_unused]] page_id_t page_id_;
+
+ protected:
+  page_id_t next_page_id_;  // leaf pages only
+  page_id_t prev_page_id_;  // leaf pages only
+
+ private:
+  uint16_t heap_offset_;
+  uint16_t heap_size_;  // bytes of live entries
+  uint16_t prefix_size_;
+  uint16_t lower_fence_size_;
+  uint16_t upper_fence_size_;
+  [[maybe_unused]] uint16_t reserved_;
+
+ protected:
+  char data_[DATA_SIZE];
 };
 
+static_assert(sizeof(BPlusTreePage) == PAGE_SIZE, "B+ tree page must fill a page.");
+
 #endif  // MINISQL_B_PLUS_TREE_PAGE_H
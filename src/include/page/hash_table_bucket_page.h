@@ -0,0 +1,74 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+#define HASH_TABLE_BUCKET_PAGE_HEADER_SIZE 16
+
+/**
+ * Bucket of an extendible hash table, entries are unordered.
+ *
+ * Format (size in byte):
+ * ----------------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | KeySize (4) | CurrentSize (4) | ENTRY(1) | ... |
+ * ----------------------------------------------------------------------------------
+ * Entry: | Key (KeySize) | RowId (8) |
+ *
+ * A bucket whose entries all share one hash can not be split, the entries that do not fit then go to overflow
+ * pages chained from it by next page id.
+ */
+class HashTableBucketPage {
+ public:
+  // largest key size of a hash table, a bucket holds four entries at least
+  static constexpr int MAX_KEY_SIZE =
+      (PAGE_SIZE - HASH_TABLE_BUCKET_PAGE_HEADER_SIZE) / 4 - static_cast<int>(sizeof(RowId));
+
+  void Init(page_id_t page_id, int key_size);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  int GetSize() const { return size_; }
+
+  int GetMaxSize() const { return (PAGE_SIZE - HASH_TABLE_BUCKET_PAGE_HEADER_SIZE) / GetEntrySize(); }
+
+  bool IsFull() const { return size_ >= GetMaxSize(); }
+
+  const GenericKey *KeyAt(int index) const { return reinterpret_cast<const GenericKey *>(EntryAt(index)); }
+
+  RowId ValueAt(int index) const;
+
+  /**
+   * @param value nullptr to match any value
+   * @return index of the first entry of key and value, -1 if there is none
+   */
+  int Find(const GenericKey *key, const RowId *value, const KeyManager &KM) const;
+
+  // the page must not be full
+  void Append(const GenericKey *key, const RowId &value);
+
+  // the last entry takes the place of the removed one
+  void RemoveAt(int index);
+
+ private:
+  int GetEntrySize() const { return key_size_ + static_cast<int>(sizeof(RowId)); }
+
+  char *EntryAt(int index) { return data_ + index * GetEntrySize(); }
+
+  const char *EntryAt(int index) const { return data_ + index * GetEntrySize(); }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int key_size_;
+  int size_;
+  char data_[PAGE_SIZE - HASH_TABLE_BUCKET_PAGE_HEADER_SIZE];
+};
+
+static_assert(sizeof(HashTableBucketPage) == PAGE_SIZE, "Hash table bucket page must fill a page.");
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
@@ -0,0 +1,76 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * Directory of an extendible hash table. Entry i points to the bucket of the keys whose hash ends with the
+ * global depth low bits of i; a bucket of local depth d is shared by the 2^(global depth - d) entries that agree on
+ * their d low bits.
+ *
+ * Format (size in byte):
+ * --------------------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | LocalDepths (1 * 512) | BucketPageIds (4 * 512) |
+ * --------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  static constexpr uint32_t MAX_DEPTH = 9;
+  static constexpr uint32_t DIRECTORY_ARRAY_SIZE = 1 << MAX_DEPTH;
+
+  // a directory of global depth 0, its single entry pointing to bucket_page_id
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  // mask of the hash bits that index the directory
+  uint32_t GetGlobalDepthMask() const { return (1u << global_depth_) - 1; }
+
+  uint32_t Size() const { return 1u << global_depth_; }
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) { bucket_page_ids_[bucket_idx] = bucket_page_id; }
+
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+    local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+  }
+
+  /**
+   * Double the directory, the new upper half points to the same buckets as the lower one.
+   * @return false if the directory is at its max depth
+   */
+  bool Grow();
+
+  /**
+   * Halve the directory while every bucket has a local depth below the global depth.
+   */
+  void ShrinkAll();
+
+  /**
+   * The entry pointing to the bucket bucket_idx split from, or is split into: the one differing in the highest
+   * bit of its local depth.
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  /**
+   * Point every entry sharing the local depth low bits of bucket_idx to bucket_page_id, with the given local depth.
+   */
+  void SetBucket(uint32_t bucket_idx, uint32_t local_depth, page_id_t bucket_page_id);
+
+ private:
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "Hash table directory does not fit in a page.");
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
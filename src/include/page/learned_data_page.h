@@ -0,0 +1,60 @@
+#ifndef MINISQL_LEARNED_DATA_PAGE_H
+#define MINISQL_LEARNED_DATA_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/rowid.h"
+
+#define LEARNED_DATA_PAGE_HEADER_SIZE 16
+
+/**
+ * Data page of a learned index. The entries of the index are written in key order into pages that are all full but
+ * the last one, so the position of an entry names its page and slot: position / MAX_SIZE and position % MAX_SIZE.
+ * The pages are chained by next page id and never changed once written, an update rebuilds them all.
+ *
+ * Format (size in byte):
+ * ----------------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | CurrentSize (4) | Reserved (4) | ENTRY(1) | ... |
+ * ----------------------------------------------------------------------------------
+ * Entry: | Key (8) | RowId (8) |, the key is the normalized key read as a big-endian integer
+ */
+class LearnedDataPage {
+ public:
+  static constexpr uint32_t MAX_SIZE = (PAGE_SIZE - LEARNED_DATA_PAGE_HEADER_SIZE) / (8 + sizeof(RowId));
+
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetSize() const { return size_; }
+
+  bool IsFull() const { return size_ >= MAX_SIZE; }
+
+  uint64_t KeyAt(uint32_t index) const { return entries_[index].key_; }
+
+  RowId ValueAt(uint32_t index) const;
+
+  // the page must not be full, and key must not be less than the last key
+  void Append(uint64_t key, const RowId &value);
+
+ private:
+  struct Entry {
+    uint64_t key_;
+    int64_t value_;
+  };
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  uint32_t size_;
+  uint32_t reserved_;
+  Entry entries_[MAX_SIZE];
+};
+
+static_assert(sizeof(LearnedDataPage) <= PAGE_SIZE, "Learned data page must fit in a page.");
+
+#endif  // MINISQL_LEARNED_DATA_PAGE_H
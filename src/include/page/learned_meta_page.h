@@ -0,0 +1,49 @@
+#ifndef MINISQL_LEARNED_META_PAGE_H
+#define MINISQL_LEARNED_META_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * Meta page of a learned index, its page id is kept in the index roots page like the root of a B+ tree. A rebuild
+ * writes the new data and model pages first and then switches the meta page over to them.
+ *
+ * Format (size in byte):
+ * ------------------------------------------------------------------------------------------------
+ * | PageId (4) | FirstModelPageId (4) | SegmentCount (4) | DataPageCount (4) | EntryCount (8) |
+ * ------------------------------------------------------------------------------------------------
+ */
+class LearnedMetaPage {
+ public:
+  void Init(page_id_t page_id) {
+    page_id_ = page_id;
+    Set(INVALID_PAGE_ID, 0, 0, 0);
+  }
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  page_id_t GetFirstModelPageId() const { return first_model_page_id_; }
+
+  uint32_t GetSegmentCount() const { return segment_count_; }
+
+  uint32_t GetDataPageCount() const { return data_page_count_; }
+
+  uint64_t GetEntryCount() const { return entry_count_; }
+
+  void Set(page_id_t first_model_page_id, uint32_t segment_count, uint32_t data_page_count, uint64_t entry_count) {
+    first_model_page_id_ = first_model_page_id;
+    segment_count_ = segment_count;
+    data_page_count_ = data_page_count;
+    entry_count_ = entry_count;
+  }
+
+ private:
+  page_id_t page_id_;
+  page_id_t first_model_page_id_;
+  uint32_t segment_count_;
+  uint32_t data_page_count_;
+  uint64_t entry_count_;
+};
+
+#endif  // MINISQL_LEARNED_META_PAGE_H
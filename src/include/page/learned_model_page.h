@@ -0,0 +1,60 @@
+#ifndef MINISQL_LEARNED_MODEL_PAGE_H
+#define MINISQL_LEARNED_MODEL_PAGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/config.h"
+
+#define LEARNED_MODEL_PAGE_HEADER_SIZE 16
+
+/**
+ * Page of the model of a learned index: its segments followed by the page ids of its data pages, written as one
+ * byte stream over a chain of model pages.
+ *
+ * Format (size in byte):
+ * -----------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | CurrentSize (4) | Reserved (4) | Bytes ... |
+ * -----------------------------------------------------------------------------
+ */
+class LearnedModelPage {
+ public:
+  static constexpr uint32_t MAX_SIZE = PAGE_SIZE - LEARNED_MODEL_PAGE_HEADER_SIZE;
+
+  void Init(page_id_t page_id) {
+    page_id_ = page_id;
+    next_page_id_ = INVALID_PAGE_ID;
+    size_ = 0;
+    reserved_ = 0;
+  }
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetSize() const { return size_; }
+
+  const char *GetBytes() const { return data_; }
+
+  // @return bytes appended, less than size once the page is full
+  uint32_t Append(const char *bytes, uint32_t size) {
+    uint32_t count = std::min(size, MAX_SIZE - size_);
+    memcpy(data_ + size_, bytes, count);
+    size_ += count;
+    return count;
+  }
+
+ private:
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  uint32_t size_;
+  uint32_t reserved_;
+  char data_[MAX_SIZE];
+};
+
+static_assert(sizeof(LearnedModelPage) == PAGE_SIZE, "Learned model page must fill a page.");
+
+#endif  // MINISQL_LEARNED_MODEL_PAGE_H
@@ -0,0 +1,59 @@
+#ifndef MINISQL_LSM_MANIFEST_PAGE_H
+#define MINISQL_LSM_MANIFEST_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * Manifest of an LSM tree: its sorted runs, newest first. Its page id is kept in the index roots page, like the
+ * root of a B+ tree.
+ *
+ * Format (size in byte):
+ * ------------------------------------------------------------------------------------------------
+ * | PageId (4) | RunCount (4) | Run_1 first page id (4) | Run_1 entry count (4) | ... |
+ * ------------------------------------------------------------------------------------------------
+ */
+class LsmManifestPage {
+ public:
+  static constexpr uint32_t MAX_RUN_COUNT = (PAGE_SIZE - 8) / 8;
+
+  void Init(page_id_t page_id) {
+    page_id_ = page_id;
+    run_count_ = 0;
+  }
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t GetRunCount() const { return run_count_; }
+
+  page_id_t GetFirstPageId(uint32_t index) const { return runs_[index].first_page_id_; }
+
+  uint32_t GetEntryCount(uint32_t index) const { return runs_[index].entry_count_; }
+
+  // the runs are rewritten as a whole, one after another
+  void Clear() { run_count_ = 0; }
+
+  // @return false if the manifest is full
+  bool Append(page_id_t first_page_id, uint32_t entry_count) {
+    if (run_count_ == MAX_RUN_COUNT) {
+      return false;
+    }
+    runs_[run_count_++] = {first_page_id, entry_count};
+    return true;
+  }
+
+ private:
+  struct RunEntry {
+    page_id_t first_page_id_;
+    uint32_t entry_count_;
+  };
+
+  page_id_t page_id_;
+  uint32_t run_count_;
+  RunEntry runs_[MAX_RUN_COUNT];
+};
+
+static_assert(sizeof(LsmManifestPage) <= PAGE_SIZE, "LSM manifest page must fit in a page.");
+
+#endif  // MINISQL_LSM_MANIFEST_PAGE_H
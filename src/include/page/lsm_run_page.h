@@ -0,0 +1,65 @@
+#ifndef MINISQL_LSM_RUN_PAGE_H
+#define MINISQL_LSM_RUN_PAGE_H
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+#define LSM_RUN_PAGE_HEADER_SIZE 16
+
+/**
+ * Page of a sorted run of an LSM tree. A run is written once, page after page in key order, and never changed: its
+ * pages are chained by next page id and each holds a slice of the entries in key order.
+ *
+ * Format (size in byte):
+ * ----------------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | KeySize (4) | CurrentSize (4) | ENTRY(1) | ... |
+ * ----------------------------------------------------------------------------------
+ * Entry: | Key (KeySize) | RowId (8) |, a tombstone has INVALID_ROWID as row id
+ */
+class LsmRunPage {
+ public:
+  // largest key size of an LSM tree, a page holds four entries at least
+  static constexpr int MAX_KEY_SIZE = (PAGE_SIZE - LSM_RUN_PAGE_HEADER_SIZE) / 4 - static_cast<int>(sizeof(RowId));
+
+  void Init(page_id_t page_id, int key_size);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  int GetSize() const { return size_; }
+
+  int GetMaxSize() const { return (PAGE_SIZE - LSM_RUN_PAGE_HEADER_SIZE) / GetEntrySize(); }
+
+  bool IsFull() const { return size_ >= GetMaxSize(); }
+
+  const GenericKey *KeyAt(int index) const { return reinterpret_cast<const GenericKey *>(EntryAt(index)); }
+
+  RowId ValueAt(int index) const;
+
+  // index of the first key not less than key, size if there is none
+  int KeyIndex(const GenericKey *key, const KeyManager &KM) const;
+
+  // the page must not be full, and key must not be less than the last key
+  void Append(const GenericKey *key, const RowId &value);
+
+ private:
+  int GetEntrySize() const { return key_size_ + static_cast<int>(sizeof(RowId)); }
+
+  char *EntryAt(int index) { return data_ + index * GetEntrySize(); }
+
+  const char *EntryAt(int index) const { return data_ + index * GetEntrySize(); }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int key_size_;
+  int size_;
+  char data_[PAGE_SIZE - LSM_RUN_PAGE_HEADER_SIZE];
+};
+
+static_assert(sizeof(LsmRunPage) == PAGE_SIZE, "LSM run page must fill a page.");
+
+#endif  // MINISQL_LSM_RUN_PAGE_H
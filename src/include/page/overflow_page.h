@@ -0,0 +1,44 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+/**
+ * Overflow page format: one piece of a char value too long to be kept in its row. The pieces of a value are
+ * chained through NextPageId, the row only keeps the value length and the id of the first page.
+ *  ---------------------------------------------------------
+ *  | NextPageId (4) | DataSize (4) | ... DATA ... |
+ *  ---------------------------------------------------------
+ **/
+
+#include <cstring>
+
+#include "common/config.h"
+#include "page/page.h"
+
+class OverflowPage : public Page {
+ public:
+  void Init(page_id_t next_page_id);
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  uint32_t GetDataSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /**
+   * Copy up to MAX_DATA_SIZE bytes of data into the page.
+   * @return number of bytes written
+   */
+  uint32_t WriteData(const char *data, uint32_t size);
+
+  /**
+   * Copy the data of this page into buf.
+   * @return number of bytes read
+   */
+  uint32_t ReadData(char *buf);
+
+ private:
+  static constexpr size_t OFFSET_DATA_SIZE = 4;
+  static constexpr size_t OFFSET_DATA = 8;
+
+ public:
+  static constexpr uint32_t MAX_DATA_SIZE = PAGE_SIZE - OFFSET_DATA;
+};
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
@@ -0,0 +1,141 @@
+#ifndef MINISQL_PAX_PAGE_H
+#define MINISQL_PAX_PAGE_H
+/**
+ * PAX (Partition Attributes Across) page format: the tuples of a page are split by column, the values of one
+ * column are stored contiguously in a minipage so that a scan over one column walks a dense array.
+ *  ---------------------------------------------------------------------------------------
+ *  | HEADER | SLOT STATES | COLUMN_1 MINIPAGE | COLUMN_2 MINIPAGE | ... | COLUMN_N MINIPAGE |
+ *  ---------------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes):
+ *  ---------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| TupleCount (4) | Capacity (4) |
+ *  ---------------------------------------------------------------------------------------------
+ *  Slot states: one byte per slot, empty / live / marked deleted.
+ *  Column minipage: Capacity null flags (1 byte each) followed by Capacity fixed-width values. A value is the
+ *  serialized field padded to the column width: 4 bytes for int and float, 4 + declared length for char.
+ *
+ *  Every page of a table has the same capacity, computed from the schema. PageId, LSN, PrevPageId and NextPageId
+ *  sit at the same offsets as in TablePage, so code only walking the page chain works on both layouts.
+ **/
+
+#include <cstring>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/txn.h"
+#include "page/page.h"
+#include "record/row.h"
+#include "recovery/log_manager.h"
+
+class PaxPage : public Page {
+ public:
+  void Init(page_id_t page_id, page_id_t prev_id, Schema *schema, LogManager *log_mgr, Txn *txn);
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  bool InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn, LockManager *lock_manager,
+                   LogManager *log_manager);
+
+  void ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager);
+
+  void RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager);
+
+  bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
+
+  bool GetFirstTupleRid(RowId *first_rid);
+
+  bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
+
+  /**
+   * Turn the slots marked deleted into free slots and drop trailing free slots.
+   */
+  void Compact(Txn *txn, LogManager *log_manager);
+
+  uint32_t GetLiveTupleCount();
+
+  /**
+   * @return slot numbers of the live tuples, in slot order
+   */
+  void GetLiveSlots(std::vector<uint32_t> *slots);
+
+  /**
+   * Read one column of the given slots, walking the column minipage sequentially. The field at column_id of
+   * rows[i] is replaced by the value of slots[i]; every row must already hold one field per column.
+   */
+  void GetColumn(Schema *schema, uint32_t column_id, const std::vector<uint32_t> &slots, std::vector<Row> *rows);
+
+  /**
+   * @return bytes accounted to the live tuples, used to decide whether two pages can be merged
+   */
+  uint32_t GetUsedSpace() { return GetLiveTupleCount() * GetTupleWidth(); }
+
+  uint32_t GetFreeSpaceRemaining() { return (GetCapacity() - GetLiveTupleCount()) * GetTupleWidth(); }
+
+  /**
+   * @return number of tuples a page of this schema holds, 0 if a tuple does not fit in a page
+   */
+  static uint32_t ComputeCapacity(const Schema *schema);
+
+  /**
+   * @return false if a value of row is wider than its column, the row then fits no page of this schema
+   */
+  static bool FitsColumns(const Row &row, const Schema *schema);
+
+ private:
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+
+  uint32_t GetCapacity() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_CAPACITY); }
+
+  void SetCapacity(uint32_t capacity) { memcpy(GetData() + OFFSET_CAPACITY, &capacity, sizeof(uint32_t)); }
+
+  /** Bytes of the page accounted to one slot, derived from the capacity so no schema is needed */
+  uint32_t GetTupleWidth() { return GetCapacity() == 0 ? 0 : (PAGE_SIZE - SIZE_PAX_PAGE_HEADER) / GetCapacity(); }
+
+  uint8_t GetSlotState(uint32_t slot_num) { return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_SLOTS + slot_num); }
+
+  void SetSlotState(uint32_t slot_num, uint8_t state) { GetData()[OFFSET_SLOTS + slot_num] = state; }
+
+  /** @return offset of the null flags of a column, its values follow right after them */
+  uint32_t GetColumnOffset(const Schema *schema, uint32_t column_id);
+
+  static uint32_t GetColumnWidth(const Column *column);
+
+  bool WriteFields(const Row &row, Schema *schema, uint32_t slot_num);
+
+  void ReadField(const Schema *schema, uint32_t column_id, uint32_t column_offset, uint32_t slot_num, Field *field);
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+  static constexpr uint8_t SLOT_EMPTY = 0;
+  static constexpr uint8_t SLOT_LIVE = 1;
+  static constexpr uint8_t SLOT_DELETED = 2;
+  static constexpr size_t SIZE_PAX_PAGE_HEADER = 24;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 16;
+  static constexpr size_t OFFSET_CAPACITY = 20;
+  static constexpr size_t OFFSET_SLOTS = 24;
+};
+
+#endif  // MINISQL_PAX_PAGE_H
@@ -18,6 +18,7 @@
  **/
 
 #include <cstring>
+#include <vector>
 
 #include "common/macros.h"
 #include "common/rowid.h"
@@ -62,6 +63,35 @@ class TablePage : public Page {
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * Read every tuple marked deleted but not yet removed, so that the overflow pages they own can be released
+   * before the page is compacted.
+   */
+  void GetDeletedTuples(Schema *schema, std::vector<Row> *rows);
+
+  /**
+   * Physically remove every tuple marked deleted, pack the remaining tuples against the end of the page and
+   * drop trailing empty slots. Live tuples keep their slot numbers, so their RowIds stay valid.
+   */
+  void Compact(Txn *txn, LogManager *log_manager);
+
+  /**
+   * @return number of live (not deleted) tuples in this page
+   */
+  uint32_t GetLiveTupleCount();
+
+  /**
+   * @return bytes (tuple data plus slots) needed to re-insert all tuples of this page elsewhere,
+   *         exact after Compact() and an upper bound otherwise
+   */
+  uint32_t GetUsedSpace() {
+    return PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - GetFreeSpacePointer() + SIZE_TUPLE * GetLiveTupleCount();
+  }
+
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
  private:
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
@@ -73,10 +103,6 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
   }
@@ -27,7 +27,7 @@
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_quit sql_exec_file sql_vacuum
 
 %%
 
@@ -58,6 +58,7 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_vacuum { $$ = $1; }
   ;
 
 sql_create_database:
@@ -101,6 +102,19 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' IDENTIFIER '(' IDENTIFIER EQ IDENTIFIER ')' {
+    /* with (layout = row | pax), with and layout are matched as identifiers */
+    if (strcmp($7->val_, "with") != 0 || strcmp($9->val_, "layout") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeCreateTable, NULL);
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+    SyntaxNodeAddChildren($$, CreateSyntaxNode(kNodeTableLayout, $11->val_));
+  }
   ;
 
 column_list:
@@ -180,6 +194,25 @@ sql_create_index:
       SyntaxNodeAddChildren(index_type_node, $10);
       SyntaxNodeAddChildren($$, index_type_node);
   }
+  | CREATE UNIQUE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' {
+    $$ = CreateSyntaxNode(kNodeCreateIndex, "unique");
+    SyntaxNodeAddChildren($$, $4);
+    SyntaxNodeAddChildren($$, $6);
+    pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+    SyntaxNodeAddChildren(index_keys_node, $8);
+    SyntaxNodeAddChildren($$, index_keys_node);
+  }
+  | CREATE UNIQUE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' USING IDENTIFIER {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, "unique");
+      SyntaxNodeAddChildren($$, $4);
+      SyntaxNodeAddChildren($$, $6);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $8);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
+      SyntaxNodeAddChildren(index_type_node, $11);
+      SyntaxNodeAddChildren($$, index_type_node);
+  }
   ;
 
 sql_drop_index:
@@ -189,10 +222,18 @@ sql_drop_index:
   }
   ;
 
+/* stats is not a reserved word either, see sql_vacuum */
 sql_show_indexes:
   SHOW INDEXES {
     $$ = CreateSyntaxNode(kNodeShowIndexes, NULL);
   }
+  | SHOW INDEX IDENTIFIER {
+    if (strcmp($3->val_, "stats") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeShowIndexes, "stats");
+  }
   ;
 
 sql_select:
@@ -393,6 +434,26 @@ sql_exec_file:
   }
   ;
 
+/* vacuum is not a reserved word, it is matched as an identifier here */
+sql_vacuum:
+  IDENTIFIER IDENTIFIER {
+    if (strcmp($1->val_, "vacuum") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  | IDENTIFIER INDEX IDENTIFIER {
+    if (strcmp($1->val_, "vacuum") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeVacuum, "index");
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
@@ -45,6 +45,16 @@ class Planner {
 
   Schema *MakeOutputSchema(const std::vector<std::pair<std::string, AbstractExpressionRef>> &exprs);
 
+  // columns compared with = to a constant by the predicate, which only joins comparisons with and
+  static void CollectEqualityColumns(const AbstractExpressionRef &predicate, std::vector<uint32_t> &columns);
+
+  /**
+   * Whether index can answer the predicate: a hash index needs an equality on every key column, an ordered one a
+   * condition on its first key column, or on a later one if the first column has few values to skip-scan over.
+   */
+  static bool IsIndexUsable(IndexInfo *index, const std::vector<uint32_t> &condition_columns,
+                            const std::vector<uint32_t> &equality_columns);
+
   /** Catalog will be used during the planning process. SHOULD ONLY BE USED IN
    * CODE PATH OF `PlanQuery`.
    */
@@ -19,10 +19,13 @@ class Field {
   friend class TypeFloat;
 
  public:
+  // char values up to this length are kept inside the field instead of a separate heap buffer
+  static constexpr uint32_t INLINE_LEN = 16;
+
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
   ~Field() {
-    if (type_id_ == TypeId::kTypeChar && manage_data_) {
+    if (OwnsHeapData()) {
       delete[] value_.chars_;
     }
   }
@@ -50,33 +53,55 @@ class Field {
       value_.chars_ = nullptr;
       manage_data_ = false;
     } else {
+      len_ = len;
       if (manage_data) {
         ASSERT(len < VARCHAR_MAX_LEN, "Field length exceeds max varchar length");
-        value_.chars_ = new char[len];
-        memcpy(value_.chars_, data, len);
+        // 短字符串直接放在Field内部，省掉一次堆分配
+        char *dest = len <= INLINE_LEN ? value_.inline_ : (value_.chars_ = new char[len]);
+        memcpy(dest, data, len);
       } else {
         value_.chars_ = data;
       }
-      len_ = len;
     }
   }
 
-  // copy constructor
-  explicit Field(const Field &other) {
-    type_id_ = other.type_id_;
-    len_ = other.len_;
-    is_null_ = other.is_null_;
-    manage_data_ = other.manage_data_;
-    if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
+  // char stored out of line: only its length and the first overflow page are known until the table heap loads it
+  explicit Field(TypeId type, uint32_t len, page_id_t overflow_page_id)
+      : type_id_(type), len_(len), overflow_page_id_(overflow_page_id) {
+    ASSERT(type == TypeId::kTypeChar, "Invalid type.");
+    value_.chars_ = nullptr;
+  }
+
+  // copy constructor, deep copies owned char data
+  Field(const Field &other)
+      : value_(other.value_),
+        type_id_(other.type_id_),
+        len_(other.len_),
+        is_null_(other.is_null_),
+        manage_data_(other.manage_data_),
+        overflow_page_id_(other.overflow_page_id_) {
+    if (other.OwnsHeapData()) {
       value_.chars_ = new char[len_];
       memcpy(value_.chars_, other.value_.chars_, len_);
-    } else {
-      value_ = other.value_;
     }
   }
 
-  // copy
-  Field &operator=(Field &other) {
+  // move constructor, takes over the heap buffer of other
+  Field(Field &&other) noexcept
+      : value_(other.value_),
+        type_id_(other.type_id_),
+        len_(other.len_),
+        is_null_(other.is_null_),
+        manage_data_(other.manage_data_),
+        overflow_page_id_(other.overflow_page_id_) {
+    if (other.OwnsHeapData()) {
+      other.manage_data_ = false;
+      other.value_.chars_ = nullptr;
+    }
+  }
+
+  // copy and move assignment
+  Field &operator=(Field other) noexcept {
     Swap(*this, other);
     return *this;
   }
@@ -87,14 +112,34 @@ class Field {
 
   inline TypeId GetTypeId() const { return type_id_; }
 
+  /** @return true if the value is still in overflow pages, GetData() is not available before it is loaded */
+  inline bool IsOverflow() const { return overflow_page_id_ != INVALID_PAGE_ID; }
+
+  inline page_id_t GetOverflowPageId() const { return overflow_page_id_; }
+
   inline const char *GetData() const { return Type::GetInstance(type_id_)->GetData(*this); }
 
   inline uint32_t SerializeTo(char *buf) const { return Type::GetInstance(type_id_)->SerializeTo(*this, buf); }
 
   inline static uint32_t DeserializeFrom(char *buf, const TypeId type_id, Field **field, bool is_null) {
+    *field = new Field(type_id);
+    return DeserializeFrom(buf, type_id, *field, is_null);
+  }
+
+  // deserialize into an existing field, the field itself is not allocated
+  inline static uint32_t DeserializeFrom(char *buf, const TypeId type_id, Field *field, bool is_null) {
     return Type::GetInstance(type_id)->DeserializeFrom(buf, field, is_null);
   }
 
+  // order-preserving encoding of a non-null value in width bytes, see Type::SerializeKeyTo
+  inline void SerializeKeyTo(char *buf, uint32_t width) const {
+    Type::GetInstance(type_id_)->SerializeKeyTo(*this, buf, width);
+  }
+
+  inline static void DeserializeKeyFrom(const char *buf, const TypeId type_id, uint32_t width, Field *field) {
+    Type::GetInstance(type_id)->DeserializeKeyFrom(buf, width, field);
+  }
+
   inline uint32_t GetSerializedSize() const { return Type::GetInstance(type_id_)->GetSerializedSize(*this, is_null_); }
 
   inline bool CheckComparable(const Field &o) const { return type_id_ == o.type_id_; }
@@ -127,9 +172,10 @@ class Field {
     std::swap(first.len_, second.len_);
     std::swap(first.is_null_, second.is_null_);
     std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.overflow_page_id_, second.overflow_page_id_);
   }
 
-  std::string toString() {
+  std::string toString() const {
     if (is_null_)
       return "NULL";
     else if (type_id_ == kTypeInt)
@@ -137,23 +183,28 @@ class Field {
     else if (type_id_ == kTypeFloat)
       return std::to_string(value_.float_);
     else {
-      char temp[len_ + 1];
-      memcpy(temp, value_.chars_, len_);
-      temp[len_] = '\0';
-      return {temp};
+      return {CharData(), strnlen(CharData(), len_)};
     }
   }
 
  protected:
+  inline bool OwnsHeapData() const { return type_id_ == TypeId::kTypeChar && manage_data_ && len_ > INLINE_LEN; }
+
+  inline const char *CharData() const {
+    return type_id_ == TypeId::kTypeChar && manage_data_ && len_ <= INLINE_LEN ? value_.inline_ : value_.chars_;
+  }
+
   union Val {
     int32_t integer_;
     float float_;
     char *chars_;
+    char inline_[INLINE_LEN];  // owned char value no longer than INLINE_LEN
   } value_;
   TypeId type_id_;
   uint32_t len_;
   bool is_null_{false};
   bool manage_data_{false};
+  page_id_t overflow_page_id_{INVALID_PAGE_ID};
 };
 
 #endif  // MINISQL_FIELD_H
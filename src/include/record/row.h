@@ -27,23 +27,13 @@ class Row {
    * Row used for insert
    * Field integrity should check by upper level
    */
-  Row(std::vector<Field> &fields) {
-    // deep copy
-    for (auto &field : fields) {
-      fields_.push_back(new Field(field));
-    }
-  }
+  Row(std::vector<Field> &fields) : fields_(fields) {}
 
-  void destroy() {
-    if (!fields_.empty()) {
-      for (auto field : fields_) {
-        delete field;
-      }
-      fields_.clear();
-    }
-  }
+  Row(std::vector<Field> &&fields) : fields_(std::move(fields)) {}
 
-  ~Row() { destroy(); };
+  void destroy() { fields_.clear(); }
+
+  ~Row() = default;
 
   /**
    * Row used for deserialize
@@ -58,25 +48,19 @@ class Row {
   /**
    * Row copy function, deep copy
    */
-  Row(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
-    }
-  }
+  Row(const Row &other) = default;
+
+  /**
+   * Move the fields of other without copying their data
+   */
+  Row(Row &&other) noexcept = default;
 
   /**
    * Assign operator, deep copy
    */
-  Row &operator=(const Row &other) {
-    destroy();
-    rid_ = other.rid_;
-    for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
-    }
-    return *this;
-  }
+  Row &operator=(const Row &other) = default;
+
+  Row &operator=(Row &&other) noexcept = default;
 
   /**
    * Note: Make sure that bytes write to buf is equal to GetSerializedSize()
@@ -94,22 +78,33 @@ class Row {
 
   void GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row);
 
+  /**
+   * Char values must not be longer than the declared length of their column: index keys hold that many bytes.
+   * @return the column of the first char field longer than it, nullptr if every value fits
+   */
+  const Column *GetOverlongColumn(const Schema *schema) const;
+
   inline const RowId GetRowId() const { return rid_; }
 
   inline void SetRowId(RowId rid) { rid_ = rid; }
 
-  inline std::vector<Field *> &GetFields() { return fields_; }
+  inline std::vector<Field> &GetFields() { return fields_; }
+
+  inline const Field *GetField(uint32_t idx) const {
+    ASSERT(idx < fields_.size(), "Failed to access field");
+    return &fields_[idx];
+  }
 
-  inline Field *GetField(uint32_t idx) const {
+  inline Field *GetField(uint32_t idx) {
     ASSERT(idx < fields_.size(), "Failed to access field");
-    return fields_[idx];
+    return &fields_[idx];
   }
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
  private:
   RowId rid_{};
-  std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  std::vector<Field> fields_; /** Fields are stored by value, contiguously */
 };
 
 #endif  // MINISQL_ROW_H
@@ -44,11 +44,17 @@ class Type {
   virtual uint32_t SerializeTo(const Field &field, char *buf) const;
 
   // Deserialize a field of the given type from the given storage space.
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const;
+  virtual uint32_t DeserializeFrom(char *storage, Field *field, bool is_null) const;
 
   // Get serialize size of a field
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const;
 
+  // Serialize a non-null field into width bytes whose memcmp order is the order of the values (index keys).
+  virtual void SerializeKeyTo(const Field &field, char *buf, uint32_t width) const;
+
+  // Deserialize a non-null field from the width bytes written by SerializeKeyTo.
+  virtual void DeserializeKeyFrom(const char *storage, uint32_t width, Field *field) const;
+
   // Access the raw variable length data
   virtual const char *GetData(const Field &val) const;
 
@@ -78,10 +84,14 @@ class TypeInt : public Type {
 
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const override;
+  virtual uint32_t DeserializeFrom(char *storage, Field *field, bool is_null) const override;
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
+  virtual void SerializeKeyTo(const Field &field, char *buf, uint32_t width) const override;
+
+  virtual void DeserializeKeyFrom(const char *storage, uint32_t width, Field *field) const override;
+
   virtual CmpBool CompareEquals(const Field &left, const Field &right) const override;
 
   virtual CmpBool CompareNotEquals(const Field &left, const Field &right) const override;
@@ -101,10 +111,14 @@ class TypeChar : public Type {
 
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const override;
+  virtual uint32_t DeserializeFrom(char *storage, Field *field, bool is_null) const override;
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
+  virtual void SerializeKeyTo(const Field &field, char *buf, uint32_t width) const override;
+
+  virtual void DeserializeKeyFrom(const char *storage, uint32_t width, Field *field) const override;
+
   virtual const char *GetData(const Field &val) const override;
 
   virtual uint32_t GetLength(const Field &val) const override;
@@ -128,10 +142,14 @@ class TypeFloat : public Type {
 
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const override;
+  virtual uint32_t DeserializeFrom(char *storage, Field *field, bool is_null) const override;
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
+  virtual void SerializeKeyTo(const Field &field, char *buf, uint32_t width) const override;
+
+  virtual void DeserializeKeyFrom(const char *storage, uint32_t width, Field *field) const override;
+
   virtual CmpBool CompareEquals(const Field &left, const Field &right) const override;
 
   virtual CmpBool CompareNotEquals(const Field &left, const Field &right) const override;
@@ -1,31 +1,45 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
 #include "page/header_page.h"
+#include "page/overflow_page.h"
+#include "page/pax_page.h"
 #include "page/table_page.h"
 #include "recovery/log_manager.h"
 #include "storage/table_iterator.h"
 
+/**
+ * Page layout of a table heap: row-oriented slotted pages (TablePage) or column-grouped PAX pages (PaxPage).
+ */
+enum class TableLayout : uint32_t { kRow = 0, kPax };
+
 class TableHeap {
   friend class TableIterator;
 
  public:
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                           LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+                           LockManager *lock_manager, TableLayout layout = TableLayout::kRow) {
+    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, layout);
   }
 
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager, TableLayout layout = TableLayout::kRow) {
+    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, layout);
   }
 
   ~TableHeap() {}
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * In a row layout table char values longer than OVERFLOW_THRESHOLD are written to overflow pages first and the
+   * tuple keeps a reference to them. Values of row still held in overflow pages are stored by reference, the new
+   * tuple takes those pages over.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The recovery performing the insert
    * @return true iff the insert is successful
@@ -42,6 +56,9 @@ class TableHeap {
 
   /**
    * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * Long char values are moved to overflow pages as in InsertTuple, values of row still held as references are
+   * copied first so that two versions never share overflow pages. The overflow pages of the old tuple are
+   * released when it is updated in place.
    * @param[in] row Tuple of new row
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Txn performing the update
@@ -67,9 +84,17 @@ class TableHeap {
    * Read a tuple from the table.
    * @param[in/out] row Output variable for the tuple, row id of the tuple is wrapped in row
    * @param[in] txn recovery performing the read
+   * @param[in] load_overflow false to leave the values kept in overflow pages as references, see LoadOverflowFields
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(Row *row, Txn *txn);
+  bool GetTuple(Row *row, Txn *txn, bool load_overflow = true);
+
+  /**
+   * Replace the overflow references of row by the values they point to.
+   * @param[in/out] row Row read with load_overflow set to false
+   * @param[in] columns Columns to load, all of them when nullptr
+   */
+  void LoadOverflowFields(Row *row, const std::vector<uint32_t> *columns = nullptr);
 
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
@@ -77,6 +102,9 @@ class TableHeap {
       auto old_page_id = next_page_id;
       auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
       assert(page != nullptr);
+      if (layout_ == TableLayout::kRow) {
+        FreePageOverflow(page);
+      }
       next_page_id = page->GetNextPageId();
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
@@ -88,10 +116,38 @@ class TableHeap {
    */
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
+  /**
+   * Reclaim the space held by deleted tuples. Every page is compacted, a page is merged into its predecessor
+   * when all of its live tuples fit there, and the pages left empty are unlinked and deallocated. The first
+   * page is never released, so the root page id kept in the catalog stays valid.
+   * @param[in] txn Txn performing the vacuum
+   * @param[out] moved_rows (old rid, new rid) of every row that was relocated, used to fix up the indexes
+   * @return number of pages released
+   */
+  uint32_t Vacuum(Txn *txn, std::vector<std::pair<RowId, RowId>> *moved_rows);
+
+  /**
+   * @return number of tuples marked deleted since the last vacuum of this heap
+   */
+  inline uint32_t GetDeadTupleCount() const { return dead_tuple_count_; }
+
+  /**
+   * Scan one page of a PAX table column by column. Only the columns in filter_columns are read to evaluate the
+   * filter, full rows are assembled for the qualifying tuples only.
+   * @param[in] page_id Page to scan
+   * @param[in] filter_columns Columns the filter reads, the other fields of the rows it sees are null
+   * @param[in] filter Returns true for the rows to keep, nullptr keeps all rows
+   * @param[out] rows Qualifying rows, with their RowIds
+   * @return id of the next page, INVALID_PAGE_ID at the end of the table
+   */
+  page_id_t ScanPaxPage(page_id_t page_id, const std::vector<uint32_t> &filter_columns,
+                        const std::function<bool(const Row &)> &filter, std::vector<Row> *rows, Txn *txn);
+
   /**
    * @return the begin iterator of this table
+   * @param[in] load_overflow false to iterate over rows whose overflow values are left as references
    */
-  TableIterator Begin(Txn *txn);
+  TableIterator Begin(Txn *txn, bool load_overflow = true);
 
   /**
    * @return the end iterator of this table
@@ -103,14 +159,102 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  inline TableLayout GetLayout() const { return layout_; }
+
+ private:
+  /**
+   * Every operation touching tuples is written once against the page interface shared by TablePage and
+   * PaxPage, the public methods pick the instantiation matching layout_.
+   */
+  template <typename PageType>
+  bool InsertTupleImpl(Row &row, Txn *txn);
+
+  template <typename PageType>
+  bool MarkDeleteImpl(const RowId &rid, Txn *txn);
+
+  template <typename PageType>
+  bool UpdateTupleImpl(Row &row, const RowId &rid, Txn *txn);
+
+  template <typename PageType>
+  void ApplyDeleteImpl(const RowId &rid, Txn *txn);
+
+  template <typename PageType>
+  void RollbackDeleteImpl(const RowId &rid, Txn *txn);
+
+  template <typename PageType>
+  bool GetTupleImpl(Row *row, Txn *txn);
+
+  template <typename PageType>
+  uint32_t VacuumImpl(Txn *txn, std::vector<std::pair<RowId, RowId>> *moved_rows);
+
+  template <typename PageType>
+  RowId GetFirstTupleRidImpl(page_id_t page_id);
+
+  template <typename PageType>
+  RowId GetNextTupleRidImpl(const RowId &rid);
+
+  /**
+   * @return rid of the first tuple at or after page page_id, INVALID_ROWID if there is none
+   */
+  RowId GetFirstTupleRid(page_id_t page_id);
+
+  /**
+   * @return rid of the tuple following rid in the table, INVALID_ROWID if there is none
+   */
+  RowId GetNextTupleRid(const RowId &rid);
+
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Txn *txn) {
+    page->Init(page_id, prev_id, log_manager_, txn);
+  }
+
+  void InitPage(PaxPage *page, page_id_t page_id, page_id_t prev_id, Txn *txn) {
+    page->Init(page_id, prev_id, schema_, log_manager_, txn);
+  }
+
+  /**
+   * Write data to a new chain of overflow pages.
+   * @return id of the first page, INVALID_PAGE_ID if the buffer pool is out of pages
+   */
+  page_id_t WriteOverflow(const char *data, uint32_t len);
+
+  /**
+   * Read len bytes from the chain of overflow pages starting at page_id into buf.
+   */
+  void ReadOverflow(page_id_t page_id, char *buf, uint32_t len);
+
+  /**
+   * Deallocate the chain of overflow pages starting at page_id.
+   */
+  void FreeOverflow(page_id_t page_id);
+
+  /**
+   * Copy row into stored_row, moving every char value longer than OVERFLOW_THRESHOLD to new overflow pages.
+   * @return false if row has no such value, stored_row is left untouched and row can be stored as it is
+   */
+  bool MoveOverflowFields(const Row &row, Row *stored_row);
+
+  /**
+   * Deallocate the overflow pages referenced by row, except the ones still referenced by keep.
+   */
+  void FreeOverflowFields(const Row &row, const Row *keep = nullptr);
+
+  /**
+   * Release the overflow pages of the tuples of page: only the deleted ones, or all of them with include_live.
+   * Overflow pages only back row layout tables, PAX values are always stored inline.
+   */
+  void FreePageOverflow(TablePage *page, bool include_live = true);
+
+  void FreePageOverflow(PaxPage *, bool = true) {}
+
  private:
   /**
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                     LockManager *lock_manager)
+                     LockManager *lock_manager, TableLayout layout)
       : buffer_pool_manager_(buffer_pool_manager),
         schema_(schema),
+        layout_(layout),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {
     page_id_t new_page_id;
@@ -119,18 +263,21 @@ class TableHeap {
 
     first_page_id_ = new_page_id;
 
-    auto table_page = reinterpret_cast<TablePage *>(raw_page);
-
-    table_page->Init(new_page_id, INVALID_PAGE_ID, log_manager_, txn);
+    if (layout_ == TableLayout::kPax) {
+      InitPage(reinterpret_cast<PaxPage *>(raw_page), new_page_id, INVALID_PAGE_ID, txn);
+    } else {
+      InitPage(reinterpret_cast<TablePage *>(raw_page), new_page_id, INVALID_PAGE_ID, txn);
+    }
 
     buffer_pool_manager_->UnpinPage(new_page_id, /*is_dirty=*/true);
   };
 
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
+        layout_(layout),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {}
 
@@ -138,6 +285,8 @@ class TableHeap {
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
   Schema *schema_;
+  TableLayout layout_;
+  uint32_t dead_tuple_count_{0};
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
 };
@@ -10,7 +10,8 @@ class TableHeap;
 class TableIterator {
 public:
  // you may define your own constructor based on your member variables
- explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn);
+ // load_overflow: false to leave char values kept in overflow pages as references, see TableHeap::GetTuple
+ explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, bool load_overflow = true);
  
  // 实现方便把这个的explicit删掉了，如果有问题再说 [by zat]
  TableIterator(const TableIterator &other);
@@ -37,6 +38,7 @@ private:
   Txn       *txn_;
   Row       current_row_;
   RowId     current_rid_;
+  bool      load_overflow_{true};
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
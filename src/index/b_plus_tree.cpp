@@ -1,5 +1,6 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
 #include <string>
 
 #include "glog/logging.h"
@@ -11,18 +12,20 @@
  * TODO: Student Implement
  */
 BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
-                     int leaf_max_size, int internal_max_size)
+                     int leaf_max_size, int internal_max_size, double merge_threshold)
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {
+      internal_max_size_(internal_max_size),
+      merge_threshold_(merge_threshold) {
   // NOTE: size == leaf_max_size_ or internal_max_size_ means overflow, not >
+  // keys are compressed, so the default max size only caps the slot count: pages usually fill up by bytes first
   if (leaf_max_size_ == UNDEFINED_SIZE || internal_max_size_ == UNDEFINED_SIZE) {
-    leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(RowId));
+    leaf_max_size_ = BPlusTreePage::DATA_SIZE / (BPlusTreePage::SLOT_SIZE + sizeof(RowId));
   }
   if (internal_max_size_ == UNDEFINED_SIZE) {
-    internal_max_size_ = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(page_id_t));
+    internal_max_size_ = BPlusTreePage::DATA_SIZE / (BPlusTreePage::SLOT_SIZE + sizeof(page_id_t));
   }
   auto page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
   if (!page->GetRootId(index_id_, &root_page_id_)) {
@@ -37,6 +40,7 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
     auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
     auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
     index_roots_page->Delete(index_id_);
+    rightmost_leaf_id_ = INVALID_PAGE_ID;
   }
 
   Page *page = buffer_pool_manager_->FetchPage(current_page_id);
@@ -71,24 +75,159 @@ bool BPlusTree::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn *transaction) {
-  if (IsEmpty()) return false;
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) return false;  // empty tree
 
-  auto *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_));
-  if (leaf_page == nullptr) {
-    LOG(ERROR) << "Leaf page not found";
-    return false;  // Leaf page not found
-  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
   RowId value;
-
   // Check if the key exists in the leaf page
-  if (!leaf_page->Lookup(key, value, processor_)) {
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);  // Unpin the leaf page without dirty flag
-    return false;                                                    // Key not found
-  } else {
-    result.push_back(value);                                         // Add the found value to the result vector
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);  // Unpin the leaf page without dirty flag
-    return true;                                                     // Key found and value added to result
+  bool found = leaf_page->Lookup(key, value, processor_);
+  if (found) {
+    result.push_back(value);  // Add the found value to the result vector
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);  // Unpin the leaf page without dirty flag
+  return found;
+}
+
+/*
+ * A range is read from the leaf of its lower key on, the leaf of the previous range if it is still the one. A range
+ * that runs past the upper fence of its leaf goes on from the next leaf, found again from the root by that fence:
+ * latching the next leaf straight away could deadlock with a merge latching its left sibling.
+ */
+void BPlusTree::GetValues(const std::vector<std::pair<const GenericKey *, const GenericKey *>> &ranges,
+                          std::vector<std::vector<RowId>> &result, Txn *transaction) {
+  result.assign(ranges.size(), {});
+  int key_size = processor_.GetKeySize();
+  std::vector<char> keys(key_size * 2);
+  auto *from = reinterpret_cast<GenericKey *>(keys.data());
+  auto *key = reinterpret_cast<GenericKey *>(keys.data() + key_size);
+  LeafCursor cursor;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    const GenericKey *lower = ranges[i].first;
+    const GenericKey *upper = ranges[i].second;
+    memcpy(from, lower, key_size);
+    while (true) {
+      if (!CursorCovers(cursor, from)) {
+        MoveCursor(cursor, nullptr);
+        MoveCursor(cursor, FindLeafPage(from));
+        if (cursor.page_ == nullptr) return;  // empty tree
+      }
+      auto *leaf = reinterpret_cast<LeafPage *>(cursor.page_->GetData());
+      bool past_upper = false;
+      for (int index = leaf->KeyIndex(lower, processor_); index < leaf->GetSize(); index++) {
+        leaf->KeyAt(index, key);
+        if (processor_.CompareKeys(key, upper) > 0) {
+          past_upper = true;
+          break;
+        }
+        result[i].push_back(leaf->ValueAt(index));
+      }
+      if (past_upper || !cursor.has_upper_ ||
+          processor_.CompareKeys(reinterpret_cast<GenericKey *>(cursor.upper_.data()), upper) > 0) {
+        break;
+      }
+      memcpy(from, cursor.upper_.data(), key_size);
+    }
+  }
+  MoveCursor(cursor, nullptr);
+}
+
+/*****************************************************************************
+ * LATCH CRABBING
+ *****************************************************************************/
+/*
+ * Insert never splits a node that does not overflow after one more entry of any key, remove never touches the
+ * ancestors of a node that does not underflow after losing one, see BPlusTreePage::IsUnderflow. A leaf root only goes
+ * away once empty, an internal root once it has a single child left.
+ */
+bool BPlusTree::IsSafe(BPlusTreePage *node, Operation op) const {
+  int max_entry_size = node->GetMaxEntrySize();
+  if (op == Operation::kInsert) {
+    return node->GetSize() + 1 < node->GetMaxSize() && node->GetFreeSpace() >= 2 * max_entry_size;
+  }
+  if (node->IsRootPage()) {
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  }
+  if (node->GetSize() - 1 < (node->IsLeafPage() ? 1 : 2)) {
+    return false;
+  }
+  return node->GetSize() - 1 >= node->GetMinSize() ||
+         node->GetUsedSpace() - max_entry_size >= BPlusTreePage::DATA_SIZE * merge_threshold_;
+}
+
+Page *BPlusTree::FindLeafPageForWrite(const GenericKey *key, Operation op, LatchContext &context) {
+  root_latch_.WLock();
+  context.root_latched_ = true;
+  if (IsEmpty()) return nullptr;
+
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    // the ancestors are out of reach of this operation once the node absorbs it
+    if (IsSafe(node, op)) {
+      ReleaseLatches(context, false);
+    }
+    context.pages_.push_back(page);
+    if (node->IsLeafPage()) return page;
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, processor_);
+  }
+}
+
+void BPlusTree::ReleaseLatches(LatchContext &context, bool is_dirty) {
+  // forget an emptied rightmost leaf while it is still latched, before an append can reach it
+  for (auto page_id : context.deleted_pages_) {
+    page_id_t expected = page_id;
+    rightmost_leaf_id_.compare_exchange_strong(expected, INVALID_PAGE_ID);
+  }
+  if (context.root_latched_) {
+    root_latch_.WUnlock();
+    context.root_latched_ = false;
   }
+  for (auto page : context.pages_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  context.pages_.clear();
+  // emptied pages are unreachable from the tree and no longer pinned by this operation
+  for (auto page_id : context.deleted_pages_) {
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      LOG(WARNING) << "Failed to delete b+ tree page " << page_id;
+    }
+  }
+  context.deleted_pages_.clear();
+}
+
+void BPlusTree::MoveCursor(LeafCursor &cursor, Page *page) {
+  if (cursor.page_ != nullptr) {
+    if (cursor.exclusive_) {
+      cursor.page_->WUnlatch();
+    } else {
+      cursor.page_->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(cursor.page_->GetPageId(), cursor.dirty_);
+  }
+  cursor.page_ = page;
+  cursor.dirty_ = false;
+  if (page == nullptr) return;
+  // the fences do not change as long as the leaf is latched
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  cursor.lower_.resize(processor_.GetKeySize());
+  cursor.upper_.resize(processor_.GetKeySize());
+  leaf->GetLowerFence(reinterpret_cast<GenericKey *>(cursor.lower_.data()));
+  cursor.has_upper_ = leaf->HasUpperFence();
+  if (cursor.has_upper_) {
+    leaf->GetUpperFence(reinterpret_cast<GenericKey *>(cursor.upper_.data()));
+  }
+}
+
+bool BPlusTree::CursorCovers(const LeafCursor &cursor, const GenericKey *key) const {
+  if (cursor.page_ == nullptr) return false;
+  auto *lower = reinterpret_cast<const GenericKey *>(cursor.lower_.data());
+  auto *upper = reinterpret_cast<const GenericKey *>(cursor.upper_.data());
+  return processor_.CompareKeys(lower, key) <= 0 && (!cursor.has_upper_ || processor_.CompareKeys(key, upper) < 0);
 }
 
 /*****************************************************************************
@@ -102,13 +241,80 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Txn
  * keys return false, otherwise return true.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
-  if (IsEmpty()) {
+  // Optimistic: only the leaf is write latched, enough as long as it does not split. An append to the rightmost
+  // leaf does not even look it up
+  Page *page = FindRightmostLeafForAppend(key);
+  if (page == nullptr) {
+    page = FindLeafPage(key, false, true);
+  }
+  if (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    RowId tmp_value;
+    bool exists = leaf_page->Lookup(key, tmp_value, processor_);
+    bool done = exists || IsSafe(leaf_page, Operation::kInsert);
+    if (!exists && done) {
+      leaf_page->Insert(key, value, processor_);
+      if (!leaf_page->HasUpperFence()) {
+        rightmost_leaf_id_ = page->GetPageId();
+      }
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), done && !exists);
+    if (done) return !exists;
+  }
+
+  // Pessimistic: write latch from the root, the leaf may split up to the root
+  LatchContext context;
+  Page *leaf = FindLeafPageForWrite(key, Operation::kInsert, context);
+  bool inserted = true;
+  if (leaf == nullptr) {
     StartNewTree(key, value);
-    return true;
   } else {
-    return InsertIntoLeaf(key, value, transaction);
+    inserted = InsertIntoLeaf(key, value, reinterpret_cast<LeafPage *>(leaf->GetData()));
   }
+  ReleaseLatches(context, true);
+  return inserted;
 }
+
+/*
+ * The optimistic path of Insert, with the leaf kept write latched for the keys after it. An append past the end of
+ * the tree starts at the rightmost leaf, the keys after it are appends as well.
+ */
+void BPlusTree::InsertBatch(const std::vector<GenericKey *> &keys, const std::vector<RowId> &values,
+                            std::vector<bool> &inserted, Txn *transaction) {
+  inserted.assign(keys.size(), false);
+  LeafCursor cursor;
+  cursor.exclusive_ = true;
+  for (size_t i = 0; i < keys.size(); i++) {
+    GenericKey *key = keys[i];
+    if (!CursorCovers(cursor, key)) {
+      MoveCursor(cursor, nullptr);
+      Page *page = FindRightmostLeafForAppend(key);
+      MoveCursor(cursor, page != nullptr ? page : FindLeafPage(key, false, true));
+    }
+    if (cursor.page_ != nullptr) {
+      auto *leaf_page = reinterpret_cast<LeafPage *>(cursor.page_->GetData());
+      RowId tmp_value;
+      if (leaf_page->Lookup(key, tmp_value, processor_)) {
+        continue;
+      }
+      if (IsSafe(leaf_page, Operation::kInsert)) {
+        leaf_page->Insert(key, values[i], processor_);
+        cursor.dirty_ = true;
+        if (!leaf_page->HasUpperFence()) {
+          rightmost_leaf_id_ = cursor.page_->GetPageId();
+        }
+        inserted[i] = true;
+        continue;
+      }
+    }
+    // the leaf splits, or the tree is empty
+    MoveCursor(cursor, nullptr);
+    inserted[i] = Insert(key, values[i], transaction);
+  }
+  MoveCursor(cursor, nullptr);
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -126,57 +332,332 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   leaf_page->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
 
   leaf_page->Insert(key, value, processor_);
+  rightmost_leaf_id_ = root_page_id_;
 
   buffer_pool_manager_->UnpinPage(root_page_id_, true);  // Unpin the page after insertion
 }
 
+/*
+ * The remembered page is checked once latched: it may have been split, merged away or even deleted meanwhile, but
+ * it is still the rightmost leaf of this tree as long as rightmost_leaf_id_ names it, since that only changes under
+ * the latch of the page. Every key past the last one of the rightmost leaf belongs to it, it has no upper fence.
+ */
+Page *BPlusTree::FindRightmostLeafForAppend(const GenericKey *key) {
+  page_id_t page_id = rightmost_leaf_id_;
+  if (page_id == INVALID_PAGE_ID) return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) return nullptr;
+  page->WLatch();
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (rightmost_leaf_id_ == page_id && leaf_page->GetSize() > 0 &&
+      leaf_page->KeyIndex(key, processor_) == leaf_page->GetSize()) {
+    return page;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return nullptr;
+}
+
+/*
+ * Build the leaves left to right straight from next, keeping the previous leaf pinned to link it to the new one.
+ * Entries are read ahead into pending so that a leaf can pick where it ends by its encoded size: each leaf takes the
+ * next run of pending, and its upper fence, a separator truncated against the entry after the run, is the lower
+ * fence of the next leaf. The lower fence and page id of every node are collected to build the level above, until
+ * a level has a single node which becomes the root.
+ */
+bool BPlusTree::BuildTree(uint64_t count, const std::function<bool(GenericKey *, RowId *)> &next,
+                          double fill_factor, page_id_t *root, page_id_t *rightmost_leaf) {
+  int key_size = processor_.GetKeySize();
+  std::vector<page_id_t> built_pages;  // deleted again if the load fails
+  BPlusTreePage::EntryList pending(key_size, sizeof(RowId));
+  BPlusTreePage::EntryList level(key_size, sizeof(page_id_t));  // lower fence and page id of every built node
+  std::vector<char> keys(key_size * 4, 0);
+  auto *key = reinterpret_cast<GenericKey *>(keys.data());
+  auto *last_key = reinterpret_cast<GenericKey *>(keys.data() + key_size);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data() + key_size * 2);  // zeros: below every key
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + key_size * 3);
+  uint64_t read = 0;
+  bool ok = true;
+
+  LeafPage *prev_leaf = nullptr;
+  while (ok) {
+    while (read < count && pending.GetCount() < 2 * leaf_max_size_) {
+      RowId value;
+      ok = next(key, &value);
+      // strictly increasing
+      ok = ok && (read == 0 || processor_.CompareKeys(last_key, key) < 0);
+      if (!ok) break;
+      pending.Append(key, &value);
+      memcpy(last_key, key, key_size);
+      read++;
+    }
+    if (!ok || pending.GetCount() == 0) break;
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(page_id);
+    if (page == nullptr) throw("Out of memory: Unable to allocate new leaf page.");
+    built_pages.push_back(page_id);
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, key_size, leaf_max_size_);
+    int size = leaf->BuildFrom(pending, 0, read == count, lower, fill_factor, upper);
+    level.Append(lower, &page_id);
+    if (prev_leaf != nullptr) {
+      prev_leaf->SetNextPageId(page_id);
+      leaf->SetPrevPageId(prev_leaf->GetPageId());
+      buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+    }
+    prev_leaf = leaf;
+    pending.EraseFront(size);
+    memcpy(lower, upper, key_size);
+  }
+  if (prev_leaf != nullptr) {
+    *rightmost_leaf = prev_leaf->GetPageId();
+    buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+  }
+  if (!ok) {
+    for (auto page_id : built_pages) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    return false;
+  }
+
+  while (level.GetCount() > 1) {
+    BPlusTreePage::EntryList parent_level(key_size, sizeof(page_id_t));
+    for (int begin = 0; begin < level.GetCount();) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(page_id);
+      if (page == nullptr) throw("Out of memory: Unable to allocate new internal page.");
+      auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+      node->Init(page_id, INVALID_PAGE_ID, key_size, internal_max_size_);
+      // the lower fence of the first child is the lower fence of the node
+      begin += node->BuildFrom(level, begin, true, level.KeyAt(begin), fill_factor, upper);
+      node->Adopt(0, node->GetSize(), buffer_pool_manager_);
+      parent_level.Append(level.KeyAt(begin - node->GetSize()), &page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    level = std::move(parent_level);
+  }
+  *root = *reinterpret_cast<const page_id_t *>(level.ValueAt(0));
+  return true;
+}
+
+bool BPlusTree::BulkLoad(uint64_t count, const std::function<bool(GenericKey *, RowId *)> &next,
+                         double fill_factor) {
+  root_latch_.WLock();
+  if (!IsEmpty() || count == 0) {
+    bool empty = IsEmpty();
+    root_latch_.WUnlock();
+    return empty;
+  }
+  page_id_t root;
+  page_id_t rightmost_leaf;
+  bool built = BuildTree(count, next, fill_factor, &root, &rightmost_leaf);
+  if (built) {
+    root_page_id_ = root;
+    UpdateRootPageId(1);
+    rightmost_leaf_id_ = rightmost_leaf;
+  }
+  root_latch_.WUnlock();
+  return built;
+}
+
+/*
+ * The new tree is bulk loaded off to the side from the leaf chain of the old one, then swapped in as the root and the
+ * old one deleted. root_latch_ is held throughout: it keeps out every operation that starts from the root, those
+ * already below it are waited out by latching the whole tree top-down, and appends to the rightmost leaf stop once it
+ * is forgotten under its latch.
+ */
+int BPlusTree::Vacuum(double fill_factor) {
+  root_latch_.WLock();
+  page_id_t old_root = root_page_id_;
+  if (old_root == INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    return 0;
+  }
+  uint64_t count = LatchSubtree(old_root);
+  // Find the leftmost leaf, no one else reaches the old tree any more
+  page_id_t first_leaf = old_root;
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(first_leaf)->GetData());
+    page_id_t child = node->IsLeafPage() ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+    buffer_pool_manager_->UnpinPage(first_leaf, false);
+    if (child == INVALID_PAGE_ID) break;
+    first_leaf = child;
+  }
+
+  page_id_t next_leaf = first_leaf;
+  LeafPage *leaf = nullptr;
+  int index = 0;
+  auto next = [&](GenericKey *key, RowId *value) {
+    while (leaf == nullptr || index == leaf->GetSize()) {
+      if (leaf != nullptr) {
+        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+        leaf = nullptr;
+      }
+      if (next_leaf == INVALID_PAGE_ID) return false;
+      leaf = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(next_leaf)->GetData());
+      next_leaf = leaf->GetNextPageId();
+      index = 0;
+    }
+    leaf->KeyAt(index, key);
+    *value = leaf->ValueAt(index++);
+    return true;
+  };
+  page_id_t new_root = INVALID_PAGE_ID;
+  page_id_t rightmost_leaf = INVALID_PAGE_ID;
+  bool built = count == 0 || BuildTree(count, next, fill_factor, &new_root, &rightmost_leaf);
+  if (leaf != nullptr) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  }
+  if (!built) {
+    // the old tree is left as it was, appends find its rightmost leaf from the root again
+    LOG(ERROR) << "Failed to vacuum index " << index_id_;
+    root_latch_.WUnlock();
+    return 0;
+  }
+  int new_pages = CountPages(new_root);
+  root_page_id_ = new_root;
+  UpdateRootPageId();
+  rightmost_leaf_id_ = rightmost_leaf;
+  root_latch_.WUnlock();
+  int released = CountPages(old_root) - new_pages;
+  Destroy(old_root);
+  return released;
+}
+
+uint64_t BPlusTree::LatchSubtree(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  page->WLatch();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  uint64_t count = 0;
+  if (node->IsLeafPage()) {
+    count = node->GetSize();
+    page_id_t expected = page_id;
+    rightmost_leaf_id_.compare_exchange_strong(expected, INVALID_PAGE_ID);
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      count += LatchSubtree(internal->ValueAt(i));
+    }
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return count;
+}
+
+int BPlusTree::CountPages(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return 0;
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  int count = 1;
+  if (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      count += CountPages(internal->ValueAt(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return count;
+}
+
+IndexStats BPlusTree::GetStats() {
+  IndexStats stats;
+  uint64_t leaf_used = 0;
+  uint64_t internal_used = 0;
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+  } else {
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+    page->RLatch();
+    root_latch_.RUnlock();
+    CollectStats(page, 1, &stats, &leaf_used, &internal_used);
+  }
+  if (stats.leaf_pages_ > 0) {
+    stats.leaf_fill_factor_ = static_cast<double>(leaf_used) / (stats.leaf_pages_ * BPlusTreePage::DATA_SIZE);
+  }
+  if (stats.internal_pages_ > 0) {
+    stats.internal_fill_factor_ =
+        static_cast<double>(internal_used) / (stats.internal_pages_ * BPlusTreePage::DATA_SIZE);
+  }
+  stats.splits_ = splits_;
+  stats.merges_ = merges_;
+  return stats;
+}
+
+void BPlusTree::CollectStats(Page *page, uint32_t depth, IndexStats *stats, uint64_t *leaf_used,
+                             uint64_t *internal_used) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    stats->leaf_pages_++;
+    stats->entries_ += node->GetSize();
+    *leaf_used += node->GetUsedSpace();
+    stats->height_ = std::max(stats->height_, depth);
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    stats->internal_pages_++;
+    *internal_used += internal->GetUsedSpace();
+    // 本页锁到子树读完为止，合并没法在遍历途中释放下面的页
+    for (int i = 0; i < internal->GetSize(); i++) {
+      Page *child = buffer_pool_manager_->FetchPage(internal->ValueAt(i));
+      if (child == nullptr) {
+        LOG(ERROR) << "Page with ID " << internal->ValueAt(i) << " not found in buffer pool.";
+        continue;
+      }
+      child->RLatch();
+      CollectStats(child, depth + 1, stats, leaf_used, internal_used);
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
 /*
  * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
+ * The leaf page and every ancestor a split can reach are write latched by the caller. Look through leaf page to
+ * see whether insert key exist or not. If exist, return immediately, otherwise insert entry. Remember to deal with
+ * split if necessary.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transaction) {
-  // Find the right leaf page for insertion
-  auto *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, root_page_id_));
-  if (leaf_page == nullptr) {
-    LOG(ERROR) << "Leaf page not found";
-    return false;  // Leaf page not found
-  }
-
+bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, LeafPage *leaf_page) {
   // Check if the key already exists in the leaf page
   RowId tmp_value;
   if (leaf_page->Lookup(key, tmp_value, processor_)) {
-    LOG(ERROR) << "Key already exists in the leaf page: " << key;
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);  // Unpin the leaf page without dirty flag
-    return false;                                                    // Key already exists, do not insert
-  } else {
-    // Insert entry and check if it exceeds the maximum size
-    int size = leaf_page->Insert(key, value, processor_);
-    if (size >= leaf_max_size_) {
-      // Split the leaf page if it exceeds the maximum size
-      auto *new_leaf_page = Split(leaf_page, transaction);
-      if (new_leaf_page == nullptr) {
-        throw("Out of memory: Unable to split leaf page.");
-      }
-      // Insert the new page into the parent
-      InsertIntoParent(leaf_page, new_leaf_page->KeyAt(0), new_leaf_page, transaction);
+    return false;  // Key already exists, do not insert
+  }
+  // Insert entry and check if it overflows, by entries or by bytes
+  leaf_page->Insert(key, value, processor_);
+  if (leaf_page->IsOverflow()) {
+    // Split the leaf page if it exceeds the maximum size
+    bool at_right_edge =
+        !leaf_page->HasUpperFence() && leaf_page->KeyIndex(key, processor_) == leaf_page->GetSize() - 1;
+    auto *new_leaf_page = Split(leaf_page, at_right_edge);
+    // Insert the new page into the parent, keyed by the truncated separator both pages are fenced by
+    std::vector<char> separator(processor_.GetKeySize());
+    new_leaf_page->GetLowerFence(reinterpret_cast<GenericKey *>(separator.data()));
+    InsertIntoParent(leaf_page, reinterpret_cast<GenericKey *>(separator.data()), new_leaf_page);
+    // remembered once linked into the parent, appends go straight to it from then on
+    if (!new_leaf_page->HasUpperFence()) {
+      rightmost_leaf_id_ = new_leaf_page->GetPageId();
     }
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);  // Unpin the leaf page after insertion
-    return true;                                                    // Insertion successful
+    buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
+  } else if (!leaf_page->HasUpperFence()) {
+    rightmost_leaf_id_ = leaf_page->GetPageId();
   }
+  return true;  // Insertion successful
 }
 
 /*
  * Split input page and return newly created page.
- * Using template N to represent either internal page or leaf page.
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * NOTE: the new page is returned pinned, unpin it once it is linked into the parent
+ * A node overflowed by an append at the right edge of its level keeps INDEX_FILL_FACTOR of its bytes instead of
+ * half: the keys keep coming after its last one, an even split would leave half empty pages behind.
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
+BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, bool at_right_edge) {
   // Allocate a new internal page
   page_id_t page_id;
   auto *new_page = buffer_pool_manager_->NewPage(page_id);
@@ -185,17 +666,19 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
   auto *recipient = reinterpret_cast<InternalPage *>(new_page->GetData());
   recipient->Init(page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
 
+  splits_++;
   // Move half of the entries from the old node to the new node
-  node->MoveHalfTo(recipient, buffer_pool_manager_);
+  if (at_right_edge) {
+    node->MoveTailTo(recipient, buffer_pool_manager_, INDEX_FILL_FACTOR);
+  } else {
+    node->MoveHalfTo(recipient, buffer_pool_manager_);
+  }
   // Update the parent page ID of the recipient
   recipient->SetParentPageId(node->GetParentPageId());
-  // Unpin the recipient page after moving entries
-  buffer_pool_manager_->UnpinPage(page_id, true);
-
   return recipient;
 }
 
-BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
+BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, bool at_right_edge) {
   // Allocate a new leaf page
   page_id_t page_id;
   auto *new_page = buffer_pool_manager_->NewPage(page_id);
@@ -204,17 +687,32 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
   auto *recipient = reinterpret_cast<LeafPage *>(new_page->GetData());
   recipient->Init(page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
 
+  splits_++;
   // Move half of the entries from the old node to the new node
-  node->MoveHalfTo(recipient);
-  // Update the next page ID of the new node
+  if (at_right_edge) {
+    node->MoveTailTo(recipient, INDEX_FILL_FACTOR);
+  } else {
+    node->MoveHalfTo(recipient);
+  }
+  // Link the new node between the old node and its next page, both ways
   recipient->SetNextPageId(node->GetNextPageId());
+  recipient->SetPrevPageId(node->GetPageId());
+  SetPrevLeaf(recipient->GetNextPageId(), recipient->GetPageId());
   node->SetNextPageId(recipient->GetPageId());
-  // Unpin the recipient page after moving entries
-  buffer_pool_manager_->UnpinPage(page_id, true);
-
   return recipient;
 }
 
+/*
+ * Only the writer holding the latch of the leaf before page_id changes its prev page id: no other write of the page
+ * touches it, and index iterators do not latch. The page itself is not latched for it then.
+ */
+void BPlusTree::SetPrevLeaf(page_id_t page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID) return;
+  auto *leaf = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  leaf->SetPrevPageId(prev_page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
@@ -224,7 +722,7 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
  */
-void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction) {
+void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node) {
   if (old_node->IsRootPage()) {
     auto *page = buffer_pool_manager_->NewPage(root_page_id_);
     if (page == nullptr) throw("Out of memory: Unable to allocate new root page.");
@@ -240,17 +738,20 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     // Unpin the new root page after insertion
     buffer_pool_manager_->UnpinPage(root_page_id_, true);
   } else {
-    // Find the parent page of the old node
+    // Find the parent page of the old node, write latched by the caller
     int parent_page_id = old_node->GetParentPageId();
     auto *page = buffer_pool_manager_->FetchPage(parent_page_id);
     auto *parent = reinterpret_cast<InternalPage *>(page->GetData());
-    parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-    if (parent->GetSize() >= internal_max_size_) {
+    int size = parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    if (parent->IsOverflow()) {
       // If the parent page is overflowing, split it
-      auto *recipient = Split(parent, transaction);
-      if (recipient == nullptr) throw("Out of memory: Unable to split parent page.");
+      bool at_right_edge = !parent->HasUpperFence() && parent->ValueAt(size - 1) == new_node->GetPageId();
+      auto *recipient = Split(parent, at_right_edge);
       // Insert the new key into the parent of the parent
-      InsertIntoParent(parent, recipient->KeyAt(0), recipient, transaction);
+      std::vector<char> middle_key(processor_.GetKeySize());
+      recipient->KeyAt(0, reinterpret_cast<GenericKey *>(middle_key.data()));
+      InsertIntoParent(parent, reinterpret_cast<GenericKey *>(middle_key.data()), recipient);
+      buffer_pool_manager_->UnpinPage(recipient->GetPageId(), true);
     }
     buffer_pool_manager_->UnpinPage(parent_page_id, true);  // Unpin the parent page after insertion
   }
@@ -265,192 +766,158 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * NOTE: the separator keys of the ancestors are not updated when the first key of a leaf goes away, a separator
+ * only has to stay between the keys of its two subtrees.
  */
 void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
-  if (IsEmpty()) return;  // If the tree is empty, return immediately
-
-  auto *leaf_page = FindLeafPage(key, root_page_id_);
-  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-  if (leaf == nullptr) {
-    LOG(ERROR) << "Leaf page not found for key: " << key;
-    return;  // Leaf page not found
+  // Optimistic: only the leaf is write latched, enough as long as it does not underflow
+  Page *page = FindLeafPage(key, false, true);
+  if (page == nullptr) return;  // If the tree is empty, return immediately
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  RowId value;
+  bool exists = leaf->Lookup(key, value, processor_);
+  bool done = !exists || IsSafe(leaf, Operation::kRemove);
+  if (exists && done) {
+    leaf->RemoveAndDeleteRecord(key, processor_);
   }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), exists && done);
+  if (done) return;
 
-  // If we delete the first key in the leaf page, we need to revise corresponding parent page
-  bool is_first_key = (leaf->KeyIndex(key, processor_) == 0);
-  leaf->RemoveAndDeleteRecord(key, processor_);
-  if (is_first_key && !leaf->IsRootPage()) {
-    auto *parent_page = buffer_pool_manager_->FetchPage(leaf->GetParentPageId());
-    auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
-    page_id_t value = leaf->GetPageId();
-    int index;
-    while ((index = parent->ValueIndex(value)) == 0 && !parent->IsRootPage()) {
-      buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);  // Unpin the parent page without dirty flag
-      value = parent->GetPageId();
-      parent_page = buffer_pool_manager_->FetchPage(parent->GetParentPageId());
-      parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
-    }
-    if (index > 0) {
-      parent->SetKeyAt(index, leaf->KeyAt(0));  // Update the key in the parent page
+  // Pessimistic: write latch from the root, the leaf may merge up to the root
+  LatchContext context;
+  page = FindLeafPageForWrite(key, Operation::kRemove, context);
+  if (page != nullptr) {
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf->Lookup(key, value, processor_)) {
+      leaf->RemoveAndDeleteRecord(key, processor_);
+      // Check if the leaf page is underflowed
+      if (leaf->IsUnderflow(merge_threshold_)) {
+        CoalesceOrRedistribute(leaf, context);
+      }
     }
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);  // Unpin the parent page after updating
   }
+  ReleaseLatches(context, true);
+}
 
-  // Check if the leaf page is underflowed
-  if (leaf->GetSize() < leaf->GetMinSize()) {
-    CoalesceOrRedistribute(leaf, transaction);
+/*
+ * The optimistic path of Remove, with the leaf kept write latched for the keys after it.
+ */
+void BPlusTree::RemoveBatch(const std::vector<const GenericKey *> &keys, Txn *transaction) {
+  LeafCursor cursor;
+  cursor.exclusive_ = true;
+  for (auto key : keys) {
+    if (!CursorCovers(cursor, key)) {
+      MoveCursor(cursor, nullptr);
+      MoveCursor(cursor, FindLeafPage(key, false, true));
+      if (cursor.page_ == nullptr) return;  // empty tree
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(cursor.page_->GetData());
+    RowId value;
+    if (!leaf->Lookup(key, value, processor_)) {
+      continue;
+    }
+    if (IsSafe(leaf, Operation::kRemove)) {
+      leaf->RemoveAndDeleteRecord(key, processor_);
+      cursor.dirty_ = true;
+      continue;
+    }
+    // the leaf underflows
+    MoveCursor(cursor, nullptr);
+    Remove(key, transaction);
   }
+  MoveCursor(cursor, nullptr);
 }
 
-/* todo
- * User needs to first find the sibling of input page. If sibling's size + input
- * page's size > page's max size, then redistribute. Otherwise, merge.
+/*
+ * User needs to first find the sibling of input page. The node is merged with its left sibling, or with its right
+ * one if it is the first child; if both do not fit in one page, their entries are redistributed instead. Pages are
+ * sized by bytes, so neither may be possible: the node is then left underflowing.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * The node and its parent are write latched by the caller, the sibling is latched here. Pages emptied by a merge are
+ * recorded in context and deleted after every latch is released.
  */
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Txn *transaction) {
+void BPlusTree::CoalesceOrRedistribute(N *node, LatchContext &context) {
   // If the node is the root, adjust it
-  if (node->IsRootPage()) return AdjustRoot(node);
+  if (node->IsRootPage()) {
+    AdjustRoot(node, context);
+    return;
+  }
 
   // Fetch the parent page of the node
   page_id_t parent_page_id = node->GetParentPageId();
   auto *parent_page = buffer_pool_manager_->FetchPage(parent_page_id);
   auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
   int index = parent->ValueIndex(node->GetPageId());
-  if (index < 0) {
+  if (index < 0 || parent->GetSize() < 2) {
     buffer_pool_manager_->UnpinPage(parent_page_id, false);  // Unpin the parent page without dirty flag
-    return false;                                            // Node not found in parent
+    return;                                                  // Node not found in parent, or no sibling
   }
 
-  // Find the sibling page of the node
+  // Find the sibling page of the node, it can only be reached through the parent we hold
+  int right_index = (index == 0) ? 1 : index;
   page_id_t sibling_page_id = (index == 0) ? parent->ValueAt(1) : parent->ValueAt(index - 1);
   auto *sibling_page = buffer_pool_manager_->FetchPage(sibling_page_id);
+  sibling_page->WLatch();
   auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+  N *left = (index == 0) ? node : sibling;
+  N *right = (index == 0) ? sibling : node;
 
-  // Check if the sibling can redistribute or coalesce
-  if (sibling->GetSize() + node->GetSize() >= sibling->GetMaxSize()) {
-    // If the sibling can redistribute, do so
-    Redistribute(sibling, node, index);
-    buffer_pool_manager_->UnpinPage(sibling_page_id, true);  // Unpin the sibling page after redistribution
-    buffer_pool_manager_->UnpinPage(parent_page_id, true);   // Unpin the parent page after redistribution
-    return false;                                            // No deletion happened
-  } else {
-    // If the sibling cannot redistribute, coalesce
-    bool should_delete = Coalesce(sibling, node, parent, index, transaction);
-    buffer_pool_manager_->UnpinPage(sibling_page_id, true);  // Unpin the sibling page after coalescing
-    buffer_pool_manager_->UnpinPage(parent_page_id, true);   // Unpin the parent page after coalescing
-    return should_delete;                                    // Return whether the node should be deleted
+  merges_++;
+  if (!Coalesce(left, right, parent, right_index, context)) {
+    Redistribute(left, right, parent, right_index);
   }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
+ * Move all the key & value pairs from the right page to its left sibling, and notify
+ * buffer pool manager to delete the right page. Parent page must be adjusted to
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @param   index              position of right in parent
+ * @return  false if the entries do not fit in one page, nothing is merged then
  */
-bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index, Txn *transaction) {
-
-  if (index == 0) {
-    neighbor_node->MoveAllTo(node);                                     // Move all entries from neighbor to node
-    buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);  // Unpin the neighbor page
-    buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());       // Delete the neighbor page
-    parent->Remove(1);  // Remove the key in the parent that points to the neighbor
-    if (parent->GetSize() < parent->GetMinSize()) {
-      // If the parent is underflowed, coalesce or redistribute
-      return CoalesceOrRedistribute(parent, transaction);
-    }
-    return false;
-  } else {
-    node->MoveAllTo(neighbor_node);                            // Move all entries from node to neighbor
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);  // Unpin the node page
-    buffer_pool_manager_->DeletePage(node->GetPageId());       // Delete the node page
-    parent->Remove(index);                                     // Remove the key in the parent that points to the node
-    if (parent->GetSize() < parent->GetMinSize()) {
-      // If the parent is underflowed, coalesce or redistribute
-      return CoalesceOrRedistribute(parent, transaction);
-    }
-    return false;
+bool BPlusTree::Coalesce(LeafPage *left, LeafPage *right, InternalPage *parent, int index, LatchContext &context) {
+  if (!right->MoveAllTo(left)) return false;
+  SetPrevLeaf(left->GetNextPageId(), left->GetPageId());
+  context.deleted_pages_.push_back(right->GetPageId());  // Delete the right page
+  parent->Remove(index);                                  // Remove the key in the parent that points to it
+  if (parent->IsUnderflow(merge_threshold_)) {
+    // If the parent is underflowed, coalesce or redistribute
+    CoalesceOrRedistribute(parent, context);
   }
+  return true;
 }
 
-bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                         Txn *transaction) {
-  if (index == 0) {
-    neighbor_node->MoveAllTo(node, parent->KeyAt(1), buffer_pool_manager_);  // Move all entries from neighbor to node
-    buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);       // Unpin the neighbor page
-    buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());            // Delete the neighbor page
-    parent->Remove(1);  // Remove the key in the parent that points to the neighbor
-    if (parent->GetSize() < parent->GetMinSize()) {
-      // If the parent is underflowed, coalesce or redistribute
-      return CoalesceOrRedistribute(parent, transaction);
-    }
-    return false;
-  } else {
-    node->MoveAllTo(neighbor_node, parent->KeyAt(index),
-                    buffer_pool_manager_);                     // Move all entries from node to neighbor
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);  // Unpin the node page
-    buffer_pool_manager_->DeletePage(node->GetPageId());       // Delete the node page
-    parent->Remove(index);                                     // Remove the key in the parent that points to the node
-    if (parent->GetSize() < parent->GetMinSize()) {
-      // If the parent is underflowed, coalesce or redistribute
-      return CoalesceOrRedistribute(parent, transaction);
-    }
-    return false;
+bool BPlusTree::Coalesce(InternalPage *left, InternalPage *right, InternalPage *parent, int index,
+                         LatchContext &context) {
+  std::vector<char> middle_key(processor_.GetKeySize());
+  parent->KeyAt(index, reinterpret_cast<GenericKey *>(middle_key.data()));
+  if (!right->MoveAllTo(left, reinterpret_cast<GenericKey *>(middle_key.data()), buffer_pool_manager_)) return false;
+  context.deleted_pages_.push_back(right->GetPageId());  // Delete the right page
+  parent->Remove(index);                                  // Remove the key in the parent that points to it
+  if (parent->IsUnderflow(merge_threshold_)) {
+    // If the parent is underflowed, coalesce or redistribute
+    CoalesceOrRedistribute(parent, context);
   }
+  return true;
 }
 
 /*
- * Redistribute key & value pairs from one page to its sibling page. If index ==
- * 0, move sibling page's first key & value pair into end of input "node",
- * otherwise move sibling page's last key & value pair into head of input
- * "node".
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * Redistribute key & value pairs between two sibling pages so that they hold about the same bytes, and replace
+ * the separator of the right page in parent.
+ * @param   index              position of right in parent
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-  page_id_t parent_page_id = node->GetParentPageId();
-  auto *parent_page = buffer_pool_manager_->FetchPage(parent_page_id);
-  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
-
-  if (index == 0) {
-    // Move the first key-value pair from the neighbor to the end of the node
-    neighbor_node->MoveFirstToEndOf(node);
-    parent->SetKeyAt(1, neighbor_node->KeyAt(0));  // Update the parent key
-  } else {
-    // Move the last key-value pair from the neighbor to the beginning of the node
-    neighbor_node->MoveLastToFrontOf(node);
-    parent->SetKeyAt(index, node->KeyAt(0));  // Update the parent key
-  }
-  buffer_pool_manager_->UnpinPage(parent_page_id, true);  // Unpin the parent page after redistribution
+void BPlusTree::Redistribute(LeafPage *left, LeafPage *right, InternalPage *parent, int index) {
+  left->RebalanceWith(right, parent, index);
 }
 
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-  page_id_t parent_page_id = node->GetParentPageId();
-  auto *parent_page = buffer_pool_manager_->FetchPage(parent_page_id);
-  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
-
-  if (index == 0) {
-    int index = parent->ValueIndex(neighbor_node->GetPageId());
-    GenericKey *key = neighbor_node->KeyAt(1);
-    neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(index), buffer_pool_manager_);
-    // NOTE: After executing MoveFirstToEndOf, the first key of neighbor_node is now at index 0
-    parent->SetKeyAt(index, neighbor_node->KeyAt(0));  // Update the parent key
-  } else {
-    int index = parent->ValueIndex(node->GetPageId());
-    GenericKey *key = neighbor_node->KeyAt(neighbor_node->GetSize() - 1);
-    neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
-    parent->SetKeyAt(index, key);  // Update the parent key
-  }
-  buffer_pool_manager_->UnpinPage(parent_page_id, true);  // Unpin the parent page after redistribution
+void BPlusTree::Redistribute(InternalPage *left, InternalPage *right, InternalPage *parent, int index) {
+  left->RebalanceWith(right, parent, index, buffer_pool_manager_);
 }
 
 /*
@@ -460,16 +927,15 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
- * @return : true means root page should be deleted, false means no deletion
- * happened
+ * The old root page is recorded in context for deletion when it goes away.
  */
-bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
-  // LOG(ERROR) << "Adjusting root page with ID: " << old_root_node->GetPageId();
-  if (old_root_node->GetSize() > 1) return false;  // If the root has more than one key, no adjustment needed
+void BPlusTree::AdjustRoot(BPlusTreePage *old_root_node, LatchContext &context) {
+  if (old_root_node->GetSize() > 1) return;  // If the root has more than one key, no adjustment needed
 
   // If the root has only one key, we need to adjust the root
   if (old_root_node->IsLeafPage()) {
-    // If the root is a leaf page and has only one key, we can simply delete it
+    // A leaf root is only dropped once its last key is gone
+    if (old_root_node->GetSize() > 0) return;
     root_page_id_ = INVALID_PAGE_ID;
   } else {
     // If the root is an internal page with only one child, we need to promote that child
@@ -479,8 +945,8 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     new_root_page->SetParentPageId(INVALID_PAGE_ID);
     buffer_pool_manager_->UnpinPage(root_page_id_, true);
   }
-  UpdateRootPageId(0);  // Update the root page ID in the header page
-  return true;          // Root page deleted
+  UpdateRootPageId(0);                                            // Update the root page ID in the header page
+  context.deleted_pages_.push_back(old_root_node->GetPageId());  // Root page deleted
 }
 
 /*****************************************************************************
@@ -492,9 +958,10 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-  Page *page = FindLeafPage(nullptr, root_page_id_, true);
+  Page *page = FindLeafPage(nullptr, true);
   if (page == nullptr) return IndexIterator();
   int page_id = page->GetPageId();
+  page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page_id, false);  // Unpin the page without dirty flag
   return IndexIterator(page_id, buffer_pool_manager_);
 }
@@ -505,13 +972,14 @@ IndexIterator BPlusTree::Begin() {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-  Page *page = FindLeafPage(key, root_page_id_, false);
+  Page *page = FindLeafPage(key, false);
   if (page == nullptr) return IndexIterator();
   int page_id = page->GetPageId();
   auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, processor_);
+  page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page_id, false);  // Unpin the page without dirty flag
-  return IndexIterator(page_id, buffer_pool_manager_,
-                       leaf->KeyIndex(key, processor_));  // Create iterator at the key index
+  return IndexIterator(page_id, buffer_pool_manager_, index);  // Create iterator at the key index
 }
 
 /*
@@ -521,32 +989,74 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  */
 IndexIterator BPlusTree::End() { return IndexIterator(); }
 
+/*
+ * Reverse iteration: the iterator walks the leaves through their prev page ids and turns into End() past the
+ * smallest key, the same as the forward iterator past the greatest one.
+ */
+IndexIterator BPlusTree::RBegin() {
+  Page *page = FindLeafPage(nullptr, false, false, true);
+  if (page == nullptr) return IndexIterator();
+  int page_id = page->GetPageId();
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->GetSize() - 1;
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return IndexIterator(page_id, buffer_pool_manager_, index);
+}
+
+IndexIterator BPlusTree::RBegin(const GenericKey *key) {
+  Page *page = FindLeafPage(key, false);
+  if (page == nullptr) return IndexIterator();
+  int page_id = page->GetPageId();
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->LastKeyIndex(key, processor_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  // a key below the first one of its leaf starts at the previous leaf
+  return IndexIterator(page_id, buffer_pool_manager_, index);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
- * NOTE: the leaf page is pinned, you need to unpin it after use.
+ * the left most leaf page, the right most one if rightMost is set
+ * Read latches are crabbed from the root: a child is latched before its parent is released. The leaf is write
+ * latched instead when exclusive is set, its type can be read before latching since a page keeps its type as long
+ * as its parent is latched.
+ * NOTE: the leaf page is pinned and latched, you need to unlatch and unpin it after use.
  */
-Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
-  if (IsEmpty()) return nullptr;
-
-  auto *page = buffer_pool_manager_->FetchPage(page_id);
-
+Page *BPlusTree::FindLeafPage(const GenericKey *key, bool leftMost, bool exclusive, bool rightMost) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  auto *page = buffer_pool_manager_->FetchPage(root_page_id_);
   auto *tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (exclusive && tree_page->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
 
-  if (tree_page->IsLeafPage()) return page;
-
-  auto *internal_page = reinterpret_cast<InternalPage *>(tree_page);
-  page_id_t next_page_id;
-  if (leftMost)
-    next_page_id = internal_page->ValueAt(0);
-  else
-    next_page_id = internal_page->Lookup(key, processor_);
-
-  buffer_pool_manager_->UnpinPage(page_id, false);  // Unpin the current page
-  return FindLeafPage(key, next_page_id, leftMost);
+  while (!tree_page->IsLeafPage()) {
+    auto *internal_page = reinterpret_cast<InternalPage *>(tree_page);
+    page_id_t next_page_id = leftMost    ? internal_page->ValueAt(0)
+                             : rightMost ? internal_page->ValueAt(internal_page->GetSize() - 1)
+                                         : internal_page->Lookup(key, processor_);
+    auto *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    tree_page = reinterpret_cast<BPlusTreePage *>(next_page->GetData());
+    if (exclusive && tree_page->IsLeafPage()) {
+      next_page->WLatch();
+    } else {
+      next_page->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);  // Unpin the current page
+    page = next_page;
+  }
+  return page;
 }
 
 /*
@@ -560,12 +1070,14 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
 void BPlusTree::UpdateRootPageId(int insert_record) {
   auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
 
+  // the header page is shared by every index
+  header_page->WLatch();
   auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
-  if (insert_record) {
+  // a tree emptied by removes keeps its record, the next new root updates it instead
+  if (!index_roots_page->Update(index_id_, root_page_id_) && insert_record) {
     index_roots_page->Insert(index_id_, root_page_id_);
-  } else {
-    index_roots_page->Update(index_id_, root_page_id_);
   }
+  header_page->WUnlatch();
 
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);  // Unpin the header page
 }
@@ -591,9 +1103,11 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         << "max_size=" << leaf->GetMaxSize() << ",min_size=" << leaf->GetMinSize() << ",size=" << leaf->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
+    std::vector<char> key(processor_.GetKeySize());
     for (int i = 0; i < leaf->GetSize(); i++) {
       Row ans;
-      processor_.DeserializeToKey(leaf->KeyAt(i), ans, schema);
+      leaf->KeyAt(i, reinterpret_cast<GenericKey *>(key.data()));
+      processor_.DeserializeToKey(reinterpret_cast<GenericKey *>(key.data()), ans, schema);
       out << "<TD>" << ans.GetField(0)->toString() << "</TD>\n";
     }
     out << "</TR>";
@@ -625,11 +1139,13 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
         << "max_size=" << inner->GetMaxSize() << ",min_size=" << inner->GetMinSize() << ",size=" << inner->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
+    std::vector<char> key(processor_.GetKeySize());
     for (int i = 0; i < inner->GetSize(); i++) {
       out << "<TD PORT=\"p" << inner->ValueAt(i) << "\">";
       if (i > 0) {
         Row ans;
-        processor_.DeserializeToKey(inner->KeyAt(i), ans, schema);
+        inner->KeyAt(i, reinterpret_cast<GenericKey *>(key.data()));
+        processor_.DeserializeToKey(reinterpret_cast<GenericKey *>(key.data()), ans, schema);
         out << ans.GetField(0)->toString();
       } else {
         out << " ";
@@ -670,7 +1186,7 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
               << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
-      std::cout << leaf->KeyAt(i) << ",";
+      std::cout << leaf->ValueAt(i).Get() << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
@@ -678,7 +1194,7 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
     auto *internal = reinterpret_cast<InternalPage *>(page);
     std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
-      std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
+      std::cout << internal->ValueAt(i) << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
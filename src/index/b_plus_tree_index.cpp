@@ -1,19 +1,86 @@
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 #include "index/generic_key.h"
+#include "index/key_sorter.h"
 #include "utils/tree_file_mgr.h"
+
+// smallest number of keys a bloom filter is sized for
+static constexpr uint64_t MIN_FILTER_CAPACITY = 1024;
+
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique, uint32_t bloom_bits_per_key)
     : Index(index_id, key_schema),
-      processor_(key_schema_, key_size),
-      container_(index_id, buffer_pool_manager, processor_) {}
+      processor_(key_schema_, key_size, !unique),
+      container_(index_id, buffer_pool_manager, processor_),
+      bloom_bits_per_key_(bloom_bits_per_key) {
+  RebuildFilter();
+}
+
+/*
+ * The filter is sized for twice the keys of the tree, it grows along with the tree by rebuilds that double it.
+ */
+void BPlusTreeIndex::RebuildFilter() {
+  if (bloom_bits_per_key_ == 0) {
+    return;
+  }
+  std::vector<uint64_t> hashes;
+  for (auto iter = container_.Begin(); iter != container_.End(); ++iter) {
+    hashes.push_back(processor_.HashKeyColumns((*iter).first));
+  }
+  filter_ = std::make_unique<BloomFilter>(std::max<uint64_t>(hashes.size() * 2, MIN_FILTER_CAPACITY),
+                                          bloom_bits_per_key_);
+  for (auto hash : hashes) {
+    filter_->Add(hash);
+  }
+  filter_keys_ = hashes.size();
+  removed_keys_ = 0;
+}
+
+bool BPlusTreeIndex::InsertKey(GenericKey *index_key, RowId row_id, Txn *txn) {
+  filter_latch_.RLock();
+  bool status = container_.Insert(index_key, row_id, txn);
+  bool rebuild = false;
+  if (status && filter_ != nullptr) {
+    filter_->Add(processor_.HashKeyColumns(index_key));
+    rebuild = ++filter_keys_ > filter_->GetCapacity();
+  }
+  filter_latch_.RUnlock();
+  if (rebuild) {
+    RebuildStaleFilter();
+  }
+  return status;
+}
+
+void BPlusTreeIndex::RemoveKey(GenericKey *index_key, Txn *txn) {
+  filter_latch_.RLock();
+  container_.Remove(index_key, txn);
+  bool rebuild = filter_ != nullptr && ++removed_keys_ * 2 > std::max(filter_keys_.load(), MIN_FILTER_CAPACITY);
+  filter_latch_.RUnlock();
+  if (rebuild) {
+    RebuildStaleFilter();
+  }
+}
+
+void BPlusTreeIndex::RebuildStaleFilter() {
+  filter_latch_.WLock();
+  if (filter_ != nullptr && (filter_keys_ > filter_->GetCapacity() ||
+                             removed_keys_ * 2 > std::max(filter_keys_.load(), MIN_FILTER_CAPACITY))) {
+    RebuildFilter();
+  }
+  filter_latch_.WUnlock();
+}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
 
-  bool status = container_.Insert(index_key, row_id, txn);
+  bool status = InsertKey(index_key, row_id, txn);
   free(index_key);
   //  TreeFileManagers mgr("tree_");
   //  static int i = 0;
@@ -29,57 +96,358 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
 
-  container_.Remove(index_key, txn);
+  RemoveKey(index_key, txn);
   free(index_key);
   return DB_SUCCESS;
 }
 
-dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
+dberr_t BPlusTreeIndex::InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
-  auto end_iter = GetEndIterator();
-  if (compare_operator == "=") {
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn)) ++iter;
-    result.clear();
-    for (; iter != end_iter; ++iter) {
-      result.emplace_back((*iter).second);
+  processor_.SerializeFromRow(index_key, row, projector);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  bool status = InsertKey(index_key, row_id, txn);
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t BPlusTreeIndex::RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  RemoveKey(index_key, txn);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t BPlusTreeIndex::ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result,
+                                   Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  LookupKey(index_key, result, txn);
+  free(index_key);
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+void BPlusTreeIndex::SerializeRows(const std::vector<const Row *> &rows, const KeyProjector &projector,
+                                   bool with_row_id, std::vector<char> &keys, std::vector<size_t> &order) {
+  size_t key_size = processor_.GetKeySize();
+  keys.assign(rows.size() * key_size, 0);
+  auto key_at = [&keys, key_size](size_t i) { return reinterpret_cast<GenericKey *>(keys.data() + i * key_size); };
+  order.resize(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    processor_.SerializeFromRow(key_at(i), *rows[i], projector);
+    if (processor_.HasRowIdSuffix()) {
+      if (with_row_id) {
+        processor_.SetRowId(key_at(i), rows[i]->GetRowId());
+      } else {
+        processor_.SetRowIdBound(key_at(i), false);
+      }
     }
-  } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != end_iter; ++iter) {
-      result.emplace_back((*iter).second);
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t lhs, size_t rhs) { return processor_.CompareKeys(key_at(lhs), key_at(rhs)) < 0; });
+}
+
+/*
+ * The keys are looked up in key order, every leaf is found once for all the keys it holds. The bloom filter drops
+ * the absent keys first.
+ */
+dberr_t BPlusTreeIndex::ScanRowKeys(const std::vector<const Row *> &rows, const KeyProjector &projector,
+                                    std::vector<std::vector<RowId>> &result, Txn *txn) {
+  std::vector<char> keys;
+  std::vector<size_t> order;
+  SerializeRows(rows, projector, false, keys, order);
+  size_t key_size = processor_.GetKeySize();
+  // a key of a non-unique index bounds the range of its entries from below, its copy from above
+  std::vector<char> uppers(processor_.HasRowIdSuffix() ? keys.size() : 0);
+  std::vector<std::pair<const GenericKey *, const GenericKey *>> ranges;
+  std::vector<size_t> looked_up;  // row of every range
+  filter_latch_.RLock();
+  for (auto i : order) {
+    auto *key = reinterpret_cast<GenericKey *>(keys.data() + i * key_size);
+    if (filter_ != nullptr && !filter_->MayContain(processor_.HashKeyColumns(key))) {
+      continue;
     }
-  } else if (compare_operator == "<") {
-    auto stop_iter = GetBeginIterator(index_key);
-    for (auto iter = GetBeginIterator(); iter != stop_iter; ++iter) {
-      result.emplace_back((*iter).second);
+    GenericKey *upper = key;
+    if (processor_.HasRowIdSuffix()) {
+      upper = reinterpret_cast<GenericKey *>(uppers.data() + i * key_size);
+      memcpy(upper, key, key_size);
+      processor_.SetRowIdBound(upper, true);
     }
-  } else if (compare_operator == "<=") {
-    auto stop_iter = GetBeginIterator(index_key);
-    for (auto iter = GetBeginIterator(); iter != stop_iter; ++iter) {
-      result.emplace_back((*iter).second);
+    ranges.emplace_back(key, upper);
+    looked_up.push_back(i);
+  }
+  filter_latch_.RUnlock();
+  std::vector<std::vector<RowId>> values;
+  container_.GetValues(ranges, values, txn);
+  result.assign(rows.size(), {});
+  bool found = false;
+  for (size_t j = 0; j < looked_up.size(); j++) {
+    found = found || !values[j].empty();
+    result[looked_up[j]] = std::move(values[j]);
+  }
+  return found ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t BPlusTreeIndex::InsertRowEntries(const std::vector<const Row *> &rows, const KeyProjector &projector,
+                                         Txn *txn) {
+  std::vector<char> keys;
+  std::vector<size_t> order;
+  SerializeRows(rows, projector, true, keys, order);
+  std::vector<GenericKey *> sorted_keys;
+  std::vector<RowId> row_ids;
+  for (auto i : order) {
+    sorted_keys.push_back(reinterpret_cast<GenericKey *>(keys.data() + i * processor_.GetKeySize()));
+    row_ids.push_back(rows[i]->GetRowId());
+  }
+  std::vector<bool> inserted;
+  filter_latch_.RLock();
+  container_.InsertBatch(sorted_keys, row_ids, inserted, txn);
+  bool status = true;
+  for (size_t j = 0; j < sorted_keys.size(); j++) {
+    status = status && inserted[j];
+    if (inserted[j] && filter_ != nullptr) {
+      filter_->Add(processor_.HashKeyColumns(sorted_keys[j]));
+      ++filter_keys_;
     }
+  }
+  bool rebuild = filter_ != nullptr && filter_keys_ > filter_->GetCapacity();
+  filter_latch_.RUnlock();
+  if (rebuild) {
+    RebuildStaleFilter();
+  }
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t BPlusTreeIndex::RemoveRowEntries(const std::vector<const Row *> &rows, const KeyProjector &projector,
+                                         Txn *txn) {
+  std::vector<char> keys;
+  std::vector<size_t> order;
+  SerializeRows(rows, projector, true, keys, order);
+  std::vector<const GenericKey *> sorted_keys;
+  for (auto i : order) {
+    sorted_keys.push_back(reinterpret_cast<GenericKey *>(keys.data() + i * processor_.GetKeySize()));
+  }
+  filter_latch_.RLock();
+  container_.RemoveBatch(sorted_keys, txn);
+  bool rebuild = filter_ != nullptr &&
+                 (removed_keys_ += rows.size()) * 2 > std::max(filter_keys_.load(), MIN_FILTER_CAPACITY);
+  filter_latch_.RUnlock();
+  if (rebuild) {
+    RebuildStaleFilter();
+  }
+  return DB_SUCCESS;
+}
+
+void BPlusTreeIndex::LookupKey(GenericKey *index_key, std::vector<RowId> &result, Txn *txn) {
+  // a key the filter has never seen is not in the tree
+  filter_latch_.RLock();
+  bool absent = filter_ != nullptr && !filter_->MayContain(processor_.HashKeyColumns(index_key));
+  filter_latch_.RUnlock();
+  if (absent) {
+    return;
+  }
+  if (!processor_.HasRowIdSuffix()) {
     container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != end_iter; ++iter) {
-      result.emplace_back((*iter).second);
+    return;
+  }
+  // the entries of the key lie between the smallest and the greatest row id suffix
+  processor_.SetRowIdBound(index_key, false);
+  IndexIterator iter = container_.Begin(index_key);
+  processor_.SetRowIdBound(index_key, true);
+  BPlusTreeScanIterator scan(processor_, std::move(iter), index_key, true);
+  RowId row_id;
+  while (scan.Next(&row_id)) {
+    result.emplace_back(row_id);
+  }
+}
+
+dberr_t BPlusTreeIndex::BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector,
+                                 Txn *txn) {
+  // only an empty tree is built bottom-up
+  if (!container_.IsEmpty()) {
+    for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+      if (InsertRowEntry(*row, projector, row->GetRowId(), txn) != DB_SUCCESS) {
+        return DB_FAILED;
+      }
+    }
+    return DB_SUCCESS;
+  }
+  KeySorter sorter(processor_);
+  GenericKey *index_key = processor_.InitKey();
+  for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+    processor_.SerializeFromRow(index_key, *row, projector);
+    if (processor_.HasRowIdSuffix()) {
+      processor_.SetRowId(index_key, row->GetRowId());
     }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
+    sorter.Add(index_key, row->GetRowId());
   }
   free(index_key);
+  sorter.Sort();
+  filter_latch_.WLock();
+  bool status = container_.BulkLoad(sorter.GetSize(),
+                                    [&sorter](GenericKey *key, RowId *row_id) { return sorter.Next(key, row_id); });
+  if (status) {
+    RebuildFilter();
+  }
+  filter_latch_.WUnlock();
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Txn *txn, string compare_operator) {
+  auto collect = [&result](std::unique_ptr<IndexScanIterator> iter) {
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.emplace_back(row_id);
+    }
+  };
+  if (compare_operator == "=") {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+    LookupKey(index_key, result, txn);
+    free(index_key);
+  } else if (compare_operator == ">") {
+    collect(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    collect(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    collect(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    collect(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    collect(Scan(nullptr, false, &key, false, txn));
+    collect(Scan(&key, false, nullptr, false, txn));
+  }
   if (!result.empty())
     return DB_SUCCESS;
   else
     return DB_KEY_NOT_FOUND;
 }
 
+std::unique_ptr<IndexScanIterator> BPlusTreeIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                        bool upper_inclusive, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  IndexIterator iter = GetBeginIterator();
+  if (lower != nullptr) {
+    processor_.SerializeFromPrefix(index_key, *lower, !lower_inclusive);
+    if (processor_.HasRowIdSuffix()) {
+      // start before the first entry of lower, or after the last one
+      processor_.SetRowIdBound(index_key, !lower_inclusive);
+    }
+    iter = GetBeginIterator(index_key);
+    // the iterator starts at the first key not less than lower
+    if (!lower_inclusive && iter != GetEndIterator() && processor_.CompareKeys((*iter).first, index_key) == 0) {
+      ++iter;
+    }
+  }
+  if (upper != nullptr) {
+    processor_.SerializeFromPrefix(index_key, *upper, upper_inclusive);
+    if (processor_.HasRowIdSuffix()) {
+      processor_.SetRowIdBound(index_key, upper_inclusive);
+    }
+  }
+  auto scan = std::make_unique<BPlusTreeScanIterator>(processor_, std::move(iter), upper ? index_key : nullptr,
+                                                      upper_inclusive);
+  free(index_key);
+  return scan;
+}
+
+std::unique_ptr<IndexScanIterator> BPlusTreeIndex::ScanReverse(const Row *lower, bool lower_inclusive,
+                                                               const Row *upper, bool upper_inclusive, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  IndexIterator iter = container_.RBegin();
+  if (upper != nullptr) {
+    processor_.SerializeFromPrefix(index_key, *upper, upper_inclusive);
+    if (processor_.HasRowIdSuffix()) {
+      // start after the last entry of upper, or before the first one
+      processor_.SetRowIdBound(index_key, upper_inclusive);
+    }
+    iter = container_.RBegin(index_key);
+    // the iterator starts at the last key not greater than upper
+    if (!upper_inclusive && iter != GetEndIterator() && processor_.CompareKeys((*iter).first, index_key) == 0) {
+      --iter;
+    }
+  }
+  if (lower != nullptr) {
+    processor_.SerializeFromPrefix(index_key, *lower, !lower_inclusive);
+    if (processor_.HasRowIdSuffix()) {
+      processor_.SetRowIdBound(index_key, !lower_inclusive);
+    }
+  }
+  auto scan = std::make_unique<BPlusTreeScanIterator>(processor_, std::move(iter), lower ? index_key : nullptr,
+                                                      lower_inclusive, true);
+  free(index_key);
+  return scan;
+}
+
+BPlusTreeScanIterator::BPlusTreeScanIterator(const KeyManager &key_manager, IndexIterator iterator,
+                                             const GenericKey *bound, bool bound_inclusive, bool reverse)
+    : key_manager_(key_manager), iterator_(std::move(iterator)), bound_inclusive_(bound_inclusive), reverse_(reverse) {
+  if (bound != nullptr) {
+    auto *data = reinterpret_cast<const char *>(bound);
+    bound_.assign(data, data + key_manager_.GetKeySize());
+  }
+}
+
+bool BPlusTreeScanIterator::Next(RowId *row_id) { return NextEntry(row_id, nullptr); }
+
+/*
+ * The key is read from the leaf the iterator is on, the row is never fetched.
+ */
+bool BPlusTreeScanIterator::NextEntry(RowId *row_id, Row *key) {
+  if (iterator_ == IndexIterator()) {
+    return false;
+  }
+  auto entry = *iterator_;
+  if (!bound_.empty()) {
+    int cmp = key_manager_.CompareKeys(entry.first, reinterpret_cast<GenericKey *>(bound_.data()));
+    if (reverse_) {
+      cmp = -cmp;
+    }
+    if (cmp > 0 || (cmp == 0 && !bound_inclusive_)) {
+      // past the range, unpin the leaf right away
+      iterator_ = IndexIterator();
+      return false;
+    }
+  }
+  *row_id = entry.second;
+  if (key != nullptr) {
+    // the key manager restores the key by its own key schema
+    key_manager_.DeserializeToKey(entry.first, *key, nullptr);
+  }
+  if (reverse_) {
+    --iterator_;
+  } else {
+    ++iterator_;
+  }
+  return true;
+}
+
+dberr_t BPlusTreeIndex::Vacuum(int *pages_released, Txn *txn) {
+  // keeps inserts, removes and lookups out while the tree is rebuilt, the keys and so the filter stay the same
+  filter_latch_.WLock();
+  *pages_released = container_.Vacuum();
+  filter_latch_.WUnlock();
+  return DB_SUCCESS;
+}
+
+dberr_t BPlusTreeIndex::GetStats(IndexStats *stats) {
+  *stats = container_.GetStats();
+  return DB_SUCCESS;
+}
+
 dberr_t BPlusTreeIndex::Destroy() {
   container_.Destroy();
+  filter_.reset();
   return DB_SUCCESS;
 }
 
@@ -0,0 +1,38 @@
+#include "index/bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * k = bits_per_key * ln 2 hashes minimize the false positive rate of the filter.
+ */
+BloomFilter::BloomFilter(uint64_t capacity, uint32_t bits_per_key)
+    : capacity_(std::max<uint64_t>(capacity, 1)),
+      bit_count_(std::max<uint64_t>(capacity_ * bits_per_key, 64)),
+      hash_count_(std::clamp(static_cast<uint32_t>(std::lround(bits_per_key * M_LN2)), 1U, 30U)),
+      words_((bit_count_ + 63) / 64) {
+  for (auto &word : words_) {
+    word.store(0, std::memory_order_relaxed);
+  }
+}
+
+void BloomFilter::Add(uint64_t hash) {
+  uint32_t h1 = static_cast<uint32_t>(hash);
+  uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  for (uint32_t i = 0; i < hash_count_; i++) {
+    uint64_t bit = (h1 + static_cast<uint64_t>(i) * h2) % bit_count_;
+    words_[bit / 64].fetch_or(uint64_t{1} << (bit % 64), std::memory_order_relaxed);
+  }
+}
+
+bool BloomFilter::MayContain(uint64_t hash) const {
+  uint32_t h1 = static_cast<uint32_t>(hash);
+  uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  for (uint32_t i = 0; i < hash_count_; i++) {
+    uint64_t bit = (h1 + static_cast<uint64_t>(i) * h2) % bit_count_;
+    if ((words_[bit / 64].load(std::memory_order_relaxed) & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
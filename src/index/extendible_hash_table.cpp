@@ -0,0 +1,311 @@
+#include "index/extendible_hash_table.h"
+
+#include "glog/logging.h"
+#include "page/index_roots_page.h"
+
+ExtendibleHashTable::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                         const KeyManager &KM, bool unique)
+    : index_id_(index_id), buffer_pool_manager_(buffer_pool_manager), processor_(KM), unique_(unique) {
+  auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  header_page->WLatch();
+  auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
+  bool is_new = !index_roots_page->GetRootId(index_id_, &directory_page_id_);
+  if (is_new) {
+    // a new table starts with a single bucket
+    page_id_t bucket_page_id;
+    auto *bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+    auto *dir_page = buffer_pool_manager_->NewPage(directory_page_id_);
+    ASSERT(bucket_page != nullptr && dir_page != nullptr, "Out of memory for a new hash table.");
+    reinterpret_cast<HashTableBucketPage *>(bucket_page->GetData())->Init(bucket_page_id, processor_.GetKeySize());
+    reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData())->Init(directory_page_id_, bucket_page_id);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    index_roots_page->Insert(index_id_, directory_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, is_new);
+}
+
+HashTableDirectoryPage *ExtendibleHashTable::FetchDirectory() {
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+HashTableBucketPage *ExtendibleHashTable::FetchBucket(page_id_t bucket_page_id) {
+  return reinterpret_cast<HashTableBucketPage *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool ExtendibleHashTable::GetValue(const GenericKey *key, std::vector<RowId> &result) {
+  latch_.RLock();
+  auto *dir = FetchDirectory();
+  page_id_t page_id = dir->GetBucketPageId(processor_.HashKey(key) & dir->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  bool found = false;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = FetchBucket(page_id);
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      if (processor_.CompareKeys(bucket->KeyAt(i), key) == 0) {
+        result.emplace_back(bucket->ValueAt(i));
+        found = true;
+      }
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  latch_.RUnlock();
+  return found;
+}
+
+page_id_t ExtendibleHashTable::GetBucketPageId(const GenericKey *key) {
+  latch_.RLock();
+  auto *dir = FetchDirectory();
+  page_id_t page_id = dir->GetBucketPageId(processor_.HashKey(key) & dir->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  latch_.RUnlock();
+  return page_id;
+}
+
+std::vector<page_id_t> ExtendibleHashTable::GetBucketPageIds() {
+  latch_.RLock();
+  auto *dir = FetchDirectory();
+  std::vector<page_id_t> page_ids;
+  for (uint32_t i = 0; i < dir->Size(); i++) {
+    // a bucket is listed by the lowest of its entries, the one with no bit set above its local depth
+    if ((i >> dir->GetLocalDepth(i)) == 0) {
+      page_ids.push_back(dir->GetBucketPageId(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  latch_.RUnlock();
+  return page_ids;
+}
+
+void ExtendibleHashTable::ReadBucket(page_id_t bucket_page_id, std::vector<char> &keys, std::vector<RowId> &values) {
+  latch_.RLock();
+  int key_size = processor_.GetKeySize();
+  page_id_t page_id = bucket_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = FetchBucket(page_id);
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      auto *key = reinterpret_cast<const char *>(bucket->KeyAt(i));
+      keys.insert(keys.end(), key, key + key_size);
+      values.emplace_back(bucket->ValueAt(i));
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  latch_.RUnlock();
+}
+
+uint32_t ExtendibleHashTable::GetGlobalDepth() {
+  latch_.RLock();
+  uint32_t global_depth = FetchDirectory()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  latch_.RUnlock();
+  return global_depth;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Append to the first page of the bucket chain with room. A full bucket is split and the insert retried, unless
+ * its entries share one hash or it is at the max depth: it gets an overflow page then.
+ */
+bool ExtendibleHashTable::Insert(const GenericKey *key, const RowId &value) {
+  latch_.WLock();
+  auto *dir = FetchDirectory();
+  bool dir_dirty = false;
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = processor_.HashKey(key) & dir->GetGlobalDepthMask();
+    page_id_t head_page_id = dir->GetBucketPageId(bucket_idx);
+    page_id_t room_page_id = INVALID_PAGE_ID;
+    page_id_t tail_page_id = INVALID_PAGE_ID;
+    bool duplicate = false;
+    for (page_id_t page_id = head_page_id; page_id != INVALID_PAGE_ID && !duplicate;) {
+      auto *bucket = FetchBucket(page_id);
+      duplicate = bucket->Find(key, unique_ ? nullptr : &value, processor_) != -1;
+      if (room_page_id == INVALID_PAGE_ID && !bucket->IsFull()) {
+        room_page_id = page_id;
+      }
+      tail_page_id = page_id;
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    if (duplicate) {
+      break;
+    }
+    if (room_page_id != INVALID_PAGE_ID) {
+      FetchBucket(room_page_id)->Append(key, value);
+      buffer_pool_manager_->UnpinPage(room_page_id, true);
+      inserted = true;
+      break;
+    }
+    auto *head = FetchBucket(head_page_id);
+    bool can_split = head->GetNextPageId() == INVALID_PAGE_ID && !IsSameHash(head) &&
+                     (dir->GetLocalDepth(bucket_idx) < dir->GetGlobalDepth() ||
+                      dir->GetGlobalDepth() < HashTableDirectoryPage::MAX_DEPTH);
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    if (can_split && SplitBucket(dir, bucket_idx)) {
+      dir_dirty = true;
+      continue;
+    }
+    // chain an overflow page
+    page_id_t overflow_page_id;
+    auto *page = buffer_pool_manager_->NewPage(overflow_page_id);
+    if (page == nullptr) {
+      LOG(ERROR) << "Out of memory for a hash bucket overflow page.";
+      break;
+    }
+    auto *overflow = reinterpret_cast<HashTableBucketPage *>(page->GetData());
+    overflow->Init(overflow_page_id, processor_.GetKeySize());
+    overflow->Append(key, value);
+    buffer_pool_manager_->UnpinPage(overflow_page_id, true);
+    FetchBucket(tail_page_id)->SetNextPageId(overflow_page_id);
+    buffer_pool_manager_->UnpinPage(tail_page_id, true);
+    inserted = true;
+    break;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  latch_.WUnlock();
+  return inserted;
+}
+
+bool ExtendibleHashTable::IsSameHash(const HashTableBucketPage *bucket) const {
+  for (int i = 1; i < bucket->GetSize(); i++) {
+    if (processor_.HashKey(bucket->KeyAt(i)) != processor_.HashKey(bucket->KeyAt(0))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * The entries whose hash has the bit of the old local depth set move to a new bucket, the split image.
+ */
+bool ExtendibleHashTable::SplitBucket(HashTableDirectoryPage *dir, uint32_t bucket_idx) {
+  uint32_t local_depth = dir->GetLocalDepth(bucket_idx);
+  if (local_depth == dir->GetGlobalDepth() && !dir->Grow()) {
+    return false;
+  }
+  page_id_t image_page_id;
+  auto *page = buffer_pool_manager_->NewPage(image_page_id);
+  if (page == nullptr) {
+    LOG(ERROR) << "Out of memory for a hash bucket page.";
+    return false;
+  }
+  auto *image = reinterpret_cast<HashTableBucketPage *>(page->GetData());
+  image->Init(image_page_id, processor_.GetKeySize());
+  page_id_t bucket_page_id = dir->GetBucketPageId(bucket_idx);
+  auto *bucket = FetchBucket(bucket_page_id);
+  for (int i = 0; i < bucket->GetSize();) {
+    if ((processor_.HashKey(bucket->KeyAt(i)) >> local_depth) & 1) {
+      image->Append(bucket->KeyAt(i), bucket->ValueAt(i));
+      bucket->RemoveAt(i);
+    } else {
+      i++;
+    }
+  }
+  uint32_t low_bits = bucket_idx & ((1u << local_depth) - 1);
+  dir->SetBucket(low_bits, local_depth + 1, bucket_page_id);
+  dir->SetBucket(low_bits | (1u << local_depth), local_depth + 1, image_page_id);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * An emptied overflow page is unlinked from its chain and deleted, an emptied bucket is merged.
+ */
+bool ExtendibleHashTable::Remove(const GenericKey *key, const RowId &value) {
+  latch_.WLock();
+  auto *dir = FetchDirectory();
+  uint32_t bucket_idx = processor_.HashKey(key) & dir->GetGlobalDepthMask();
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = dir->GetBucketPageId(bucket_idx);
+  bool removed = false;
+  bool merge = false;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = FetchBucket(page_id);
+    int index = bucket->Find(key, &value, processor_);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (index == -1) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      prev_page_id = page_id;
+      page_id = next_page_id;
+      continue;
+    }
+    bucket->RemoveAt(index);
+    removed = true;
+    bool empty = bucket->GetSize() == 0;
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    if (empty && prev_page_id != INVALID_PAGE_ID) {
+      FetchBucket(prev_page_id)->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else if (empty && next_page_id == INVALID_PAGE_ID) {
+      merge = true;
+    }
+    break;
+  }
+  if (merge) {
+    MergeBucket(dir, bucket_idx);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, merge);
+  latch_.WUnlock();
+  return removed;
+}
+
+void ExtendibleHashTable::MergeBucket(HashTableDirectoryPage *dir, uint32_t bucket_idx) {
+  while (dir->GetLocalDepth(bucket_idx) > 0) {
+    uint32_t local_depth = dir->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = dir->GetSplitImageIndex(bucket_idx);
+    if (dir->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = dir->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir->GetBucketPageId(image_idx);
+    auto *bucket = FetchBucket(bucket_page_id);
+    bool empty = bucket->GetSize() == 0 && bucket->GetNextPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      break;
+    }
+    dir->SetBucket(image_idx, local_depth - 1, image_page_id);
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    // the image may be empty as well, it is merged further
+    bucket_idx = image_idx & ((1u << (local_depth - 1)) - 1);
+  }
+  dir->ShrinkAll();
+}
+
+void ExtendibleHashTable::Destroy() {
+  std::vector<page_id_t> bucket_page_ids = GetBucketPageIds();
+  latch_.WLock();
+  for (page_id_t page_id : bucket_page_ids) {
+    while (page_id != INVALID_PAGE_ID) {
+      auto *bucket = FetchBucket(page_id);
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = next_page_id;
+    }
+  }
+  buffer_pool_manager_->DeletePage(directory_page_id_);
+  auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  header_page->WLatch();
+  reinterpret_cast<IndexRootsPage *>(header_page->GetData())->Delete(index_id_);
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  directory_page_id_ = INVALID_PAGE_ID;
+  latch_.WUnlock();
+}
@@ -0,0 +1,174 @@
+#include "index/hash_index.h"
+
+HashIndex::HashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                     BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, key_size),
+      container_(index_id, buffer_pool_manager, processor_, unique) {}
+
+dberr_t HashIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  bool status = container_.Insert(index_key, row_id);
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t HashIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  container_.Remove(index_key, row_id);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  bool status = container_.Insert(index_key, row_id);
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t HashIndex::RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  container_.Remove(index_key, row_id);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  container_.GetValue(index_key, result);
+  free(index_key);
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+// buckets are not sorted, there is nothing to gain from building the table in one pass
+dberr_t HashIndex::BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) {
+  for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+    if (InsertRowEntry(*row, projector, row->GetRowId(), txn) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t HashIndex::ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator) {
+  auto collect = [&result](std::unique_ptr<IndexScanIterator> iter) {
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.emplace_back(row_id);
+    }
+  };
+  if (compare_operator == "=") {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+    container_.GetValue(index_key, result);
+    free(index_key);
+  } else if (compare_operator == ">") {
+    collect(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    collect(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    collect(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    collect(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    collect(Scan(nullptr, false, &key, false, txn));
+    collect(Scan(&key, false, nullptr, false, txn));
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanIterator> HashIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                   bool upper_inclusive, Txn *txn) {
+  GenericKey *lower_key = nullptr;
+  GenericKey *upper_key = nullptr;
+  if (lower != nullptr) {
+    lower_key = processor_.InitKey();
+    processor_.SerializeFromPrefix(lower_key, *lower, !lower_inclusive);
+  }
+  if (upper != nullptr) {
+    upper_key = processor_.InitKey();
+    processor_.SerializeFromPrefix(upper_key, *upper, upper_inclusive);
+  }
+  std::vector<page_id_t> bucket_page_ids;
+  if (lower_key != nullptr && upper_key != nullptr && processor_.CompareKeys(lower_key, upper_key) == 0) {
+    // a single key lies in a single bucket
+    if (lower_inclusive && upper_inclusive) {
+      bucket_page_ids.push_back(container_.GetBucketPageId(lower_key));
+    }
+  } else {
+    bucket_page_ids = container_.GetBucketPageIds();
+  }
+  auto scan = std::make_unique<HashScanIterator>(&container_, processor_, std::move(bucket_page_ids), lower_key,
+                                                 lower_inclusive, upper_key, upper_inclusive);
+  free(lower_key);
+  free(upper_key);
+  return scan;
+}
+
+dberr_t HashIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
+
+HashScanIterator::HashScanIterator(ExtendibleHashTable *table, const KeyManager &key_manager,
+                                   std::vector<page_id_t> bucket_page_ids, const GenericKey *lower,
+                                   bool lower_inclusive, const GenericKey *upper, bool upper_inclusive)
+    : table_(table),
+      key_manager_(key_manager),
+      bucket_page_ids_(std::move(bucket_page_ids)),
+      lower_inclusive_(lower_inclusive),
+      upper_inclusive_(upper_inclusive) {
+  auto *lower_data = reinterpret_cast<const char *>(lower);
+  auto *upper_data = reinterpret_cast<const char *>(upper);
+  if (lower != nullptr) {
+    lower_.assign(lower_data, lower_data + key_manager_.GetKeySize());
+  }
+  if (upper != nullptr) {
+    upper_.assign(upper_data, upper_data + key_manager_.GetKeySize());
+  }
+}
+
+bool HashScanIterator::InRange(const GenericKey *key) const {
+  if (!lower_.empty()) {
+    int cmp = key_manager_.CompareKeys(key, reinterpret_cast<const GenericKey *>(lower_.data()));
+    if (cmp < 0 || (cmp == 0 && !lower_inclusive_)) return false;
+  }
+  if (!upper_.empty()) {
+    int cmp = key_manager_.CompareKeys(key, reinterpret_cast<const GenericKey *>(upper_.data()));
+    if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) return false;
+  }
+  return true;
+}
+
+bool HashScanIterator::Next(RowId *row_id) { return NextEntry(row_id, nullptr); }
+
+bool HashScanIterator::NextEntry(RowId *row_id, Row *key) {
+  int key_size = key_manager_.GetKeySize();
+  while (true) {
+    for (; pos_ < values_.size(); pos_++) {
+      auto *entry_key = reinterpret_cast<const GenericKey *>(keys_.data() + pos_ * key_size);
+      if (!InRange(entry_key)) {
+        continue;
+      }
+      *row_id = values_[pos_];
+      if (key != nullptr) {
+        key_manager_.DeserializeToKey(entry_key, *key, nullptr);
+      }
+      pos_++;
+      return true;
+    }
+    if (next_bucket_ == bucket_page_ids_.size()) {
+      return false;
+    }
+    keys_.clear();
+    values_.clear();
+    pos_ = 0;
+    table_->ReadBucket(bucket_page_ids_[next_bucket_++], keys_, values_);
+  }
+}
@@ -8,16 +8,55 @@ IndexIterator::IndexIterator() = default;
 IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
   page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+  key_.resize(page->GetKeySize());
+  // a start key past the last one of its leaf starts at the next leaf
+  while (page != nullptr && item_index >= page->GetSize()) {
+    item_index = page->GetSize() - 1;
+    ++(*this);
+  }
+  // a reverse start key below the first one of its leaf starts at the previous leaf
+  while (page != nullptr && item_index < 0) {
+    item_index = 0;
+    --(*this);
+  }
 }
 
 IndexIterator::~IndexIterator() {
   if (current_page_id != INVALID_PAGE_ID) buffer_pool_manager->UnpinPage(current_page_id, false);
 }
 
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept
+    : current_page_id(other.current_page_id),
+      page(other.page),
+      item_index(other.item_index),
+      buffer_pool_manager(other.buffer_pool_manager),
+      key_(std::move(other.key_)) {
+  other.current_page_id = INVALID_PAGE_ID;
+  other.page = nullptr;
+}
+
+IndexIterator &IndexIterator::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    if (current_page_id != INVALID_PAGE_ID) buffer_pool_manager->UnpinPage(current_page_id, false);
+    current_page_id = other.current_page_id;
+    page = other.page;
+    item_index = other.item_index;
+    buffer_pool_manager = other.buffer_pool_manager;
+    key_ = std::move(other.key_);
+    other.current_page_id = INVALID_PAGE_ID;
+    other.page = nullptr;
+  }
+  return *this;
+}
+
 /**
  * TODO: Student Implement
  */
-std::pair<GenericKey *, RowId> IndexIterator::operator*() { return page->GetItem(item_index); }
+std::pair<GenericKey *, RowId> IndexIterator::operator*() {
+  auto *key = reinterpret_cast<GenericKey *>(key_.data());
+  page->KeyAt(item_index, key);
+  return {key, page->ValueAt(item_index)};
+}
 
 /**
  * TODO: Student Implement
@@ -27,6 +66,7 @@ IndexIterator &IndexIterator::operator++() {
     item_index++;
   } else if (page->GetNextPageId() == INVALID_PAGE_ID) {
     // Reached the end of the index
+    buffer_pool_manager->UnpinPage(current_page_id, false);
     current_page_id = INVALID_PAGE_ID;
     page = nullptr;
     item_index = 0;
@@ -41,6 +81,25 @@ IndexIterator &IndexIterator::operator++() {
   return *this;
 }
 
+IndexIterator &IndexIterator::operator--() {
+  if (item_index > 0) {
+    item_index--;
+  } else if (page->GetPrevPageId() == INVALID_PAGE_ID) {
+    // Reached the beginning of the index
+    buffer_pool_manager->UnpinPage(current_page_id, false);
+    current_page_id = INVALID_PAGE_ID;
+    page = nullptr;
+    item_index = 0;
+  } else {
+    // Move to the last entry of the previous page
+    current_page_id = page->GetPrevPageId();
+    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
+    page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+    item_index = page->GetSize() - 1;
+  }
+  return *this;
+}
+
 bool IndexIterator::operator==(const IndexIterator &itr) const {
   return current_page_id == itr.current_page_id && item_index == itr.item_index;
 }
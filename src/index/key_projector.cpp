@@ -0,0 +1,65 @@
+#include "index/key_projector.h"
+
+KeyProjector::KeyProjector(const Schema *key_schema, const std::vector<uint32_t> &key_map) : key_map_(key_map) {
+  ASSERT(key_schema->GetColumnCount() == key_map.size(), "Key map does not match the key schema.");
+  types_.reserve(key_map.size());
+  widths_.reserve(key_map.size());
+  nullable_.reserve(key_map.size());
+  for (auto column : key_schema->GetColumns()) {
+    types_.push_back(column->GetType());
+    widths_.push_back(column->GetLength());
+    nullable_.push_back(column->IsNullable());
+    key_size_ += GetColumnKeySize(column);
+  }
+}
+
+uint32_t KeyProjector::GetColumnKeySize(const Column *column) {
+  // null flag + value padded to the column length
+  return (column->IsNullable() ? 1 : 0) + column->GetLength();
+}
+
+uint32_t KeyProjector::Project(const Row &row, char *buf) const {
+  char *pos = buf;
+  for (uint32_t i = 0; i < key_map_.size(); i++) {
+    pos += ProjectColumn(row.GetField(key_map_[i]), i, pos);
+  }
+  return pos - buf;
+}
+
+uint32_t KeyProjector::ProjectPrefix(const Row &key, char *buf) const {
+  ASSERT(key.GetFieldCount() <= key_map_.size(), "Key prefix is longer than the key.");
+  char *pos = buf;
+  for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+    pos += ProjectColumn(key.GetField(i), i, pos);
+  }
+  return pos - buf;
+}
+
+uint32_t KeyProjector::ProjectColumn(const Field *field, uint32_t i, char *buf) const {
+  char *pos = buf;
+  if (nullable_[i]) {
+    *pos++ = field->IsNull() ? 0 : 1;
+  }
+  if (field->IsNull()) {
+    // NOT NULL is not enforced on insert, such a null sorts as the smallest value of the column
+    memset(pos, 0, widths_[i]);
+  } else {
+    field->SerializeKeyTo(pos, widths_[i]);
+  }
+  return pos + widths_[i] - buf;
+}
+
+void KeyProjector::Restore(const char *buf, Row &key) const {
+  auto &fields = key.GetFields();
+  fields.clear();
+  fields.reserve(types_.size());
+  for (uint32_t i = 0; i < types_.size(); i++) {
+    fields.emplace_back(types_[i]);
+    if (nullable_[i] && *buf++ == 0) {
+      buf += widths_[i];
+      continue;
+    }
+    Field::DeserializeKeyFrom(buf, types_[i], widths_[i], &fields.back());
+    buf += widths_[i];
+  }
+}
@@ -0,0 +1,123 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+// bytes read from a spilled run at once
+static constexpr size_t RUN_READ_SIZE = 64 << 10;
+
+KeySorter::KeySorter(const KeyManager &key_manager, uint32_t buffer_size)
+    : key_manager_(key_manager),
+      entry_size_(key_manager.GetKeySize() + sizeof(RowId)),
+      buffer_size_(std::max(buffer_size, entry_size_)) {}
+
+KeySorter::~KeySorter() {
+  for (auto &run : runs_) {
+    if (run.file_ != nullptr) {
+      fclose(run.file_);
+    }
+  }
+}
+
+void KeySorter::Add(const GenericKey *key, const RowId &row_id) {
+  ASSERT(!sorted_, "Cannot add entries to a sorted key sorter.");
+  if (buffer_.size() + entry_size_ > buffer_size_) {
+    // spill the full buffer as a sorted run
+    SortBuffer();
+    Run &run = runs_.back();
+    run.file_ = std::tmpfile();
+    if (run.file_ == nullptr || fwrite(run.buffer_.data(), 1, run.buffer_.size(), run.file_) != run.buffer_.size()) {
+      LOG(FATAL) << "Failed to spill an index sort run to a temporary file.";
+    }
+    rewind(run.file_);
+    run.buffer_.clear();
+    run.buffer_.shrink_to_fit();
+    spilled_run_count_++;
+  }
+  size_t offset = buffer_.size();
+  buffer_.resize(offset + entry_size_);
+  memcpy(buffer_.data() + offset, key, key_manager_.GetKeySize());
+  memcpy(buffer_.data() + offset + key_manager_.GetKeySize(), &row_id, sizeof(RowId));
+  size_++;
+}
+
+void KeySorter::SortBuffer() {
+  std::vector<const char *> entries;
+  entries.reserve(buffer_.size() / entry_size_);
+  for (size_t offset = 0; offset < buffer_.size(); offset += entry_size_) {
+    entries.push_back(buffer_.data() + offset);
+  }
+  key_manager_.VisitComparator([&entries](auto comparator) {
+    std::sort(entries.begin(), entries.end(), [&comparator](const char *lhs, const char *rhs) {
+      return comparator(reinterpret_cast<const GenericKey *>(lhs), reinterpret_cast<const GenericKey *>(rhs)) < 0;
+    });
+  });
+  Run run;
+  run.buffer_.resize(buffer_.size());
+  char *dest = run.buffer_.data();
+  for (auto entry : entries) {
+    memcpy(dest, entry, entry_size_);
+    dest += entry_size_;
+  }
+  buffer_.clear();
+  runs_.push_back(std::move(run));
+}
+
+void KeySorter::Sort() {
+  ASSERT(!sorted_, "Key sorter is already sorted.");
+  // the last run stays in memory
+  if (!buffer_.empty()) {
+    SortBuffer();
+  }
+  buffer_.shrink_to_fit();
+  sorted_ = true;
+  for (size_t i = 0; i < runs_.size(); i++) {
+    if (FillRun(runs_[i])) {
+      heap_.push_back(i);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t lhs, size_t rhs) { return RunGreater(lhs, rhs); });
+}
+
+bool KeySorter::Next(GenericKey *key, RowId *row_id) {
+  ASSERT(sorted_, "Key sorter must be sorted before reading.");
+  if (heap_.empty()) {
+    return false;
+  }
+  auto greater = [this](size_t lhs, size_t rhs) { return RunGreater(lhs, rhs); };
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  Run &run = runs_[heap_.back()];
+  memcpy(key, Current(run), key_manager_.GetKeySize());
+  memcpy(row_id, Current(run) + key_manager_.GetKeySize(), sizeof(RowId));
+  run.pos_ += entry_size_;
+  if (FillRun(run)) {
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+bool KeySorter::FillRun(Run &run) {
+  if (run.pos_ < run.buffer_.size()) {
+    return true;
+  }
+  if (run.file_ != nullptr) {
+    // read whole entries only, the run file holds a multiple of the entry size
+    run.buffer_.resize(std::max<size_t>(RUN_READ_SIZE / entry_size_, 1) * entry_size_);
+    run.buffer_.resize(fread(run.buffer_.data(), 1, run.buffer_.size(), run.file_));
+    run.pos_ = 0;
+    if (!run.buffer_.empty()) {
+      return true;
+    }
+  }
+  run.buffer_.clear();
+  run.buffer_.shrink_to_fit();
+  return false;
+}
+
+bool KeySorter::RunGreater(size_t lhs, size_t rhs) const {
+  return key_manager_.CompareKeys(reinterpret_cast<const GenericKey *>(Current(runs_[lhs])),
+                                  reinterpret_cast<const GenericKey *>(Current(runs_[rhs]))) > 0;
+}
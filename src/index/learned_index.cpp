@@ -0,0 +1,690 @@
+#include "index/learned_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "index/key_sorter.h"
+#include "page/index_roots_page.h"
+#include "page/learned_meta_page.h"
+#include "page/learned_model_page.h"
+
+namespace {
+/**
+ * Entries of the data pages of a build read by position, the page last read stays pinned until the next one.
+ */
+class PageReader {
+ public:
+  explicit PageReader(const LearnedVersion &version) : version_(version) {}
+
+  ~PageReader() { Release(); }
+
+  uint64_t KeyAt(uint64_t position) { return Load(position)->KeyAt(position % LearnedDataPage::MAX_SIZE); }
+
+  RowId ValueAt(uint64_t position) { return Load(position)->ValueAt(position % LearnedDataPage::MAX_SIZE); }
+
+ private:
+  const LearnedDataPage *Load(uint64_t position) {
+    size_t index = position / LearnedDataPage::MAX_SIZE;
+    if (page_ == nullptr || index != index_) {
+      Release();
+      index_ = index;
+      page_ = reinterpret_cast<const LearnedDataPage *>(
+          version_.buffer_pool_manager_->FetchPage(version_.data_page_ids_[index])->GetData());
+    }
+    return page_;
+  }
+
+  void Release() {
+    if (page_ != nullptr) {
+      version_.buffer_pool_manager_->UnpinPage(version_.data_page_ids_[index_], false);
+      page_ = nullptr;
+    }
+  }
+
+  const LearnedVersion &version_;
+  const LearnedDataPage *page_{nullptr};
+  size_t index_{0};
+};
+
+// big-endian integer back to a normalized key of key_size bytes
+void IntToKey(uint64_t value, uint32_t key_size, std::vector<char> &key) {
+  key.resize(key_size);
+  if (key_size == sizeof(uint32_t)) {
+    uint32_t bytes = __builtin_bswap32(static_cast<uint32_t>(value));
+    memcpy(key.data(), &bytes, sizeof(bytes));
+  } else {
+    uint64_t bytes = __builtin_bswap64(value);
+    memcpy(key.data(), &bytes, sizeof(bytes));
+  }
+}
+
+// the delta is folded in once it reaches LEARNED_INDEX_REBUILD_RATIO of the index, or a data page for a small one
+bool DeltaFull(size_t delta_size, uint64_t entry_count) {
+  return delta_size >= std::max<uint64_t>(LearnedDataPage::MAX_SIZE, entry_count * LEARNED_INDEX_REBUILD_RATIO);
+}
+}  // namespace
+
+/*****************************************************************************
+ * BUILD
+ *****************************************************************************/
+LearnedVersion::~LearnedVersion() {
+  if (!obsolete_) {
+    return;
+  }
+  for (auto page_id : data_page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  for (auto page_id : model_page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+/*
+ * A key of the index is within LEARNED_INDEX_ERROR positions of its prediction, so the binary search starts with
+ * the window around it. A key that is not there may lie beyond the window when the key before it has many entries,
+ * its place is then found by galloping away from the window, still within the segment.
+ */
+uint64_t LearnedVersion::LowerBound(uint64_t key) const {
+  if (entry_count_ == 0 || key <= segments_[0].first_key_) {
+    return 0;
+  }
+  // the last segment whose first key is not greater than key
+  auto segment = std::upper_bound(segments_.begin(), segments_.end(), key,
+                                  [](uint64_t k, const LearnedSegment &s) { return k < s.first_key_; }) -
+                 1;
+  uint64_t begin = segment->first_position_;
+  uint64_t end = segment + 1 == segments_.end() ? entry_count_ : (segment + 1)->first_position_;
+  double predicted = segment->first_position_ + segment->slope_ * static_cast<double>(key - segment->first_key_);
+  auto position = static_cast<uint64_t>(std::min(predicted, static_cast<double>(end)));
+  uint64_t window_low = position > begin + LEARNED_INDEX_ERROR + 1 ? position - LEARNED_INDEX_ERROR - 1 : begin;
+  uint64_t window_high = std::min(position + LEARNED_INDEX_ERROR + 2, end);
+
+  PageReader reader(*this);
+  auto search = [&reader, key](uint64_t low, uint64_t high) {
+    while (low < high) {
+      uint64_t mid = low + (high - low) / 2;
+      if (reader.KeyAt(mid) < key) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  };
+  uint64_t result = search(window_low, window_high);
+  if (result == window_high && window_high < end) {
+    // every key of the window is less than key
+    uint64_t low = window_high;
+    uint64_t bound = window_high;
+    for (uint64_t step = 1; bound < end && reader.KeyAt(bound) < key; step *= 2) {
+      low = bound + 1;
+      bound = std::min(bound + step, end);
+    }
+    result = search(low, bound);
+  } else if (result == window_low && window_low > begin) {
+    // no key of the window is less than key
+    uint64_t high = window_low;
+    uint64_t bound = window_low;
+    for (uint64_t step = 1; bound > begin && reader.KeyAt(bound - 1) >= key; step *= 2) {
+      high = bound - 1;
+      bound -= std::min(step, bound - begin);
+    }
+    result = search(bound, high);
+  }
+  return result;
+}
+
+void LearnedVersion::ReadPage(size_t index, std::vector<uint64_t> &keys, std::vector<RowId> &values) const {
+  auto *page =
+      reinterpret_cast<LearnedDataPage *>(buffer_pool_manager_->FetchPage(data_page_ids_[index])->GetData());
+  keys.clear();
+  values.clear();
+  for (uint32_t i = 0; i < page->GetSize(); i++) {
+    keys.push_back(page->KeyAt(i));
+    values.push_back(page->ValueAt(i));
+  }
+  buffer_pool_manager_->UnpinPage(data_page_ids_[index], false);
+}
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+LearnedScanIterator::LearnedScanIterator(const KeyManager &key_manager, std::shared_ptr<LearnedVersion> version,
+                                         uint64_t position, uint64_t upper, std::vector<LearnedEntry> inserted,
+                                         std::set<LearnedEntry> removed)
+    : key_manager_(key_manager),
+      version_(std::move(version)),
+      position_(position),
+      upper_(upper),
+      inserted_(std::move(inserted)),
+      removed_(std::move(removed)) {}
+
+bool LearnedScanIterator::ValidBase() {
+  if (position_ >= version_->entry_count_) {
+    return false;
+  }
+  size_t page = position_ / LearnedDataPage::MAX_SIZE;
+  if (keys_.empty() || page != page_) {
+    page_ = page;
+    version_->ReadPage(page, keys_, values_);
+  }
+  return keys_[position_ % LearnedDataPage::MAX_SIZE] <= upper_;
+}
+
+bool LearnedScanIterator::Next(RowId *row_id) { return NextEntry(row_id, nullptr); }
+
+bool LearnedScanIterator::NextEntry(RowId *row_id, Row *key) {
+  while (true) {
+    bool base = ValidBase();
+    bool delta = inserted_pos_ < inserted_.size();
+    if (!base && !delta) {
+      return false;
+    }
+    LearnedEntry entry;
+    if (base) {
+      size_t slot = position_ % LearnedDataPage::MAX_SIZE;
+      entry = {keys_[slot], values_[slot].Get()};
+    }
+    if (delta && (!base || inserted_[inserted_pos_] < entry)) {
+      entry = inserted_[inserted_pos_++];
+    } else {
+      position_++;
+      if (removed_.count(entry) > 0) {
+        continue;
+      }
+    }
+    *row_id = RowId(entry.second);
+    if (key != nullptr) {
+      std::vector<char> key_buffer;
+      IntToKey(entry.first, key_manager_.GetKeySize(), key_buffer);
+      key_manager_.DeserializeToKey(reinterpret_cast<GenericKey *>(key_buffer.data()), *key, nullptr);
+    }
+    return true;
+  }
+}
+
+/*****************************************************************************
+ * INDEX
+ *****************************************************************************/
+LearnedIndex::LearnedIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                           BufferPoolManager *buffer_pool_manager, bool unique)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, key_size),
+      unique_(unique),
+      buffer_pool_manager_(buffer_pool_manager) {
+  ASSERT(key_size == sizeof(uint32_t) || key_size == sizeof(uint64_t), "Learned index keys are 4 or 8 bytes.");
+  auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  header_page->WLatch();
+  auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
+  bool is_new = !index_roots_page->GetRootId(index_id_, &meta_page_id_);
+  if (is_new) {
+    auto *meta_page = buffer_pool_manager_->NewPage(meta_page_id_);
+    ASSERT(meta_page != nullptr, "Out of memory for a new learned index.");
+    reinterpret_cast<LearnedMetaPage *>(meta_page->GetData())->Init(meta_page_id_);
+    buffer_pool_manager_->UnpinPage(meta_page_id_, true);
+    index_roots_page->Insert(index_id_, meta_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, is_new);
+  if (is_new) {
+    version_ = std::make_shared<LearnedVersion>(buffer_pool_manager_);
+  } else {
+    Open();
+  }
+}
+
+LearnedIndex::~LearnedIndex() {
+  if (!destroyed_ && (!inserted_.empty() || !removed_.empty())) {
+    latch_.WLock();
+    RebuildLocked();
+    latch_.WUnlock();
+  }
+}
+
+uint64_t LearnedIndex::KeyToInt(const GenericKey *key) const {
+  if (processor_.GetKeySize() == sizeof(uint32_t)) {
+    return FixedKeyComparator<uint32_t>::Load(key);
+  }
+  return FixedKeyComparator<uint64_t>::Load(key);
+}
+
+uint64_t LearnedIndex::RowToInt(const Row &key) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  uint64_t value = KeyToInt(index_key);
+  free(index_key);
+  return value;
+}
+
+uint64_t LearnedIndex::BoundToInt(const Row &bound, bool greatest) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromPrefix(index_key, bound, greatest);
+  uint64_t value = KeyToInt(index_key);
+  free(index_key);
+  return value;
+}
+
+dberr_t LearnedIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) { return Insert(RowToInt(key), row_id); }
+
+dberr_t LearnedIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+  Remove(RowToInt(key), row_id);
+  return DB_SUCCESS;
+}
+
+dberr_t LearnedIndex::InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  uint64_t key = KeyToInt(index_key);
+  free(index_key);
+  return Insert(key, row_id);
+}
+
+dberr_t LearnedIndex::RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  uint64_t key = KeyToInt(index_key);
+  free(index_key);
+  Remove(key, row_id);
+  return DB_SUCCESS;
+}
+
+dberr_t LearnedIndex::ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result,
+                                 Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  uint64_t key = KeyToInt(index_key);
+  free(index_key);
+  latch_.RLock();
+  LookupLocked(key, result);
+  latch_.RUnlock();
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+dberr_t LearnedIndex::Insert(uint64_t key, const RowId &row_id) {
+  latch_.WLock();
+  if (unique_) {
+    std::vector<RowId> found;
+    LookupLocked(key, found);
+    if (!found.empty()) {
+      latch_.WUnlock();
+      return DB_FAILED;
+    }
+  }
+  LearnedEntry entry(key, row_id.Get());
+  // an entry removed from the data pages since the build is simply there again
+  if (removed_.erase(entry) == 0) {
+    inserted_.insert(entry);
+  }
+  if (DeltaFull(inserted_.size() + removed_.size(), version_->entry_count_)) {
+    RebuildLocked();
+  }
+  latch_.WUnlock();
+  return DB_SUCCESS;
+}
+
+/*
+ * A unique index removes the entry of the key whatever its row id, like BPlusTreeIndex.
+ */
+void LearnedIndex::Remove(uint64_t key, const RowId &row_id) {
+  latch_.WLock();
+  auto iter = inserted_.lower_bound({key, std::numeric_limits<int64_t>::min()});
+  while (iter != inserted_.end() && iter->first == key) {
+    iter = unique_ || iter->second == row_id.Get() ? inserted_.erase(iter) : std::next(iter);
+  }
+  {
+    PageReader reader(*version_);
+    for (uint64_t pos = version_->LowerBound(key); pos < version_->entry_count_ && reader.KeyAt(pos) == key; pos++) {
+      RowId value = reader.ValueAt(pos);
+      if (unique_ || value == row_id) {
+        removed_.emplace(key, value.Get());
+      }
+    }
+  }
+  if (DeltaFull(inserted_.size() + removed_.size(), version_->entry_count_)) {
+    RebuildLocked();
+  }
+  latch_.WUnlock();
+}
+
+void LearnedIndex::LookupLocked(uint64_t key, std::vector<RowId> &result) {
+  PageReader reader(*version_);
+  for (uint64_t pos = version_->LowerBound(key); pos < version_->entry_count_ && reader.KeyAt(pos) == key; pos++) {
+    RowId value = reader.ValueAt(pos);
+    if (removed_.count({key, value.Get()}) == 0) {
+      result.emplace_back(value);
+    }
+  }
+  auto iter = inserted_.lower_bound({key, std::numeric_limits<int64_t>::min()});
+  for (; iter != inserted_.end() && iter->first == key; ++iter) {
+    result.emplace_back(iter->second);
+  }
+}
+
+dberr_t LearnedIndex::ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator) {
+  auto collect = [&result](std::unique_ptr<IndexScanIterator> iter) {
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.emplace_back(row_id);
+    }
+  };
+  if (compare_operator == "=") {
+    uint64_t index_key = RowToInt(key);
+    latch_.RLock();
+    LookupLocked(index_key, result);
+    latch_.RUnlock();
+  } else if (compare_operator == ">") {
+    collect(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    collect(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    collect(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    collect(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    collect(Scan(nullptr, false, &key, false, txn));
+    collect(Scan(&key, false, nullptr, false, txn));
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanIterator> LearnedIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                      bool upper_inclusive, Txn *txn) {
+  // the keys are integers, an excluded bound is the next one included
+  uint64_t low = 0;
+  uint64_t high = std::numeric_limits<uint64_t>::max();
+  bool empty = false;
+  if (lower != nullptr) {
+    low = BoundToInt(*lower, !lower_inclusive);
+    if (!lower_inclusive) {
+      empty |= low == std::numeric_limits<uint64_t>::max();
+      low++;
+    }
+  }
+  if (upper != nullptr) {
+    high = BoundToInt(*upper, upper_inclusive);
+    if (!upper_inclusive) {
+      empty |= high == 0;
+      high--;
+    }
+  }
+  return empty ? ScanRange(1, 0) : ScanRange(low, high);
+}
+
+std::unique_ptr<IndexScanIterator> LearnedIndex::ScanRange(uint64_t lower, uint64_t upper) {
+  std::vector<LearnedEntry> inserted;
+  std::set<LearnedEntry> removed;
+  latch_.RLock();
+  uint64_t position = version_->entry_count_;
+  if (lower <= upper) {
+    position = version_->LowerBound(lower);
+    inserted.assign(inserted_.lower_bound({lower, std::numeric_limits<int64_t>::min()}),
+                    inserted_.upper_bound({upper, std::numeric_limits<int64_t>::max()}));
+    removed.insert(removed_.lower_bound({lower, std::numeric_limits<int64_t>::min()}),
+                   removed_.upper_bound({upper, std::numeric_limits<int64_t>::max()}));
+  }
+  auto scan = std::make_unique<LearnedScanIterator>(processor_, version_, position, upper, std::move(inserted),
+                                                    std::move(removed));
+  latch_.RUnlock();
+  return scan;
+}
+
+/*
+ * The sorted entries of an empty index are written straight into the data pages, the model is fitted as they go.
+ */
+dberr_t LearnedIndex::BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector,
+                               Txn *txn) {
+  latch_.RLock();
+  bool empty = version_->entry_count_ == 0 && inserted_.empty();
+  latch_.RUnlock();
+  if (!empty) {
+    for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+      if (InsertRowEntry(*row, projector, row->GetRowId(), txn) != DB_SUCCESS) {
+        return DB_FAILED;
+      }
+    }
+    return DB_SUCCESS;
+  }
+  KeySorter sorter(processor_);
+  GenericKey *index_key = processor_.InitKey();
+  for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+    processor_.SerializeFromRow(index_key, *row, projector);
+    sorter.Add(index_key, row->GetRowId());
+  }
+  sorter.Sort();
+  bool duplicate = false;
+  bool first = true;
+  uint64_t last_key = 0;
+  auto version = Build([&](uint64_t *key, RowId *row_id) {
+    if (duplicate || !sorter.Next(index_key, row_id)) {
+      return false;
+    }
+    *key = KeyToInt(index_key);
+    duplicate = unique_ && !first && *key == last_key;
+    first = false;
+    last_key = *key;
+    return !duplicate;
+  });
+  free(index_key);
+  if (duplicate) {
+    // the pages written so far go with the build
+    version->obsolete_ = true;
+    return DB_FAILED;
+  }
+  latch_.WLock();
+  Install(version);
+  latch_.WUnlock();
+  return DB_SUCCESS;
+}
+
+/*
+ * Segments are fitted with a shrinking cone: the slopes from the first key of the segment that keep every key so far
+ * within LEARNED_INDEX_ERROR positions of its first entry. A key that leaves no such slope starts a new segment.
+ */
+std::shared_ptr<LearnedVersion> LearnedIndex::Build(const std::function<bool(uint64_t *, RowId *)> &next) {
+  auto version = std::make_shared<LearnedVersion>(buffer_pool_manager_);
+  auto &segments = version->segments_;
+  double slope_low = 0;
+  double slope_high = std::numeric_limits<double>::infinity();
+  auto close_segment = [&]() {
+    if (!segments.empty()) {
+      segments.back().slope_ = std::isinf(slope_high) ? 0 : (slope_low + slope_high) / 2;
+    }
+  };
+  LearnedDataPage *page = nullptr;
+  uint64_t key;
+  uint64_t last_key = 0;
+  RowId value;
+  while (next(&key, &value)) {
+    if (page == nullptr || page->IsFull()) {
+      page_id_t page_id;
+      Page *new_page = buffer_pool_manager_->NewPage(page_id);
+      if (new_page == nullptr) throw("Out of memory: Unable to allocate new learned index page.");
+      auto *next_page = reinterpret_cast<LearnedDataPage *>(new_page->GetData());
+      next_page->Init(page_id);
+      if (page != nullptr) {
+        page->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      }
+      page = next_page;
+      version->data_page_ids_.push_back(page_id);
+    }
+    page->Append(key, value);
+    uint64_t position = version->entry_count_++;
+    // only the first entry of a key is fitted
+    if (position > 0 && key == last_key) {
+      continue;
+    }
+    last_key = key;
+    if (!segments.empty()) {
+      double dx = static_cast<double>(key - segments.back().first_key_);
+      double dy = static_cast<double>(position - segments.back().first_position_);
+      double low = std::max(slope_low, (dy - LEARNED_INDEX_ERROR) / dx);
+      double high = std::min(slope_high, (dy + LEARNED_INDEX_ERROR) / dx);
+      if (low <= high) {
+        slope_low = low;
+        slope_high = high;
+        continue;
+      }
+      close_segment();
+    }
+    segments.push_back({key, position, 0});
+    slope_low = 0;
+    slope_high = std::numeric_limits<double>::infinity();
+  }
+  close_segment();
+  if (page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  return version;
+}
+
+void LearnedIndex::Install(std::shared_ptr<LearnedVersion> version) {
+  std::vector<char> bytes(version->GetModelSize());
+  size_t segment_bytes = version->segments_.size() * sizeof(LearnedSegment);
+  memcpy(bytes.data(), version->segments_.data(), segment_bytes);
+  memcpy(bytes.data() + segment_bytes, version->data_page_ids_.data(), bytes.size() - segment_bytes);
+  LearnedModelPage *page = nullptr;
+  for (size_t written = 0; written < bytes.size();) {
+    if (page == nullptr || page->GetSize() == LearnedModelPage::MAX_SIZE) {
+      page_id_t page_id;
+      Page *new_page = buffer_pool_manager_->NewPage(page_id);
+      if (new_page == nullptr) throw("Out of memory: Unable to allocate new learned index page.");
+      auto *next_page = reinterpret_cast<LearnedModelPage *>(new_page->GetData());
+      next_page->Init(page_id);
+      if (page != nullptr) {
+        page->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      }
+      page = next_page;
+      version->model_page_ids_.push_back(page_id);
+    }
+    written += page->Append(bytes.data() + written, bytes.size() - written);
+  }
+  if (page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  auto *meta = reinterpret_cast<LearnedMetaPage *>(buffer_pool_manager_->FetchPage(meta_page_id_)->GetData());
+  meta->Set(version->model_page_ids_.empty() ? INVALID_PAGE_ID : version->model_page_ids_[0],
+            version->segments_.size(), version->data_page_ids_.size(), version->entry_count_);
+  buffer_pool_manager_->UnpinPage(meta_page_id_, true);
+  if (version_ != nullptr) {
+    version_->obsolete_ = true;
+  }
+  version_ = std::move(version);
+}
+
+void LearnedIndex::Open() {
+  version_ = std::make_shared<LearnedVersion>(buffer_pool_manager_);
+  auto *meta = reinterpret_cast<LearnedMetaPage *>(buffer_pool_manager_->FetchPage(meta_page_id_)->GetData());
+  page_id_t page_id = meta->GetFirstModelPageId();
+  version_->segments_.resize(meta->GetSegmentCount());
+  version_->data_page_ids_.resize(meta->GetDataPageCount());
+  version_->entry_count_ = meta->GetEntryCount();
+  buffer_pool_manager_->UnpinPage(meta_page_id_, false);
+  std::vector<char> bytes;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = reinterpret_cast<LearnedModelPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    bytes.insert(bytes.end(), page->GetBytes(), page->GetBytes() + page->GetSize());
+    version_->model_page_ids_.push_back(page_id);
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  ASSERT(bytes.size() == version_->GetModelSize(), "Learned index model does not match its meta page.");
+  size_t segment_bytes = version_->segments_.size() * sizeof(LearnedSegment);
+  memcpy(version_->segments_.data(), bytes.data(), segment_bytes);
+  memcpy(version_->data_page_ids_.data(), bytes.data() + segment_bytes, bytes.size() - segment_bytes);
+}
+
+int LearnedIndex::Rebuild() {
+  latch_.WLock();
+  int pages_released = RebuildLocked();
+  latch_.WUnlock();
+  return pages_released;
+}
+
+/*
+ * The data pages are read in order and merged with the delta into new ones, the old build goes once its scans do.
+ */
+int LearnedIndex::RebuildLocked() {
+  std::shared_ptr<LearnedVersion> old = version_;
+  int old_pages = old->data_page_ids_.size() + old->model_page_ids_.size();
+  std::shared_ptr<LearnedVersion> version;
+  {
+    PageReader reader(*old);
+    uint64_t position = 0;
+    auto inserted = inserted_.begin();
+    version = Build([&](uint64_t *key, RowId *value) {
+      while (true) {
+        bool base = position < old->entry_count_;
+        if (!base && inserted == inserted_.end()) {
+          return false;
+        }
+        LearnedEntry entry;
+        if (base) {
+          entry = {reader.KeyAt(position), reader.ValueAt(position).Get()};
+        }
+        if (inserted != inserted_.end() && (!base || *inserted < entry)) {
+          entry = *inserted++;
+        } else {
+          position++;
+          if (removed_.count(entry) > 0) {
+            continue;
+          }
+        }
+        *key = entry.first;
+        *value = RowId(entry.second);
+        return true;
+      }
+    });
+  }
+  Install(version);
+  inserted_.clear();
+  removed_.clear();
+  rebuilds_++;
+  return old_pages - static_cast<int>(version_->data_page_ids_.size() + version_->model_page_ids_.size());
+}
+
+dberr_t LearnedIndex::Vacuum(int *pages_released, Txn *txn) {
+  *pages_released = Rebuild();
+  return DB_SUCCESS;
+}
+
+size_t LearnedIndex::GetSegmentCount() {
+  latch_.RLock();
+  size_t count = version_->segments_.size();
+  latch_.RUnlock();
+  return count;
+}
+
+size_t LearnedIndex::GetModelSize() {
+  latch_.RLock();
+  size_t size = version_->GetModelSize();
+  latch_.RUnlock();
+  return size;
+}
+
+size_t LearnedIndex::GetDeltaSize() {
+  latch_.RLock();
+  size_t size = inserted_.size() + removed_.size();
+  latch_.RUnlock();
+  return size;
+}
+
+dberr_t LearnedIndex::Destroy() {
+  latch_.WLock();
+  version_->obsolete_ = true;
+  version_ = std::make_shared<LearnedVersion>(buffer_pool_manager_);
+  inserted_.clear();
+  removed_.clear();
+  auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  header_page->WLatch();
+  reinterpret_cast<IndexRootsPage *>(header_page->GetData())->Delete(index_id_);
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  buffer_pool_manager_->DeletePage(meta_page_id_);
+  destroyed_ = true;
+  latch_.WUnlock();
+  return DB_SUCCESS;
+}
@@ -0,0 +1,185 @@
+#include "index/lsm_index.h"
+
+#include "index/key_sorter.h"
+
+LsmIndex::LsmIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                   BufferPoolManager *buffer_pool_manager, bool unique, uint32_t memtable_size)
+    : Index(index_id, key_schema),
+      processor_(key_schema_, key_size, !unique),
+      container_(index_id, buffer_pool_manager, processor_, memtable_size) {}
+
+dberr_t LsmIndex::InsertEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  // a key with its row id can not be there yet
+  bool status = container_.Insert(index_key, row_id, !processor_.HasRowIdSuffix());
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t LsmIndex::RemoveEntry(const Row &key, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  container_.Remove(index_key);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t LsmIndex::InsertRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  bool status = container_.Insert(index_key, row_id, !processor_.HasRowIdSuffix());
+  free(index_key);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t LsmIndex::RemoveRowEntry(const Row &row, const KeyProjector &projector, RowId row_id, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  if (processor_.HasRowIdSuffix()) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  container_.Remove(index_key);
+  free(index_key);
+  return DB_SUCCESS;
+}
+
+dberr_t LsmIndex::ScanRowKey(const Row &row, const KeyProjector &projector, std::vector<RowId> &result, Txn *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromRow(index_key, row, projector);
+  LookupKey(index_key, result);
+  free(index_key);
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+void LsmIndex::LookupKey(GenericKey *index_key, std::vector<RowId> &result) {
+  if (!processor_.HasRowIdSuffix()) {
+    RowId row_id;
+    if (container_.GetValue(index_key, &row_id)) {
+      result.emplace_back(row_id);
+    }
+    return;
+  }
+  // the entries of the key lie between the smallest and the greatest row id suffix
+  std::vector<char> upper(processor_.GetKeySize());
+  memcpy(upper.data(), index_key, processor_.GetKeySize());
+  processor_.SetRowIdBound(index_key, false);
+  processor_.SetRowIdBound(reinterpret_cast<GenericKey *>(upper.data()), true);
+  LsmScanIterator scan(processor_,
+                       container_.Scan(index_key, true, reinterpret_cast<GenericKey *>(upper.data()), true));
+  RowId row_id;
+  while (scan.Next(&row_id)) {
+    result.emplace_back(row_id);
+  }
+}
+
+/*
+ * The sorted entries of an empty index are written as a single run, without going through the memtable.
+ */
+dberr_t LsmIndex::BulkLoad(const std::function<const Row *()> &next_row, const KeyProjector &projector, Txn *txn) {
+  if (!container_.IsEmpty()) {
+    for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+      if (InsertRowEntry(*row, projector, row->GetRowId(), txn) != DB_SUCCESS) {
+        return DB_FAILED;
+      }
+    }
+    return DB_SUCCESS;
+  }
+  KeySorter sorter(processor_);
+  GenericKey *index_key = processor_.InitKey();
+  for (const Row *row = next_row(); row != nullptr; row = next_row()) {
+    processor_.SerializeFromRow(index_key, *row, projector);
+    if (processor_.HasRowIdSuffix()) {
+      processor_.SetRowId(index_key, row->GetRowId());
+    }
+    sorter.Add(index_key, row->GetRowId());
+  }
+  free(index_key);
+  sorter.Sort();
+  bool status = container_.BulkLoad(sorter.GetSize(),
+                                    [&sorter](GenericKey *key, RowId *row_id) { return sorter.Next(key, row_id); });
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t LsmIndex::ScanKey(const Row &key, std::vector<RowId> &result, Txn *txn, string compare_operator) {
+  auto collect = [&result](std::unique_ptr<IndexScanIterator> iter) {
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.emplace_back(row_id);
+    }
+  };
+  if (compare_operator == "=") {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeFromKey(index_key, key, key_schema_);
+    LookupKey(index_key, result);
+    free(index_key);
+  } else if (compare_operator == ">") {
+    collect(Scan(&key, false, nullptr, false, txn));
+  } else if (compare_operator == ">=") {
+    collect(Scan(&key, true, nullptr, false, txn));
+  } else if (compare_operator == "<") {
+    collect(Scan(nullptr, false, &key, false, txn));
+  } else if (compare_operator == "<=") {
+    collect(Scan(nullptr, false, &key, true, txn));
+  } else if (compare_operator == "<>") {
+    collect(Scan(nullptr, false, &key, false, txn));
+    collect(Scan(&key, false, nullptr, false, txn));
+  }
+  return result.empty() ? DB_KEY_NOT_FOUND : DB_SUCCESS;
+}
+
+std::unique_ptr<IndexScanIterator> LsmIndex::Scan(const Row *lower, bool lower_inclusive, const Row *upper,
+                                                  bool upper_inclusive, Txn *txn) {
+  GenericKey *lower_key = nullptr;
+  GenericKey *upper_key = nullptr;
+  if (lower != nullptr) {
+    lower_key = processor_.InitKey();
+    processor_.SerializeFromPrefix(lower_key, *lower, !lower_inclusive);
+    if (processor_.HasRowIdSuffix()) {
+      // before the first entry of lower, or after the last one
+      processor_.SetRowIdBound(lower_key, !lower_inclusive);
+    }
+  }
+  if (upper != nullptr) {
+    upper_key = processor_.InitKey();
+    processor_.SerializeFromPrefix(upper_key, *upper, upper_inclusive);
+    if (processor_.HasRowIdSuffix()) {
+      processor_.SetRowIdBound(upper_key, upper_inclusive);
+    }
+  }
+  auto scan = std::make_unique<LsmScanIterator>(
+      processor_, container_.Scan(lower_key, lower_inclusive, upper_key, upper_inclusive));
+  free(lower_key);
+  free(upper_key);
+  return scan;
+}
+
+dberr_t LsmIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
+
+LsmScanIterator::LsmScanIterator(const KeyManager &key_manager, std::unique_ptr<LsmTreeIterator> iterator)
+    : key_manager_(key_manager), iterator_(std::move(iterator)) {}
+
+bool LsmScanIterator::Next(RowId *row_id) { return NextEntry(row_id, nullptr); }
+
+bool LsmScanIterator::NextEntry(RowId *row_id, Row *key) {
+  const GenericKey *entry_key;
+  if (!iterator_->Next(&entry_key, row_id)) {
+    return false;
+  }
+  if (key != nullptr) {
+    key_manager_.DeserializeToKey(entry_key, *key, nullptr);
+  }
+  return true;
+}
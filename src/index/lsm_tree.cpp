@@ -0,0 +1,543 @@
+#include "index/lsm_tree.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "page/index_roots_page.h"
+
+// a removed key is an entry without row id
+static bool IsTombstone(const RowId &value) { return value == INVALID_ROWID; }
+
+/*****************************************************************************
+ * RUN
+ *****************************************************************************/
+LsmRun::~LsmRun() {
+  if (!obsolete_) {
+    return;
+  }
+  for (auto page_id : page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+size_t LsmRun::FindPage(const GenericKey *key, const KeyManager &KM) const {
+  // first page whose fence is greater than key, the one before it may hold key
+  size_t low = 0;
+  size_t high = page_ids_.size();
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (KM.CompareKeys(FenceAt(mid), key) <= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low == 0 ? 0 : low - 1;
+}
+
+/*****************************************************************************
+ * ITERATOR
+ *****************************************************************************/
+LsmTreeIterator::LsmTreeIterator(const KeyManager &key_manager, std::vector<char> memtable_keys,
+                                 std::vector<RowId> memtable_values, std::vector<std::shared_ptr<LsmRun>> runs,
+                                 const GenericKey *lower, bool lower_inclusive, const GenericKey *upper,
+                                 bool upper_inclusive, bool skip_tombstones)
+    : key_manager_(key_manager),
+      key_(key_manager.GetKeySize()),
+      lower_inclusive_(lower_inclusive),
+      upper_inclusive_(upper_inclusive),
+      skip_tombstones_(skip_tombstones) {
+  int key_size = key_manager_.GetKeySize();
+  if (lower != nullptr) {
+    lower_.assign(reinterpret_cast<const char *>(lower), reinterpret_cast<const char *>(lower) + key_size);
+  }
+  if (upper != nullptr) {
+    upper_.assign(reinterpret_cast<const char *>(upper), reinterpret_cast<const char *>(upper) + key_size);
+  }
+  Source memtable;
+  memtable.keys_ = std::move(memtable_keys);
+  memtable.values_ = std::move(memtable_values);
+  sources_.push_back(std::move(memtable));
+  for (auto &run : runs) {
+    Source source;
+    source.page_ = lower == nullptr ? 0 : run->FindPage(lower, key_manager_);
+    source.run_ = std::move(run);
+    ReadPage(source);
+    if (lower != nullptr) {
+      // first key of the page not less than lower
+      size_t low = 0;
+      size_t high = source.values_.size();
+      while (low < high) {
+        source.pos_ = (low + high) / 2;
+        if (key_manager_.CompareKeys(KeyOf(source), lower) < 0) {
+          low = source.pos_ + 1;
+        } else {
+          high = source.pos_;
+        }
+      }
+      source.pos_ = low;
+    }
+    sources_.push_back(std::move(source));
+  }
+}
+
+void LsmTreeIterator::ReadPage(Source &source) {
+  int key_size = key_manager_.GetKeySize();
+  page_id_t page_id = source.run_->page_ids_[source.page_];
+  auto *page = reinterpret_cast<LsmRunPage *>(source.run_->buffer_pool_manager_->FetchPage(page_id)->GetData());
+  source.keys_.resize(page->GetSize() * key_size);
+  source.values_.resize(page->GetSize());
+  for (int i = 0; i < page->GetSize(); i++) {
+    memcpy(source.keys_.data() + i * key_size, page->KeyAt(i), key_size);
+    source.values_[i] = page->ValueAt(i);
+  }
+  source.run_->buffer_pool_manager_->UnpinPage(page_id, false);
+  source.pos_ = 0;
+}
+
+bool LsmTreeIterator::Valid(Source &source) {
+  while (source.pos_ == source.values_.size()) {
+    if (source.run_ == nullptr || source.page_ + 1 >= source.run_->page_ids_.size()) {
+      return false;
+    }
+    source.page_++;
+    ReadPage(source);
+  }
+  return true;
+}
+
+bool LsmTreeIterator::Next(const GenericKey **key, RowId *value) {
+  auto *next_key = reinterpret_cast<GenericKey *>(key_.data());
+  while (true) {
+    // the smallest key, of the newest source that has it
+    Source *best = nullptr;
+    for (auto &source : sources_) {
+      if (Valid(source) && (best == nullptr || key_manager_.CompareKeys(KeyOf(source), KeyOf(*best)) < 0)) {
+        best = &source;
+      }
+    }
+    if (best == nullptr) {
+      return false;
+    }
+    memcpy(next_key, KeyOf(*best), key_.size());
+    *value = best->values_[best->pos_];
+    // the older entries of the key are hidden
+    for (auto &source : sources_) {
+      if (Valid(source) && key_manager_.CompareKeys(KeyOf(source), next_key) == 0) {
+        source.pos_++;
+      }
+    }
+    if (!upper_.empty()) {
+      int cmp = key_manager_.CompareKeys(next_key, reinterpret_cast<const GenericKey *>(upper_.data()));
+      if (cmp > 0 || (cmp == 0 && !upper_inclusive_)) {
+        sources_.clear();
+        return false;
+      }
+    }
+    if (!lower_inclusive_ && !lower_.empty() &&
+        key_manager_.CompareKeys(next_key, reinterpret_cast<const GenericKey *>(lower_.data())) == 0) {
+      continue;
+    }
+    if (skip_tombstones_ && IsTombstone(*value)) {
+      continue;
+    }
+    *key = next_key;
+    return true;
+  }
+}
+
+/*****************************************************************************
+ * TREE
+ *****************************************************************************/
+LsmTree::LsmTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
+                 uint32_t memtable_size)
+    : index_id_(index_id), buffer_pool_manager_(buffer_pool_manager), processor_(KM), memtable_size_(memtable_size) {
+  auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  header_page->WLatch();
+  auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(header_page->GetData());
+  bool is_new = !index_roots_page->GetRootId(index_id_, &manifest_page_id_);
+  if (is_new) {
+    auto *manifest_page = buffer_pool_manager_->NewPage(manifest_page_id_);
+    ASSERT(manifest_page != nullptr, "Out of memory for a new LSM tree.");
+    reinterpret_cast<LsmManifestPage *>(manifest_page->GetData())->Init(manifest_page_id_);
+    buffer_pool_manager_->UnpinPage(manifest_page_id_, true);
+    index_roots_page->Insert(index_id_, manifest_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, is_new);
+  if (!is_new) {
+    auto *manifest = reinterpret_cast<LsmManifestPage *>(buffer_pool_manager_->FetchPage(manifest_page_id_)->GetData());
+    for (uint32_t i = 0; i < manifest->GetRunCount(); i++) {
+      runs_.push_back(OpenRun(manifest->GetFirstPageId(i), manifest->GetEntryCount(i)));
+    }
+    buffer_pool_manager_->UnpinPage(manifest_page_id_, false);
+  }
+  compactor_ = std::thread(&LsmTree::CompactionLoop, this);
+}
+
+LsmTree::~LsmTree() {
+  StopCompaction();
+  if (!destroyed_) {
+    Flush();
+  }
+}
+
+bool LsmTree::Insert(const GenericKey *key, const RowId &value, bool check) {
+  latch_.WLock();
+  RowId old_value;
+  if (check && LookupLocked(key, &old_value)) {
+    latch_.WUnlock();
+    return false;
+  }
+  memtable_[std::string(reinterpret_cast<const char *>(key), processor_.GetKeySize())] = value;
+  if (memtable_.size() * (processor_.GetKeySize() + sizeof(RowId)) >= memtable_size_) {
+    FlushLocked();
+  }
+  latch_.WUnlock();
+  return true;
+}
+
+void LsmTree::Remove(const GenericKey *key) {
+  latch_.WLock();
+  std::string memtable_key(reinterpret_cast<const char *>(key), processor_.GetKeySize());
+  if (runs_.empty()) {
+    // no older entry to hide
+    memtable_.erase(memtable_key);
+  } else {
+    memtable_[memtable_key] = INVALID_ROWID;
+    if (memtable_.size() * (processor_.GetKeySize() + sizeof(RowId)) >= memtable_size_) {
+      FlushLocked();
+    }
+  }
+  latch_.WUnlock();
+}
+
+bool LsmTree::IsEmpty() {
+  latch_.RLock();
+  bool empty = memtable_.empty() && runs_.empty();
+  latch_.RUnlock();
+  return empty;
+}
+
+bool LsmTree::GetValue(const GenericKey *key, RowId *value) {
+  latch_.RLock();
+  bool found = LookupLocked(key, value);
+  latch_.RUnlock();
+  return found;
+}
+
+bool LsmTree::LookupLocked(const GenericKey *key, RowId *value) {
+  auto iter = memtable_.find(std::string(reinterpret_cast<const char *>(key), processor_.GetKeySize()));
+  if (iter != memtable_.end()) {
+    *value = iter->second;
+    return !IsTombstone(*value);
+  }
+  uint64_t hash = processor_.HashKeyColumns(key);
+  for (auto &run : runs_) {
+    if (LookupRun(*run, key, hash, value)) {
+      return !IsTombstone(*value);
+    }
+  }
+  return false;
+}
+
+bool LsmTree::LookupRun(const LsmRun &run, const GenericKey *key, uint64_t hash, RowId *value) {
+  if (run.filter_ != nullptr && !run.filter_->MayContain(hash)) {
+    return false;
+  }
+  page_id_t page_id = run.page_ids_[run.FindPage(key, processor_)];
+  auto *page = reinterpret_cast<LsmRunPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  int index = page->KeyIndex(key, processor_);
+  bool found = index < page->GetSize() && processor_.CompareKeys(page->KeyAt(index), key) == 0;
+  if (found) {
+    *value = page->ValueAt(index);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return found;
+}
+
+std::unique_ptr<LsmTreeIterator> LsmTree::Scan(const GenericKey *lower, bool lower_inclusive,
+                                               const GenericKey *upper, bool upper_inclusive) {
+  int key_size = processor_.GetKeySize();
+  std::vector<char> keys;
+  std::vector<RowId> values;
+  std::vector<std::shared_ptr<LsmRun>> runs;
+  latch_.RLock();
+  auto iter = memtable_.begin();
+  if (lower != nullptr) {
+    iter = memtable_.lower_bound(std::string(reinterpret_cast<const char *>(lower), key_size));
+  }
+  auto end = memtable_.end();
+  if (upper != nullptr) {
+    end = memtable_.upper_bound(std::string(reinterpret_cast<const char *>(upper), key_size));
+  }
+  for (; iter != end; ++iter) {
+    keys.insert(keys.end(), iter->first.begin(), iter->first.end());
+    values.push_back(iter->second);
+  }
+  bool point = lower != nullptr && upper != nullptr && processor_.CompareKeyColumns(lower, upper) == 0;
+  uint64_t hash = point ? processor_.HashKeyColumns(lower) : 0;
+  for (auto &run : runs_) {
+    if (!point || run->filter_ == nullptr || run->filter_->MayContain(hash)) {
+      runs.push_back(run);
+    }
+  }
+  latch_.RUnlock();
+  return std::make_unique<LsmTreeIterator>(processor_, std::move(keys), std::move(values), std::move(runs), lower,
+                                           lower_inclusive, upper, upper_inclusive);
+}
+
+bool LsmTree::BulkLoad(uint64_t count, const std::function<bool(GenericKey *, RowId *)> &next) {
+  latch_.WLock();
+  if (!memtable_.empty() || !runs_.empty()) {
+    latch_.WUnlock();
+    return false;
+  }
+  std::vector<char> last_key(processor_.GetKeySize());
+  uint64_t read = 0;
+  bool ok = true;
+  auto run = WriteRun(count, [&](GenericKey *key, RowId *value) {
+    if (read == count) {
+      return false;
+    }
+    // strictly increasing
+    ok = next(key, value) &&
+         (read == 0 || processor_.CompareKeys(reinterpret_cast<GenericKey *>(last_key.data()), key) < 0);
+    if (!ok) {
+      return false;
+    }
+    memcpy(last_key.data(), key, last_key.size());
+    read++;
+    return true;
+  });
+  if (!ok) {
+    if (run != nullptr) {
+      run->obsolete_ = true;
+    }
+    latch_.WUnlock();
+    return false;
+  }
+  if (run != nullptr) {
+    runs_.push_back(run);
+    WriteManifest();
+  }
+  latch_.WUnlock();
+  return true;
+}
+
+void LsmTree::Flush() {
+  latch_.WLock();
+  FlushLocked();
+  latch_.WUnlock();
+}
+
+void LsmTree::FlushLocked() {
+  if (memtable_.empty()) {
+    return;
+  }
+  auto iter = memtable_.begin();
+  auto run = WriteRun(memtable_.size(), [&](GenericKey *key, RowId *value) {
+    if (iter == memtable_.end()) {
+      return false;
+    }
+    memcpy(key, iter->first.data(), iter->first.size());
+    *value = iter->second;
+    ++iter;
+    return true;
+  });
+  memtable_.clear();
+  if (run != nullptr) {
+    runs_.insert(runs_.begin(), run);
+  }
+  flushes_++;
+  WriteManifest();
+  {
+    std::lock_guard<std::mutex> lock(compaction_mutex_);
+    compaction_pending_ = true;
+  }
+  compaction_cv_.notify_all();
+}
+
+void LsmTree::WriteManifest() {
+  auto *manifest = reinterpret_cast<LsmManifestPage *>(buffer_pool_manager_->FetchPage(manifest_page_id_)->GetData());
+  manifest->Clear();
+  for (auto &run : runs_) {
+    if (!manifest->Append(run->page_ids_[0], run->entry_count_)) {
+      LOG(ERROR) << "Too many runs in LSM tree " << index_id_;
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(manifest_page_id_, true);
+}
+
+/*
+ * The pages of a run are allocated one after another as they fill up, each is written once.
+ */
+std::shared_ptr<LsmRun> LsmTree::WriteRun(uint64_t capacity, const std::function<bool(GenericKey *, RowId *)> &next) {
+  int key_size = processor_.GetKeySize();
+  auto run = std::make_shared<LsmRun>(buffer_pool_manager_, key_size);
+  if (INDEX_BLOOM_BITS_PER_KEY > 0) {
+    run->filter_ = std::make_unique<BloomFilter>(std::max<uint64_t>(capacity, 1), INDEX_BLOOM_BITS_PER_KEY);
+  }
+  std::vector<char> key_buffer(key_size);
+  auto *key = reinterpret_cast<GenericKey *>(key_buffer.data());
+  RowId value;
+  LsmRunPage *page = nullptr;
+  while (next(key, &value)) {
+    if (page == nullptr || page->IsFull()) {
+      page_id_t page_id;
+      Page *new_page = buffer_pool_manager_->NewPage(page_id);
+      if (new_page == nullptr) throw("Out of memory: Unable to allocate new LSM run page.");
+      auto *next_page = reinterpret_cast<LsmRunPage *>(new_page->GetData());
+      next_page->Init(page_id, key_size);
+      if (page != nullptr) {
+        page->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      }
+      page = next_page;
+      run->page_ids_.push_back(page_id);
+      run->fences_.insert(run->fences_.end(), key_buffer.begin(), key_buffer.end());
+    }
+    page->Append(key, value);
+    run->entry_count_++;
+    if (run->filter_ != nullptr) {
+      run->filter_->Add(processor_.HashKeyColumns(key));
+    }
+  }
+  if (page == nullptr) {
+    return nullptr;
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  return run;
+}
+
+std::shared_ptr<LsmRun> LsmTree::OpenRun(page_id_t first_page_id, uint32_t entry_count) {
+  int key_size = processor_.GetKeySize();
+  auto run = std::make_shared<LsmRun>(buffer_pool_manager_, key_size);
+  if (INDEX_BLOOM_BITS_PER_KEY > 0) {
+    run->filter_ = std::make_unique<BloomFilter>(std::max<uint32_t>(entry_count, 1), INDEX_BLOOM_BITS_PER_KEY);
+  }
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *page = reinterpret_cast<LsmRunPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    run->page_ids_.push_back(page_id);
+    auto *fence = reinterpret_cast<const char *>(page->KeyAt(0));
+    run->fences_.insert(run->fences_.end(), fence, fence + key_size);
+    for (int i = 0; i < page->GetSize(); i++) {
+      if (run->filter_ != nullptr) {
+        run->filter_->Add(processor_.HashKeyColumns(page->KeyAt(i)));
+      }
+    }
+    run->entry_count_ += page->GetSize();
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return run;
+}
+
+size_t LsmTree::GetRunCount() {
+  latch_.RLock();
+  size_t count = runs_.size();
+  latch_.RUnlock();
+  return count;
+}
+
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+void LsmTree::CompactionLoop() {
+  std::unique_lock<std::mutex> lock(compaction_mutex_);
+  while (true) {
+    compaction_cv_.wait(lock, [this] { return stop_ || compaction_pending_; });
+    if (stop_) {
+      break;
+    }
+    compaction_pending_ = false;
+    compacting_ = true;
+    lock.unlock();
+    while (!stop_ && CompactOnce()) {
+    }
+    lock.lock();
+    compacting_ = false;
+    compaction_cv_.notify_all();
+  }
+}
+
+/*
+ * Only this thread merges runs and a flush only puts a run in front, so the two runs merged stay next to each other
+ * and the older one stays the oldest while they are merged without the latch.
+ */
+bool LsmTree::CompactOnce() {
+  latch_.RLock();
+  std::vector<std::shared_ptr<LsmRun>> runs = runs_;
+  latch_.RUnlock();
+  size_t i = 0;
+  while (i + 1 < runs.size() && runs[i + 1]->entry_count_ >= LSM_GROWTH_FACTOR * runs[i]->entry_count_) {
+    i++;
+  }
+  if (i + 1 >= runs.size()) {
+    return false;
+  }
+  std::shared_ptr<LsmRun> newer = runs[i];
+  std::shared_ptr<LsmRun> older = runs[i + 1];
+  // tombstones have nothing left to hide once merged into the oldest run
+  bool into_oldest = i + 2 == runs.size();
+  runs.clear();
+  LsmTreeIterator iter(processor_, {}, {}, {newer, older}, nullptr, false, nullptr, false, into_oldest);
+  auto merged = WriteRun(newer->entry_count_ + older->entry_count_, [&iter, this](GenericKey *key, RowId *value) {
+    const GenericKey *next_key;
+    if (!iter.Next(&next_key, value)) {
+      return false;
+    }
+    memcpy(key, next_key, processor_.GetKeySize());
+    return true;
+  });
+
+  latch_.WLock();
+  auto pos = std::find(runs_.begin(), runs_.end(), newer);
+  pos = runs_.erase(pos, pos + 2);
+  if (merged != nullptr) {
+    runs_.insert(pos, merged);
+  }
+  WriteManifest();
+  latch_.WUnlock();
+  newer->obsolete_ = true;
+  older->obsolete_ = true;
+  compactions_++;
+  return true;
+}
+
+void LsmTree::WaitForCompaction() {
+  std::unique_lock<std::mutex> lock(compaction_mutex_);
+  compaction_cv_.wait(lock, [this] { return stop_ || (!compaction_pending_ && !compacting_); });
+}
+
+void LsmTree::StopCompaction() {
+  {
+    std::lock_guard<std::mutex> lock(compaction_mutex_);
+    stop_ = true;
+  }
+  compaction_cv_.notify_all();
+  if (compactor_.joinable()) {
+    compactor_.join();
+  }
+}
+
+void LsmTree::Destroy() {
+  StopCompaction();
+  latch_.WLock();
+  for (auto &run : runs_) {
+    run->obsolete_ = true;
+  }
+  runs_.clear();
+  memtable_.clear();
+  auto *header_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  header_page->WLatch();
+  reinterpret_cast<IndexRootsPage *>(header_page->GetData())->Delete(index_id_);
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  buffer_pool_manager_->DeletePage(manifest_page_id_);
+  destroyed_ = true;
+  latch_.WUnlock();
+}
@@ -0,0 +1,58 @@
+#include "index/skip_scan_iterator.h"
+
+SkipScanIterator::SkipScanIterator(Index *index, std::vector<Field> lower, bool lower_inclusive,
+                                   std::vector<Field> upper, bool upper_inclusive)
+    : index_(index),
+      lower_(std::move(lower)),
+      lower_inclusive_(lower_inclusive),
+      upper_(std::move(upper)),
+      upper_inclusive_(upper_inclusive) {}
+
+bool SkipScanIterator::Next(RowId *row_id) { return NextEntry(row_id, nullptr); }
+
+bool SkipScanIterator::NextEntry(RowId *row_id, Row *key) {
+  while (!done_) {
+    if (range_ != nullptr && range_->NextEntry(row_id, key)) {
+      return true;
+    }
+    done_ = !NextValue();
+  }
+  return false;
+}
+
+/*
+ * The first entry after every key starting with the current value holds the next value, a bound of the first key
+ * column only stands for all of them.
+ */
+bool SkipScanIterator::NextValue() {
+  std::optional<Row> after;
+  if (value_) {
+    after.emplace(std::vector<Field>{*value_});
+  }
+  auto probe = index_->Scan(after ? &*after : nullptr, false, nullptr, false, nullptr);
+  RowId row_id;
+  Row key;
+  if (!probe->NextEntry(&row_id, &key)) {
+    range_.reset();
+    return false;
+  }
+  value_.emplace(*key.GetField(0));
+  values_++;
+  std::vector<Field> lower{*value_};
+  lower.insert(lower.end(), lower_.begin(), lower_.end());
+  std::vector<Field> upper{*value_};
+  upper.insert(upper.end(), upper_.begin(), upper_.end());
+  Row lower_key(std::move(lower));
+  Row upper_key(std::move(upper));
+  // a bound of the first column alone takes in every key under the value
+  range_ = index_->Scan(&lower_key, lower_.empty() || lower_inclusive_, &upper_key, upper_.empty() || upper_inclusive_,
+                        nullptr);
+  return true;
+}
+
+size_t SkipScanIterator::CountValues(Index *index, size_t limit) {
+  SkipScanIterator probe(index, {}, true, {}, true);
+  while (probe.GetValueCount() <= limit && probe.NextValue()) {
+  }
+  return probe.GetValueCount();
+}
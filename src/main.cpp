@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <string>
 
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
@@ -19,23 +20,33 @@ void InitGoogleLog(char *argv) {
   // LOG(INFO) << "glog started!";
 }
 
-void InputCommand(char *input, const int len) {
-  memset(input, 0, len);
+/**
+ * Read a statement up to its ';' into input.
+ * @return false if the statement is longer than max_len, the rest of it is read and dropped then
+ */
+bool InputCommand(std::string &input, const size_t max_len) {
+  input.clear();
   printf("minisql > ");
-  int i = 0;
+  bool fits = true;
   char ch;
   while ((ch = getchar()) != ';') {
-    input[i++] = ch;
+    if (input.size() < max_len) {
+      input.push_back(ch);
+    } else {
+      fits = false;
+    }
   }
-  input[i] = ch;  // ;
-  getchar();      // remove enter
+  input.push_back(ch);  // ;
+  getchar();            // remove enter
+  return fits;
 }
 
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
   // command buffer
-  const int buf_size = 1024;
-  char cmd[buf_size];
+  // long enough for a statement carrying a char value of the maximum length
+  const size_t max_len = VARCHAR_MAX_LEN + 1024;
+  std::string cmd;
   // executor engine
   ExecuteEngine engine;
   // for print syntax tree
@@ -44,9 +55,13 @@ int main(int argc, char **argv) {
 
   while (1) {
     // read from buffer
-    InputCommand(cmd, buf_size);
+    if (!InputCommand(cmd, max_len)) {
+      // a cut statement could still parse, with its values cut as well
+      printf("Statement too long, at most %zu characters.\n", max_len);
+      continue;
+    }
     // create buffer for sql input
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
+    YY_BUFFER_STATE bp = yy_scan_string(cmd.c_str());
     if (bp == nullptr) {
       LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
       exit(1);
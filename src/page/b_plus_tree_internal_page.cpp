@@ -1,15 +1,9 @@
 #include "page/b_plus_tree_internal_page.h"
 
-#include "index/generic_key.h"
+#include <algorithm>
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(page_id_t))
-#define key_off 0
-#define val_off GetKeySize()
+#include "index/generic_key.h"
 
-/**
- * TODO: Student Implement
- */
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
@@ -19,37 +13,30 @@
  * set parent id and set max page size
  */
 void InternalPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
-  SetPageType(IndexPageType::INTERNAL_PAGE);
-  SetKeySize(key_size);
-  SetSize(0);
-  SetMaxSize(max_size);
-  SetParentPageId(parent_id);
-  SetPageId(page_id);
-
-  // ?? maybe_unused
-  // Initialize the first key as invalid
-  // GenericKey *dummy_key = KeyAt(0);
-  // memset(dummy_key, 0, GetKeySize());
+  InitPage(IndexPageType::INTERNAL_PAGE, page_id, parent_id, key_size, max_size);
 }
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *InternalPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
-}
+void InternalPage::KeyAt(int index, GenericKey *key) const { ReadKey(index, key); }
 
-void InternalPage::SetKeyAt(int index, GenericKey *key) {
-  memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+bool InternalPage::SetKeyAt(int index, const GenericKey *key) {
+  if (!CanReplaceKey(index, key)) {
+    return false;
+  }
+  ReplaceKey(index, key);
+  return true;
 }
 
 page_id_t InternalPage::ValueAt(int index) const {
-  return *reinterpret_cast<const page_id_t *>(pairs_off + index * pair_size + val_off);
+  page_id_t value;
+  memcpy(&value, ValuePtrAt(index), sizeof(page_id_t));
+  return value;
 }
 
-void InternalPage::SetValueAt(int index, page_id_t value) {
-  *reinterpret_cast<page_id_t *>(pairs_off + index * pair_size + val_off) = value;
-}
+void InternalPage::SetValueAt(int index, page_id_t value) { memcpy(ValuePtrAt(index), &value, sizeof(page_id_t)); }
 
 int InternalPage::ValueIndex(const page_id_t &value) const {
   for (int i = 0; i < GetSize(); ++i) {
@@ -58,34 +45,18 @@ int InternalPage::ValueIndex(const page_id_t &value) const {
   return -1;
 }
 
-void *InternalPage::PairPtrAt(int index) { return KeyAt(index); }
-
-void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
-}
 /*****************************************************************************
  * LOOKUP
  *****************************************************************************/
 /*
  * Find and return the child pointer(page_id) which points to the child page
  * that contains input "key"
- * Start the search from the second key(the first key should always be invalid)
+ * Start the search from the second key(the first key is the lower fence)
  * 用了二分查找
  */
-page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
+page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &) const {
   if (GetSize() == 0) return INVALID_PAGE_ID;
-
-  int left = 1;
-  int right = GetSize();
-  while (left < right) {
-    int mid = (left + right) / 2;
-    if (KM.CompareKeys(key, KeyAt(mid)) >= 0) {
-      left = mid + 1;
-    } else {
-      right = mid;
-    }
-  }
-  return ValueAt(left - 1);
+  return ValueAt(UpperBound(key, 1) - 1);
 }
 
 /*****************************************************************************
@@ -98,74 +69,85 @@ page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
  * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
  */
 void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
-  SetSize(2);                // New root will have two entries
-  SetValueAt(0, old_value);  // Set the old value at index 0
-  SetKeyAt(1, new_key);      // Set the new key at index 1
-  SetValueAt(1, new_value);  // Set the new value at index 1
+  InsertEntry(0, nullptr, &old_value);
+  InsertEntry(1, new_key, &new_value);
 }
 
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
- *
- * Set old_value as `INVALID_PAGE_ID` when inserting the new key-value pair at the beginning
+ * NOTE: the page must not overflow before the insertion, it always has room for one more entry then
  * @return:  new size after insertion
  */
 int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
-  int index = ValueIndex(old_value);
-  // Shift elements to the right to make space for the new key-value pair
-  PairCopy(PairPtrAt(index + 2), PairPtrAt(index + 1), GetSize() - index - 1);
-
-  // Insert the new key-value pair
-  if (index == -1)
-    SetKeyAt(1, new_key);  // Insert at the beginning if old_value is not found
-  else
-    SetKeyAt(index + 1, new_key);
-  SetValueAt(index + 1, new_value);
-  IncreaseSize(1);  // Increase the size of the internal page
-
+  bool inserted = InsertEntry(ValueIndex(old_value) + 1, new_key, &new_value);
+  ASSERT(inserted, "Insert into an overflowed internal page.");
+  (void)inserted;
   return GetSize();
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
-
-// NOTE: All move and copy methods of split add new key & value pairs to the end of the page
-
- /*
- * Remove half of key & value pairs from this page to "recipient" page
- * buffer_pool_manager 是干嘛的？传给CopyNFrom()用于Fetch数据页
+/*
+ * Remove half of key & value pairs (by bytes) from this page to "recipient" page
+ * The first moved key is not stored in recipient, it becomes the fence between both pages and is pushed up to the
+ * parent.
  */
 void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  int half_size = (size + 1) / 2;  // Calculate the half size, rounding up
-  recipient->CopyNFrom(PairPtrAt(half_size), GetSize() - half_size, buffer_pool_manager);
-  SetSize(half_size);  // Update the size of the current page
+  EntryList list(GetKeySize(), sizeof(page_id_t));
+  DecodeEntries(0, GetSize(), &list);
+  int half_size = MiddleOf(list);
+  std::vector<char> keys(GetKeySize() * 2);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  GetLowerFence(lower);
+  bool has_upper = HasUpperFence();
+  if (has_upper) {
+    GetUpperFence(upper);
+  }
+  recipient->Build(list, half_size, list.GetCount(), list.KeyAt(half_size), has_upper ? upper : nullptr);
+  Build(list, 0, half_size, lower, list.KeyAt(half_size));
+  recipient->Adopt(0, recipient->GetSize(), buffer_pool_manager);
+}
+
+/*
+ * Split at the right edge of an internal level, see LeafPage::MoveTailTo. recipient routes to two children at least.
+ */
+void InternalPage::MoveTailTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager, double fill_factor) {
+  EntryList list(GetKeySize(), sizeof(page_id_t));
+  DecodeEntries(0, GetSize(), &list);
+  int left_size = std::min(MiddleOf(list, fill_factor), list.GetCount() - 2);
+  std::vector<char> keys(GetKeySize() * 2);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  GetLowerFence(lower);
+  bool has_upper = HasUpperFence();
+  if (has_upper) {
+    GetUpperFence(upper);
+  }
+  if (left_size < 2 || !CanHold(left_size, EncodedSize(list, 0, left_size, lower, list.KeyAt(left_size)))) {
+    MoveHalfTo(recipient, buffer_pool_manager);
+    return;
+  }
+  recipient->Build(list, left_size, list.GetCount(), list.KeyAt(left_size), has_upper ? upper : nullptr);
+  Build(list, 0, left_size, lower, list.KeyAt(left_size));
+  recipient->Adopt(0, recipient->GetSize(), buffer_pool_manager);
 }
 
-/* Copy entries into me, starting from {src} and copy {size} entries.
+/*
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
- *
- * @param src: pointer to the continuous key-value pairs to be copied
  */
-void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager) {
-  // Copy the key-value pairs from src to the current page
-  int start_index = GetSize();  // Start index for copying
-  PairCopy(PairPtrAt(start_index), src, size);
-  // if (start_index == 0) memset(KeyAt(0), 0, GetKeySize());  // Initialize the first key if it's the first insertion
-  IncreaseSize(size);  // Increase the size of the internal page
-
-  // Update the parent page id for each copied child page
-  for (int i = start_index; i < start_index + size; ++i) {
-    int page_id = ValueAt(i);
+void InternalPage::Adopt(int begin, int end, BufferPoolManager *buffer_pool_manager) {
+  for (int i = begin; i < end; ++i) {
+    page_id_t page_id = ValueAt(i);
     auto *child_page = buffer_pool_manager->FetchPage(page_id);
     if (child_page == nullptr) {
       LOG(ERROR) << "Failed to fetch child page with id: " << page_id;
       return;
     }
-    auto *node = reinterpret_cast<BPlusTreeInternalPage *>(child_page->GetData());
+    auto *node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
     node->SetParentPageId(GetPageId());
     buffer_pool_manager->UnpinPage(page_id, true);  // Unpin the child page after updating
   }
@@ -177,14 +159,8 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
 /*
  * Remove the key & value pair in internal page according to input index(a.k.a
  * array offset)
- * NOTE: store key&value pair continuously after deletion
- * NOTE: not need to set the first key to invalid, as we get the original second
- * key by call KeyAt(0) after Remove in the function BPlusTree::Redistribute
  */
-void InternalPage::Remove(int index) {
-  PairCopy(PairPtrAt(index), PairPtrAt(index + 1), GetSize() - index - 1);
-  IncreaseSize(-1);  // Decrease the size of the internal page
-}
+void InternalPage::Remove(int index) { RemoveEntry(index); }
 
 /*
  * Remove the only key & value pair in internal page and return the value
@@ -196,89 +172,87 @@ page_id_t InternalPage::RemoveAndReturnOnlyChild() {
     LOG(ERROR) << "Cannot remove and return only child from an internal page with size: " << GetSize();
     return INVALID_PAGE_ID;
   }
-
+  page_id_t child = ValueAt(0);
   Remove(0);
-
-  return ValueAt(0);
+  return child;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 /*
- * Remove all of key & value pairs from this page to "recipient" page.
- * The middle_key is the separation key you should get from the parent. You need
- * to make sure the middle key is added to the recipient to maintain the invariant.
+ * Remove all of key & value pairs from this page to "recipient" page, its left sibling.
+ * The middle_key is the separation key you should get from the parent. It is added to the recipient as the key of
+ * the first child of this page to maintain the invariant.
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
  * pages that are moved to the recipient
- *
- * NOTE: Caller should ensure that the recipient page is smaller than this page.
+ * @return false if the entries do not fit in recipient, nothing is moved then
  */
-void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyLastFrom(middle_key, ValueAt(0), buffer_pool_manager);
-  recipient->CopyNFrom(PairPtrAt(1), GetSize() - 1, buffer_pool_manager);
+bool InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
+  EntryList list(GetKeySize(), sizeof(page_id_t));
+  recipient->DecodeEntries(0, recipient->GetSize(), &list);
+  int moved = list.GetCount();
+  page_id_t first_child = ValueAt(0);
+  list.Append(middle_key, &first_child);
+  DecodeEntries(1, GetSize(), &list);
+  std::vector<char> keys(GetKeySize() * 2);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  recipient->GetLowerFence(lower);
+  if (HasUpperFence()) {
+    GetUpperFence(upper);
+  } else {
+    upper = nullptr;
+  }
+  if (!recipient->CanHold(list.GetCount(), recipient->EncodedSize(list, 0, list.GetCount(), lower, upper))) {
+    return false;
+  }
+  recipient->Build(list, 0, list.GetCount(), lower, upper);
+  recipient->Adopt(moved, recipient->GetSize(), buffer_pool_manager);
+  SetSize(0);
+  return true;
 }
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
- * Remove the first key & value pair from this page to tail of "recipient" page.
- *
- * The middle_key is the separation key you should get from the parent. You need
- * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * Spread the children of this page and its right sibling evenly between them, by bytes. index is the position of
+ * right in parent: the separator there comes down as the key of the first child of right, and the key of the first
+ * child right ends up with goes up in its place.
+ * @return false if either page or the parent would overflow, nothing is moved then
  */
-void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key,
-                                    BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyLastFrom(middle_key, ValueAt(0), buffer_pool_manager);
-  Remove(0);  // Remove the first key-value pair from this page
-}
-
-/* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager) {
-  // Insert the new key-value pair at the end
-  SetKeyAt(GetSize(), key);
-  SetValueAt(GetSize(), value);
-  IncreaseSize(1);  // Increase the size of the internal page
-
-  // Update the parent page id of the value being copied
-  auto *child_page = buffer_pool_manager->FetchPage(value);
-  auto *child = reinterpret_cast<BPlusTreeInternalPage *>(child_page->GetData());
-  child->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);  // Unpin the child page after updating
-}
-
-/*
- * Remove the last key & value pair from this page to head of "recipient" page.
- * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
- * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
- */
-void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
-                                     BufferPoolManager *buffer_pool_manager) {
-  recipient->CopyFirstFrom(ValueAt(GetSize() - 1), buffer_pool_manager);
-  recipient->SetKeyAt(1, middle_key);  // Set the middle key at the front of recipient
-  Remove(GetSize() - 1);               // Remove the last key-value pair from this page
+bool InternalPage::RebalanceWith(InternalPage *right, InternalPage *parent, int index,
+                                 BufferPoolManager *buffer_pool_manager) {
+  EntryList list(GetKeySize(), sizeof(page_id_t));
+  DecodeEntries(0, GetSize(), &list);
+  int old_left_size = GetSize();
+  // the first key of right reads as its lower fence, which is the separator in parent
+  right->DecodeEntries(0, right->GetSize(), &list);
+  int left_size = MiddleOf(list);
+  std::vector<char> keys(GetKeySize() * 3);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  auto *separator = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize() * 2);
+  GetLowerFence(lower);
+  if (right->HasUpperFence()) {
+    right->GetUpperFence(upper);
+  } else {
+    upper = nullptr;
+  }
+  memcpy(separator, list.KeyAt(left_size), GetKeySize());
+  if (!CanHold(left_size, EncodedSize(list, 0, left_size, lower, separator)) ||
+      !right->CanHold(list.GetCount() - left_size,
+                      right->EncodedSize(list, left_size, list.GetCount(), separator, upper)) ||
+      !parent->SetKeyAt(index, separator)) {
+    return false;
+  }
+  Build(list, 0, left_size, lower, separator);
+  right->Build(list, left_size, list.GetCount(), separator, upper);
+  if (left_size > old_left_size) {
+    Adopt(old_left_size, left_size, buffer_pool_manager);
+  } else {
+    right->Adopt(0, old_left_size - left_size, buffer_pool_manager);
+  }
+  return true;
 }
-
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- *
- * NOTE: Need to set the second key(use SetKeyAt(1, key)) after this function is called,
- */
-void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffer_pool_manager) {
-  InsertNodeAfter(INVALID_PAGE_ID, KeyAt(0), value);
-
-  // Update the parent page id of the value being copied
-  auto *child_page = buffer_pool_manager->FetchPage(value);
-  auto *child = reinterpret_cast<BPlusTreeInternalPage *>(child_page->GetData());
-  child->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(value, true);  // Unpin the child page after updating
-}
\ No newline at end of file
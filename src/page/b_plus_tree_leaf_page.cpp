@@ -3,32 +3,19 @@
 #include <algorithm>
 
 #include "index/generic_key.h"
+#include "page/b_plus_tree_internal_page.h"
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(RowId))
-#define key_off 0
-#define val_off GetKeySize()
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
 
-/**
- * TODO: Student Implement
- */
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
  * next page id and set max size
- * 未初始化next_page_id
  */
 void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
-  SetPageType(IndexPageType::LEAF_PAGE);
-  SetKeySize(key_size);
-  SetSize(0);
-  SetMaxSize(max_size);
-  SetParentPageId(parent_id);
-  SetPageId(page_id);
-  SetNextPageId(INVALID_PAGE_ID);  // Initialize next page id to invalid
+  InitPage(IndexPageType::LEAF_PAGE, page_id, parent_id, key_size, max_size);
 }
 
 /**
@@ -43,109 +30,99 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
   }
 }
 
-/**
- * TODO: Student Implement
- */
+page_id_t LeafPage::GetPrevPageId() const { return prev_page_id_; }
+
+void LeafPage::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
 /**
  * Helper method to find the first index i so that pairs_[i].first >= key
  * NOTE: This method is only used when generating index iterator // ??? Actually, it is used in insertion and deletion as well
- * 二分查找
+ * 二分查找，按字节比较规范化的 key，不再需要 comparator
  */
-int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
-  if (GetSize() == 0) return -1;
-
-  int left = 0;
-  int right = GetSize() - 1;
-  while (left < right) {
-    int mid = (left + right) / 2;
-    if (KM.CompareKeys(key, KeyAt(mid)) <= 0) {
-      right = mid;
-    } else {
-      left = mid + 1;
-    }
-  }
-  if (KM.CompareKeys(key, KeyAt(left)) <= 0) {
-    return left;
-  } else {
-    return left + 1;  // Return the next index if key is greater than the last key
-  }
-}
+int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &) const { return LowerBound(key, 0); }
+
+int LeafPage::LastKeyIndex(const GenericKey *key, const KeyManager &) const { return UpperBound(key, 0) - 1; }
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
-GenericKey *LeafPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
-}
-
-void LeafPage::SetKeyAt(int index, GenericKey *key) {
-  memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
-}
+void LeafPage::KeyAt(int index, GenericKey *key) const { ReadKey(index, key); }
 
 RowId LeafPage::ValueAt(int index) const {
-  return *reinterpret_cast<const RowId *>(pairs_off + index * pair_size + val_off);
-}
-
-void LeafPage::SetValueAt(int index, RowId value) {
-  *reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off) = value;
+  RowId value;
+  memcpy(&value, ValuePtrAt(index), sizeof(RowId));
+  return value;
 }
 
-void *LeafPage::PairPtrAt(int index) { return KeyAt(index); }
-
-void LeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
-}
-/*
- * Helper method to find and return the key & value pair associated with input
- * "index"(a.k.a. array offset)
- */
-std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) { return {KeyAt(index), ValueAt(index)}; }
+void LeafPage::SetValueAt(int index, RowId value) { memcpy(ValuePtrAt(index), &value, sizeof(RowId)); }
 
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * NOTE: the page must not overflow before the insertion, it always has room for one more entry then
  * @return page size after insertion
  */
 int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
-  if (GetSize() == 0) {
-    // The page is empty, insert at the beginning
-    SetKeyAt(0, key);
-    SetValueAt(0, value);
-  } else {
-    int index = KeyIndex(key, KM);
-    PairCopy(PairPtrAt(index + 1), PairPtrAt(index), GetSize() - index);
-    SetKeyAt(index, key);
-    SetValueAt(index, value);
-  }
-  IncreaseSize(1);   // Increase the size of the page after insertion
+  bool inserted = InsertEntry(KeyIndex(key, KM), key, &value);
+  ASSERT(inserted, "Insert into an overflowed leaf page.");
+  (void)inserted;
   return GetSize();  // Return the new size of the page
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
-
-// NOTE: All move and copy methods of split add new key & value pairs to the end of the page
-
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs (by bytes) from this page to "recipient" page
+ * The pages are separated by the shortest prefix of the first moved key that is still greater than the last key
+ * left, which becomes the upper fence of this page and the lower fence of recipient.
  */
 void LeafPage::MoveHalfTo(LeafPage *recipient) {
-  int size = GetSize();
-  int half_size = (size + 1) / 2;
-  recipient->CopyNFrom(PairPtrAt(half_size), size - half_size);
-  SetSize(half_size);  // Update the size of the current page
+  EntryList list(GetKeySize(), sizeof(RowId));
+  DecodeEntries(0, GetSize(), &list);
+  int half_size = MiddleOf(list);
+  std::vector<char> keys(GetKeySize() * 3);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  auto *separator = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize() * 2);
+  GetLowerFence(lower);
+  bool has_upper = HasUpperFence();
+  if (has_upper) {
+    GetUpperFence(upper);
+  }
+  MakeSeparator(list, half_size, separator);
+  recipient->Build(list, half_size, list.GetCount(), separator, has_upper ? upper : nullptr);
+  Build(list, 0, half_size, lower, separator);
 }
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
- */
-void LeafPage::CopyNFrom(void *src, int size) {
-  PairCopy(PairPtrAt(GetSize()), src, size);
-  IncreaseSize(size);
+ * Split at the right edge of the leaf level: keys keep coming after the last one, so this page keeps fill_factor of
+ * the bytes instead of half and recipient takes the rest. Falls back to an even split when the new upper fence of a
+ * page of long keys does not fit.
+ */
+void LeafPage::MoveTailTo(LeafPage *recipient, double fill_factor) {
+  EntryList list(GetKeySize(), sizeof(RowId));
+  DecodeEntries(0, GetSize(), &list);
+  int left_size = MiddleOf(list, fill_factor);
+  std::vector<char> keys(GetKeySize() * 3);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  auto *separator = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize() * 2);
+  GetLowerFence(lower);
+  bool has_upper = HasUpperFence();
+  if (has_upper) {
+    GetUpperFence(upper);
+  }
+  MakeSeparator(list, left_size, separator);
+  if (!CanHold(left_size, EncodedSize(list, 0, left_size, lower, separator))) {
+    MoveHalfTo(recipient);
+    return;
+  }
+  recipient->Build(list, left_size, list.GetCount(), separator, has_upper ? upper : nullptr);
+  Build(list, 0, left_size, lower, separator);
 }
 
 /*****************************************************************************
@@ -156,9 +133,9 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * does, then store its corresponding value in input "value" and return true.
  * If the key does not exist, then return false
  */
-bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
+bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) const {
   int index = KeyIndex(key, KM);
-  if (index < GetSize() && KM.CompareKeys(KeyAt(index), key) == 0) {
+  if (index < GetSize() && CompareKeyAt(key, index) == 0) {
     value = ValueAt(index);
     return true;  // Key found
   }
@@ -171,16 +148,13 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
 /*
  * First look through leaf page to see whether delete key exist or not. If
  * existed, perform deletion, otherwise return immediately.
- * NOTE: store key&value pair continuously after deletion
  * @return  page size after deletion
  */
 int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
   int index = KeyIndex(key, KM);
-  if (index == -1) return GetSize();  // Key not found
-
-  // Shift items to fill the gap
-  PairCopy(PairPtrAt(index), PairPtrAt(index + 1), GetSize() - index - 1);
-  IncreaseSize(-1);
+  if (index < GetSize() && CompareKeyAt(key, index) == 0) {
+    RemoveEntry(index);
+  }
   return GetSize();
 }
 
@@ -188,55 +162,65 @@ int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
  * MERGE
  *****************************************************************************/
 /*
- * Remove all key & value pairs from this page to "recipient" page. Don't forget
+ * Remove all key & value pairs from this page to "recipient" page, its left sibling. Don't forget
  * to update the next_page id in the sibling page
- */
-void LeafPage::MoveAllTo(LeafPage *recipient) {
-  recipient->CopyNFrom(PairPtrAt(0), GetSize());
+ * The merged page spans both fence ranges, its prefix may get shorter and its keys longer.
+ * @return false if the entries do not fit in recipient, nothing is moved then
+ */
+bool LeafPage::MoveAllTo(LeafPage *recipient) {
+  EntryList list(GetKeySize(), sizeof(RowId));
+  recipient->DecodeEntries(0, recipient->GetSize(), &list);
+  DecodeEntries(0, GetSize(), &list);
+  std::vector<char> keys(GetKeySize() * 2);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  recipient->GetLowerFence(lower);
+  if (HasUpperFence()) {
+    GetUpperFence(upper);
+  } else {
+    upper = nullptr;
+  }
+  if (!recipient->CanHold(list.GetCount(), recipient->EncodedSize(list, 0, list.GetCount(), lower, upper))) {
+    return false;
+  }
+  recipient->Build(list, 0, list.GetCount(), lower, upper);
   recipient->SetNextPageId(GetNextPageId());  // Update next page id
   SetSize(0);                                 // Clear the current page
   SetNextPageId(INVALID_PAGE_ID);             // Reset next page id
+  return true;
 }
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
- * Remove the first key & value pair from this page to "recipient" page.
- *
- */
-void LeafPage::MoveFirstToEndOf(LeafPage *recipient) {
-  recipient->CopyLastFrom(KeyAt(0), ValueAt(0));
-  PairCopy(PairPtrAt(0), PairPtrAt(1), GetSize() - 1);
-  IncreaseSize(-1);
-}
-
-/*
- * Copy the item into the end of my item list. (Append item to my array)
- */
-void LeafPage::CopyLastFrom(GenericKey *key, const RowId value) {
-  int size = GetSize();
-  SetKeyAt(size, key);
-  SetValueAt(size, value);
-  IncreaseSize(1);
-}
-
-/*
- * Remove the last key & value pair from this page to "recipient" page.
- */
-void LeafPage::MoveLastToFrontOf(LeafPage *recipient) {
-  int size = GetSize();
-  recipient->CopyFirstFrom(KeyAt(size - 1), ValueAt(size - 1));
-  IncreaseSize(-1);
+ * Spread the entries of this page and its right sibling evenly between them, by bytes. index is the position of
+ * right in parent, its key is replaced by the new separator.
+ * @return false if either page or the parent would overflow, nothing is moved then
+ */
+bool LeafPage::RebalanceWith(LeafPage *right, InternalPage *parent, int index) {
+  EntryList list(GetKeySize(), sizeof(RowId));
+  DecodeEntries(0, GetSize(), &list);
+  right->DecodeEntries(0, right->GetSize(), &list);
+  int left_size = MiddleOf(list);
+  std::vector<char> keys(GetKeySize() * 3);
+  auto *lower = reinterpret_cast<GenericKey *>(keys.data());
+  auto *upper = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize());
+  auto *separator = reinterpret_cast<GenericKey *>(keys.data() + GetKeySize() * 2);
+  GetLowerFence(lower);
+  if (right->HasUpperFence()) {
+    right->GetUpperFence(upper);
+  } else {
+    upper = nullptr;
+  }
+  MakeSeparator(list, left_size, separator);
+  if (!CanHold(left_size, EncodedSize(list, 0, left_size, lower, separator)) ||
+      !right->CanHold(list.GetCount() - left_size,
+                      right->EncodedSize(list, left_size, list.GetCount(), separator, upper)) ||
+      !parent->SetKeyAt(index, separator)) {
+    return false;
+  }
+  Build(list, 0, left_size, lower, separator);
+  right->Build(list, left_size, list.GetCount(), separator, upper);
+  return true;
 }
-
-/*
- * Insert item at the front of my items. Move items accordingly.
- *
- */
-void LeafPage::CopyFirstFrom(GenericKey *key, const RowId value) {
-  PairCopy(PairPtrAt(1), PairPtrAt(0), GetSize());
-  SetKeyAt(0, key);
-  SetValueAt(0, value);
-  IncreaseSize(1);
-}
\ No newline at end of file
@@ -1,5 +1,80 @@
 #include "page/b_plus_tree_page.h"
 
+#include <algorithm>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define BPLUS_TREE_SIMD_SEARCH
+#endif
+
+/*
+ * Head search kernels: count the slots whose head is below a given head in a run of count slots. Every slot is 8
+ * bytes with its head in the upper 4, the vector kernels compare 4 (AVX2) or 2 (SSE2) heads at once and mask out
+ * the other halves of the slots. There is no unsigned 32 bit compare, both sides are biased by 2^31 to compare signed.
+ */
+namespace {
+constexpr int SEARCH_WINDOW = 16;  // slots left to the kernel once the branch-free binary search narrowed them down
+
+int CountHeadsBelowScalar(const char *slots, int count, uint32_t head) {
+  int below = 0;
+  for (int i = 0; i < count; i++) {
+    uint32_t slot_head;
+    memcpy(&slot_head, slots + i * BPlusTreePage::SLOT_SIZE + sizeof(uint32_t), sizeof(slot_head));
+    below += slot_head < head;
+  }
+  return below;
+}
+
+#ifdef BPLUS_TREE_SIMD_SEARCH
+__attribute__((target("sse2"))) int CountHeadsBelowSse2(const char *slots, int count, uint32_t head) {
+  const __m128i bias = _mm_set1_epi32(INT32_MIN);
+  const __m128i target = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(head)), bias);
+  int below = 0;
+  int i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128i heads = _mm_loadu_si128(reinterpret_cast<const __m128i *>(slots + i * BPlusTreePage::SLOT_SIZE));
+    __m128i less = _mm_cmplt_epi32(_mm_xor_si128(heads, bias), target);
+    below += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(less)) & 0xA);
+  }
+  return below + CountHeadsBelowScalar(slots + i * BPlusTreePage::SLOT_SIZE, count - i, head);
+}
+
+__attribute__((target("avx2"))) int CountHeadsBelowAvx2(const char *slots, int count, uint32_t head) {
+  const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+  const __m256i target = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(head)), bias);
+  int below = 0;
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256i heads = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(slots + i * BPlusTreePage::SLOT_SIZE));
+    __m256i less = _mm256_cmpgt_epi32(target, _mm256_xor_si256(heads, bias));
+    below += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(less)) & 0xAA);
+  }
+  return below + CountHeadsBelowSse2(slots + i * BPlusTreePage::SLOT_SIZE, count - i, head);
+}
+#endif
+
+struct SearchKernel {
+  const char *name_;
+  int (*count_heads_below_)(const char *slots, int count, uint32_t head);
+};
+
+// picked once from the features of the running cpu, the binary may run on machines older than the build one
+SearchKernel SelectSearchKernel() {
+#ifdef BPLUS_TREE_SIMD_SEARCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {"avx2", CountHeadsBelowAvx2};
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return {"sse2", CountHeadsBelowSse2};
+  }
+#endif
+  return {"scalar", CountHeadsBelowScalar};
+}
+
+const SearchKernel search_kernel = SelectSearchKernel();
+}  // namespace
+
 /*
  * Helper methods to get/set page type
  * Page type enum class is defined in b_plus_tree_page.h
@@ -75,4 +150,427 @@ void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
 /*
  * Helper methods to set lsn
  */
-void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
\ No newline at end of file
+void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+void BPlusTreePage::InitPage(IndexPageType page_type, page_id_t page_id, page_id_t parent_id, int key_size,
+                             int max_size) {
+  SetPageType(page_type);
+  SetKeySize(key_size);
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetParentPageId(parent_id);
+  SetPageId(page_id);
+  SetLSN();
+  next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+  // no fences: the page covers every key until it is built under a parent
+  prefix_size_ = 0;
+  lower_fence_size_ = 0;
+  upper_fence_size_ = NO_UPPER_FENCE;
+  heap_offset_ = DATA_SIZE;
+  heap_size_ = 0;
+  reserved_ = 0;
+}
+
+/*****************************************************************************
+ * ENTRY LIST
+ *****************************************************************************/
+void BPlusTreePage::EntryList::Append(const GenericKey *key, const void *value) {
+  auto *key_data = reinterpret_cast<const char *>(key);
+  auto *value_data = reinterpret_cast<const char *>(value);
+  data_.insert(data_.end(), key_data, key_data + key_size_);
+  data_.insert(data_.end(), value_data, value_data + value_size_);
+  trimmed_sizes_.push_back(TrimmedSize(key_data, key_size_));
+}
+
+void BPlusTreePage::EntryList::EraseFront(int count) {
+  data_.erase(data_.begin(), data_.begin() + count * (key_size_ + value_size_));
+  trimmed_sizes_.erase(trimmed_sizes_.begin(), trimmed_sizes_.begin() + count);
+}
+
+/*****************************************************************************
+ * SPACE
+ *****************************************************************************/
+int BPlusTreePage::GetUsedSpace() const { return GetSize() * SLOT_SIZE + heap_size_ + GetFenceSize(); }
+
+bool BPlusTreePage::CanHold(int count, int used_space) const {
+  return count < GetMaxSize() && used_space + GetMaxEntrySize() <= DATA_SIZE;
+}
+
+/*
+ * A page only merges or borrows once it is low on both entries and bytes: small pages of long keys are not
+ * underflowing as long as they fill half of the page.
+ */
+bool BPlusTreePage::IsUnderflow(double merge_threshold) const {
+  if (GetSize() < (IsLeafPage() ? 1 : 2)) {
+    return true;
+  }
+  return GetSize() < GetMinSize() && GetUsedSpace() < DATA_SIZE * merge_threshold;
+}
+
+/*****************************************************************************
+ * KEYS
+ *****************************************************************************/
+int BPlusTreePage::TrimmedSize(const char *key, int size) {
+  while (size > 0 && key[size - 1] == 0) {
+    size--;
+  }
+  return size;
+}
+
+uint32_t BPlusTreePage::KeyHead(const char *key, int size) {
+  uint32_t head = 0;
+  memcpy(&head, key, std::min(size, static_cast<int>(sizeof(head))));
+  return __builtin_bswap32(head);
+}
+
+/*
+ * Every key between the fences starts with their common prefix. It is read back from the lower fence, which is kept
+ * without its trailing zeros, so the prefix never goes past them.
+ */
+int BPlusTreePage::FencePrefixSize(const GenericKey *lower, const GenericKey *upper) const {
+  if (upper == nullptr) {
+    return 0;
+  }
+  auto *lower_data = reinterpret_cast<const char *>(lower);
+  auto *upper_data = reinterpret_cast<const char *>(upper);
+  int size = 0;
+  while (size < GetKeySize() && lower_data[size] == upper_data[size]) {
+    size++;
+  }
+  return std::min(size, TrimmedSize(lower_data, GetKeySize()));
+}
+
+void BPlusTreePage::GetLowerFence(GenericKey *key) const {
+  auto *data = reinterpret_cast<char *>(key);
+  memcpy(data, LowerFencePtr(), lower_fence_size_);
+  memset(data + lower_fence_size_, 0, GetKeySize() - lower_fence_size_);
+}
+
+void BPlusTreePage::GetUpperFence(GenericKey *key) const {
+  ASSERT(HasUpperFence(), "The rightmost page has no upper fence.");
+  auto *data = reinterpret_cast<char *>(key);
+  memcpy(data, LowerFencePtr() + lower_fence_size_, upper_fence_size_);
+  memset(data + upper_fence_size_, 0, GetKeySize() - upper_fence_size_);
+}
+
+void BPlusTreePage::ReadKey(int index, GenericKey *key) const {
+  if (!IsLeafPage() && index == 0) {
+    GetLowerFence(key);
+    return;
+  }
+  auto *data = reinterpret_cast<char *>(key);
+  const Slot &slot = SlotAt(index);
+  memcpy(data, LowerFencePtr(), prefix_size_);
+  memcpy(data + prefix_size_, data_ + slot.offset_, slot.key_size_);
+  memset(data + prefix_size_ + slot.key_size_, 0, GetKeySize() - prefix_size_ - slot.key_size_);
+}
+
+void BPlusTreePage::MakeSeparator(const EntryList &list, int index, GenericKey *separator) const {
+  auto *right = reinterpret_cast<const char *>(list.KeyAt(index));
+  auto *data = reinterpret_cast<char *>(separator);
+  if (!IsLeafPage()) {
+    // the key of an internal entry already routes to its child, it is pulled up as is
+    memcpy(data, right, GetKeySize());
+    return;
+  }
+  // suffix truncation: the first byte that tells the keys apart ends the separator
+  auto *left = reinterpret_cast<const char *>(list.KeyAt(index - 1));
+  int size = 0;
+  while (size < GetKeySize() && left[size] == right[size]) {
+    size++;
+  }
+  size = std::min(size + 1, GetKeySize());
+  memcpy(data, right, size);
+  memset(data + size, 0, GetKeySize() - size);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+int BPlusTreePage::ComparePrefix(const GenericKey *key) const {
+  if (prefix_size_ == 0) {
+    return 0;
+  }
+  int cmp = memcmp(key, LowerFencePtr(), prefix_size_);
+  return (cmp > 0) - (cmp < 0);
+}
+
+BPlusTreePage::SearchKey BPlusTreePage::MakeSearchKey(const GenericKey *key) const {
+  SearchKey search_key;
+  search_key.rest_ = reinterpret_cast<const char *>(key) + prefix_size_;
+  search_key.significant_ = TrimmedSize(search_key.rest_, GetKeySize() - prefix_size_);
+  search_key.head_ = KeyHead(search_key.rest_, search_key.significant_);
+  return search_key;
+}
+
+/*
+ * Both keys are compared as if padded with zeros: once the heads and the stored bytes are equal, the search key is
+ * greater only if it has non zero bytes past the stored key.
+ */
+int BPlusTreePage::CompareAt(const SearchKey &key, int index) const {
+  const Slot &slot = SlotAt(index);
+  if (key.head_ != slot.head_) {
+    return key.head_ < slot.head_ ? -1 : 1;
+  }
+  int head_size = static_cast<int>(sizeof(slot.head_));
+  if (slot.key_size_ > head_size) {
+    int cmp = memcmp(key.rest_ + head_size, data_ + slot.offset_ + head_size, slot.key_size_ - head_size);
+    if (cmp != 0) {
+      return cmp;
+    }
+  }
+  return key.significant_ > std::max<int>(slot.key_size_, head_size) ? 1 : 0;
+}
+
+const char *BPlusTreePage::GetSearchKernel() { return search_kernel.name_; }
+
+/*
+ * Heads are sorted along with the keys. A branch-free binary search (the comparison picks the next base instead of
+ * a jump) narrows [begin, end) down to SEARCH_WINDOW slots, which the kernel counts in a few vector compares.
+ */
+int BPlusTreePage::HeadLowerBound(uint32_t head, int begin, int end) const {
+  const Slot *slots = &SlotAt(0);
+  int base = begin;
+  int count = end - begin;
+  while (count > SEARCH_WINDOW) {
+    int half = count / 2;
+    base = slots[base + half - 1].head_ < head ? base + half : base;
+    count -= half;
+  }
+  return base + search_kernel.count_heads_below_(reinterpret_cast<const char *>(slots + base), count, head);
+}
+
+/*
+ * Only the keys sharing the head of the search key are compared in full, by a binary search between the first head
+ * not below it and the first head above it.
+ */
+void BPlusTreePage::HeadRange(const SearchKey &key, int begin, int *first, int *last) const {
+  *first = HeadLowerBound(key.head_, begin, GetSize());
+  *last = key.head_ == UINT32_MAX ? GetSize() : HeadLowerBound(key.head_ + 1, *first, GetSize());
+}
+
+int BPlusTreePage::CompareKeyAt(const GenericKey *key, int index) const {
+  int cmp = ComparePrefix(key);
+  return cmp != 0 ? cmp : CompareAt(MakeSearchKey(key), index);
+}
+
+int BPlusTreePage::LowerBound(const GenericKey *key, int begin) const {
+  int cmp = ComparePrefix(key);
+  if (cmp != 0) {
+    return cmp < 0 ? begin : GetSize();
+  }
+  SearchKey search_key = MakeSearchKey(key);
+  int left;
+  int right;
+  HeadRange(search_key, begin, &left, &right);
+  while (left < right) {
+    int mid = (left + right) / 2;
+    if (CompareAt(search_key, mid) > 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+int BPlusTreePage::UpperBound(const GenericKey *key, int begin) const {
+  int cmp = ComparePrefix(key);
+  if (cmp != 0) {
+    return cmp < 0 ? begin : GetSize();
+  }
+  SearchKey search_key = MakeSearchKey(key);
+  int left;
+  int right;
+  HeadRange(search_key, begin, &left, &right);
+  while (left < right) {
+    int mid = (left + right) / 2;
+    if (CompareAt(search_key, mid) >= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/*****************************************************************************
+ * ENTRIES
+ *****************************************************************************/
+bool BPlusTreePage::InsertEntry(int index, const GenericKey *key, const void *value) {
+  const char *rest = nullptr;
+  int key_size = 0;
+  if (key != nullptr) {
+    rest = reinterpret_cast<const char *>(key) + prefix_size_;
+    key_size = std::max(TrimmedSize(reinterpret_cast<const char *>(key), GetKeySize()) - prefix_size_, 0);
+  }
+  int entry_size = key_size + GetValueSize();
+  if (GetFreeSpace() < SLOT_SIZE + entry_size) {
+    return false;
+  }
+  if (heap_offset_ - (GetSize() + 1) * SLOT_SIZE < entry_size) {
+    Compact();
+  }
+  heap_offset_ -= entry_size;
+  heap_size_ += entry_size;
+  if (key_size > 0) {
+    memcpy(data_ + heap_offset_, rest, key_size);
+  }
+  memcpy(data_ + heap_offset_ + key_size, value, GetValueSize());
+  memmove(&SlotAt(index + 1), &SlotAt(index), (GetSize() - index) * SLOT_SIZE);
+  Slot &slot = SlotAt(index);
+  slot.offset_ = heap_offset_;
+  slot.key_size_ = key_size;
+  slot.head_ = KeyHead(data_ + heap_offset_, key_size);
+  IncreaseSize(1);
+  return true;
+}
+
+void BPlusTreePage::RemoveEntry(int index) {
+  heap_size_ -= SlotAt(index).key_size_ + GetValueSize();
+  memmove(&SlotAt(index), &SlotAt(index + 1), (GetSize() - index - 1) * SLOT_SIZE);
+  IncreaseSize(-1);
+  if (GetSize() == 0) {
+    heap_offset_ = DATA_SIZE - GetFenceSize();
+  }
+}
+
+bool BPlusTreePage::CanReplaceKey(int index, const GenericKey *key) const {
+  int key_size = std::max(TrimmedSize(reinterpret_cast<const char *>(key), GetKeySize()) - prefix_size_, 0);
+  return CanHold(GetSize(), GetUsedSpace() - SlotAt(index).key_size_ + key_size);
+}
+
+void BPlusTreePage::ReplaceKey(int index, const GenericKey *key) {
+  char value[sizeof(RowId)];
+  memcpy(value, ValuePtrAt(index), GetValueSize());
+  RemoveEntry(index);
+  bool inserted = InsertEntry(index, key, value);
+  ASSERT(inserted, "Replaced key does not fit in the page.");
+  (void)inserted;
+}
+
+void BPlusTreePage::Compact() {
+  char heap[DATA_SIZE];
+  int offset = DATA_SIZE - GetFenceSize();
+  for (int i = 0; i < GetSize(); i++) {
+    Slot &slot = SlotAt(i);
+    int entry_size = slot.key_size_ + GetValueSize();
+    offset -= entry_size;
+    memcpy(heap + offset, data_ + slot.offset_, entry_size);
+    slot.offset_ = offset;
+  }
+  memcpy(data_ + offset, heap + offset, DATA_SIZE - GetFenceSize() - offset);
+  heap_offset_ = offset;
+}
+
+/*****************************************************************************
+ * BUILD
+ *****************************************************************************/
+int BPlusTreePage::MiddleOf(const EntryList &list, double fraction) {
+  int total = 0;
+  for (int i = 0; i < list.GetCount(); i++) {
+    total += SLOT_SIZE + list.GetTrimmedSize(i);
+  }
+  int index = 0;
+  for (int size = 0; index < list.GetCount() && size < total * fraction; index++) {
+    size += SLOT_SIZE + list.GetTrimmedSize(index);
+  }
+  return std::clamp(index, 1, list.GetCount() - 1);
+}
+
+void BPlusTreePage::DecodeEntries(int begin, int end, EntryList *list) const {
+  std::vector<char> key(GetKeySize());
+  for (int i = begin; i < end; i++) {
+    ReadKey(i, reinterpret_cast<GenericKey *>(key.data()));
+    list->Append(reinterpret_cast<GenericKey *>(key.data()), ValuePtrAt(i));
+  }
+}
+
+int BPlusTreePage::EncodedSize(const EntryList &list, int begin, int end, const GenericKey *lower,
+                               const GenericKey *upper) const {
+  int prefix_size = FencePrefixSize(lower, upper);
+  int size = TrimmedSize(reinterpret_cast<const char *>(lower), GetKeySize());
+  if (upper != nullptr) {
+    size += TrimmedSize(reinterpret_cast<const char *>(upper), GetKeySize());
+  }
+  for (int i = begin; i < end; i++) {
+    size += SLOT_SIZE + GetValueSize();
+    // the first key of an internal page is its lower fence
+    if (IsLeafPage() || i != begin) {
+      size += std::max(list.GetTrimmedSize(i) - prefix_size, 0);
+    }
+  }
+  return size;
+}
+
+void BPlusTreePage::Build(const EntryList &list, int begin, int end, const GenericKey *lower,
+                          const GenericKey *upper) {
+  int lower_size = TrimmedSize(reinterpret_cast<const char *>(lower), GetKeySize());
+  int upper_size = upper == nullptr ? 0 : TrimmedSize(reinterpret_cast<const char *>(upper), GetKeySize());
+  prefix_size_ = FencePrefixSize(lower, upper);
+  lower_fence_size_ = lower_size;
+  upper_fence_size_ = upper == nullptr ? NO_UPPER_FENCE : upper_size;
+  char *fences = data_ + DATA_SIZE - GetFenceSize();
+  memcpy(fences, lower, lower_size);
+  if (upper != nullptr) {
+    memcpy(fences + lower_size, upper, upper_size);
+  }
+  heap_offset_ = DATA_SIZE - GetFenceSize();
+  heap_size_ = 0;
+  SetSize(0);
+  for (int i = begin; i < end; i++) {
+    bool inserted = InsertEntry(i - begin, (IsLeafPage() || i != begin) ? list.KeyAt(i) : nullptr, list.ValueAt(i));
+    ASSERT(inserted, "Entries do not fit in the page.");
+    (void)inserted;
+  }
+}
+
+/*
+ * The fences of the page depend on where it ends, so the run length is found by a binary search over the encoded
+ * size. The last page of a level takes half of what is left instead of leaving a small page behind it.
+ */
+int BPlusTreePage::BuildFrom(const EntryList &list, int begin, bool last, const GenericKey *lower, double fill_factor,
+                             GenericKey *upper) {
+  int remaining = list.GetCount() - begin;
+  int max_count = last ? remaining : remaining - 1;
+  ASSERT(max_count >= 1, "No entry left to build the page from.");
+  int target_count = std::max(static_cast<int>(GetMaxSize() * fill_factor), IsLeafPage() ? 1 : 2);
+  int target_size = static_cast<int>(DATA_SIZE * fill_factor);
+  std::vector<char> separator(GetKeySize());
+  auto upper_fence = [&](int count) -> const GenericKey * {
+    if (begin + count == list.GetCount()) {
+      return nullptr;
+    }
+    MakeSeparator(list, begin + count, reinterpret_cast<GenericKey *>(separator.data()));
+    return reinterpret_cast<GenericKey *>(separator.data());
+  };
+  auto fits = [&](int count) {
+    if (count > target_count) {
+      return false;
+    }
+    int size = EncodedSize(list, begin, begin + count, lower, upper_fence(count));
+    return size <= target_size && CanHold(count, size);
+  };
+  // an internal page routes to two children at least
+  int left = std::min(max_count, IsLeafPage() ? 1 : 2);
+  int right = max_count;
+  while (left < right) {
+    int mid = (left + right + 1) / 2;
+    if (fits(mid)) {
+      left = mid;
+    } else {
+      right = mid - 1;
+    }
+  }
+  int count = left;
+  if (last && count < remaining && remaining - count < count / 2) {
+    count = (remaining + 1) / 2;
+  }
+  const GenericKey *upper_key = upper_fence(count);
+  Build(list, begin, begin + count, lower, upper_key);
+  if (upper_key != nullptr) {
+    memcpy(upper, upper_key, GetKeySize());
+  }
+  return count;
+}
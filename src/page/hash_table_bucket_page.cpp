@@ -0,0 +1,40 @@
+#include "page/hash_table_bucket_page.h"
+
+#include <cstring>
+
+void HashTableBucketPage::Init(page_id_t page_id, int key_size) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  key_size_ = key_size;
+  size_ = 0;
+}
+
+RowId HashTableBucketPage::ValueAt(int index) const {
+  RowId value;
+  memcpy(&value, EntryAt(index) + key_size_, sizeof(RowId));
+  return value;
+}
+
+int HashTableBucketPage::Find(const GenericKey *key, const RowId *value, const KeyManager &KM) const {
+  for (int i = 0; i < size_; i++) {
+    if (KM.CompareKeys(KeyAt(i), key) == 0 && (value == nullptr || ValueAt(i) == *value)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void HashTableBucketPage::Append(const GenericKey *key, const RowId &value) {
+  ASSERT(!IsFull(), "Append to a full hash bucket.");
+  char *entry = EntryAt(size_);
+  memcpy(entry, key, key_size_);
+  memcpy(entry + key_size_, &value, sizeof(RowId));
+  size_++;
+}
+
+void HashTableBucketPage::RemoveAt(int index) {
+  size_--;
+  if (index != size_) {
+    memcpy(EntryAt(index), EntryAt(size_), GetEntrySize());
+  }
+}
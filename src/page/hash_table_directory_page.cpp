@@ -0,0 +1,49 @@
+#include "page/hash_table_directory_page.h"
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+  page_id_ = page_id;
+  global_depth_ = 0;
+  local_depths_[0] = 0;
+  bucket_page_ids_[0] = bucket_page_id;
+}
+
+bool HashTableDirectoryPage::Grow() {
+  if (global_depth_ == MAX_DEPTH) {
+    return false;
+  }
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    local_depths_[i + size] = local_depths_[i];
+    bucket_page_ids_[i + size] = bucket_page_ids_[i];
+  }
+  global_depth_++;
+  return true;
+}
+
+void HashTableDirectoryPage::ShrinkAll() {
+  while (global_depth_ > 0) {
+    for (uint32_t i = 0; i < Size(); i++) {
+      if (local_depths_[i] == global_depth_) {
+        return;
+      }
+    }
+    // the upper half mirrors the lower one now
+    global_depth_--;
+  }
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  uint32_t local_depth = local_depths_[bucket_idx];
+  if (local_depth == 0) {
+    return bucket_idx;
+  }
+  return (bucket_idx ^ (1u << (local_depth - 1))) & ((1u << local_depth) - 1);
+}
+
+void HashTableDirectoryPage::SetBucket(uint32_t bucket_idx, uint32_t local_depth, page_id_t bucket_page_id) {
+  uint32_t low_bits = bucket_idx & ((1u << local_depth) - 1);
+  for (uint32_t i = low_bits; i < Size(); i += 1u << local_depth) {
+    local_depths_[i] = static_cast<uint8_t>(local_depth);
+    bucket_page_ids_[i] = bucket_page_id;
+  }
+}
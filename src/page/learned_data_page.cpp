@@ -0,0 +1,18 @@
+#include "page/learned_data_page.h"
+
+#include "common/macros.h"
+
+void LearnedDataPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+  reserved_ = 0;
+}
+
+RowId LearnedDataPage::ValueAt(uint32_t index) const { return RowId(entries_[index].value_); }
+
+void LearnedDataPage::Append(uint64_t key, const RowId &value) {
+  ASSERT(!IsFull(), "Append to a full learned data page.");
+  ASSERT(size_ == 0 || entries_[size_ - 1].key_ <= key, "Keys of a learned data page must be in order.");
+  entries_[size_++] = {key, value.Get()};
+}
@@ -0,0 +1,38 @@
+#include "page/lsm_run_page.h"
+
+#include <cstring>
+
+void LsmRunPage::Init(page_id_t page_id, int key_size) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  key_size_ = key_size;
+  size_ = 0;
+}
+
+RowId LsmRunPage::ValueAt(int index) const {
+  RowId value;
+  memcpy(&value, EntryAt(index) + key_size_, sizeof(RowId));
+  return value;
+}
+
+int LsmRunPage::KeyIndex(const GenericKey *key, const KeyManager &KM) const {
+  int low = 0;
+  int high = size_;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (KM.CompareKeys(KeyAt(mid), key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+void LsmRunPage::Append(const GenericKey *key, const RowId &value) {
+  ASSERT(!IsFull(), "Append to a full LSM run page.");
+  char *entry = EntryAt(size_);
+  memcpy(entry, key, key_size_);
+  memcpy(entry + key_size_, &value, sizeof(RowId));
+  size_++;
+}
@@ -0,0 +1,22 @@
+#include "page/overflow_page.h"
+
+#include <algorithm>
+
+void OverflowPage::Init(page_id_t next_page_id) {
+  memcpy(GetData(), &next_page_id, sizeof(page_id_t));
+  uint32_t size = 0;
+  memcpy(GetData() + OFFSET_DATA_SIZE, &size, sizeof(uint32_t));
+}
+
+uint32_t OverflowPage::WriteData(const char *data, uint32_t size) {
+  size = std::min(size, MAX_DATA_SIZE);
+  memcpy(GetData() + OFFSET_DATA, data, size);
+  memcpy(GetData() + OFFSET_DATA_SIZE, &size, sizeof(uint32_t));
+  return size;
+}
+
+uint32_t OverflowPage::ReadData(char *buf) {
+  uint32_t size = GetDataSize();
+  memcpy(buf, GetData() + OFFSET_DATA, size);
+  return size;
+}
@@ -0,0 +1,211 @@
+#include "page/pax_page.h"
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_id, Schema *schema, LogManager *log_mgr, Txn *txn) {
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  uint32_t lsn = 0;
+  memcpy(GetData() + sizeof(page_id), &lsn, sizeof(lsn));
+  SetPrevPageId(prev_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetTupleCount(0);
+  SetCapacity(ComputeCapacity(schema));
+  memset(GetData() + OFFSET_SLOTS, SLOT_EMPTY, GetCapacity());
+}
+
+uint32_t PaxPage::ComputeCapacity(const Schema *schema) {
+  // one slot state byte, then one null flag and one value per column
+  uint32_t tuple_width = 1;
+  for (auto column : schema->GetColumns()) {
+    tuple_width += 1 + GetColumnWidth(column);
+  }
+  return (PAGE_SIZE - SIZE_PAX_PAGE_HEADER) / tuple_width;
+}
+
+uint32_t PaxPage::GetColumnWidth(const Column *column) {
+  if (column->GetType() == TypeId::kTypeChar) {
+    return sizeof(uint32_t) + column->GetLength();
+  }
+  return column->GetLength();
+}
+
+uint32_t PaxPage::GetColumnOffset(const Schema *schema, uint32_t column_id) {
+  uint32_t capacity = GetCapacity();
+  uint32_t offset = OFFSET_SLOTS + capacity;
+  for (uint32_t i = 0; i < column_id; i++) {
+    offset += capacity * (1 + GetColumnWidth(schema->GetColumn(i)));
+  }
+  return offset;
+}
+
+bool PaxPage::FitsColumns(const Row &row, const Schema *schema) {
+  ASSERT(row.GetFieldCount() == schema->GetColumnCount(), "Fields count mismatch.");
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Field *field = row.GetField(i);
+    if (!field->IsNull() && field->GetSerializedSize() > GetColumnWidth(schema->GetColumn(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PaxPage::WriteFields(const Row &row, Schema *schema, uint32_t slot_num) {
+  // Values are padded to the column width, reject the ones exceeding it before touching the page.
+  if (!FitsColumns(row, schema)) {
+    return false;
+  }
+  uint32_t capacity = GetCapacity();
+  uint32_t column_offset = OFFSET_SLOTS + capacity;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Field *field = row.GetField(i);
+    uint32_t width = GetColumnWidth(schema->GetColumn(i));
+    GetData()[column_offset + slot_num] = field->IsNull() ? 1 : 0;
+    if (!field->IsNull()) {
+      field->SerializeTo(GetData() + column_offset + capacity + slot_num * width);
+    }
+    column_offset += capacity * (1 + width);
+  }
+  return true;
+}
+
+void PaxPage::ReadField(const Schema *schema, uint32_t column_id, uint32_t column_offset, uint32_t slot_num,
+                        Field *field) {
+  const Column *column = schema->GetColumn(column_id);
+  bool is_null = GetData()[column_offset + slot_num] != 0;
+  char *value = GetData() + column_offset + GetCapacity() + slot_num * GetColumnWidth(column);
+  Field::DeserializeFrom(value, column->GetType(), field, is_null);
+}
+
+bool PaxPage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
+  // Try to find a free slot to reuse, otherwise claim a new one.
+  uint32_t i;
+  for (i = 0; i < GetTupleCount(); i++) {
+    if (GetSlotState(i) == SLOT_EMPTY) {
+      break;
+    }
+  }
+  if (i == GetCapacity()) {
+    return false;
+  }
+  if (!WriteFields(row, schema, i)) {
+    return false;
+  }
+  SetSlotState(i, SLOT_LIVE);
+  row.SetRowId(RowId(GetTablePageId(), i));
+  if (i == GetTupleCount()) {
+    SetTupleCount(GetTupleCount() + 1);
+  }
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetSlotState(slot_num) != SLOT_LIVE) {
+    return false;
+  }
+  SetSlotState(slot_num, SLOT_DELETED);
+  return true;
+}
+
+bool PaxPage::UpdateTuple(Row &new_row, Row *old_row, Schema *schema, Txn *txn, LockManager *lock_manager,
+                          LogManager *log_manager) {
+  ASSERT(old_row != nullptr && old_row->GetRowId().Get() != INVALID_ROWID.Get(), "invalid old row.");
+  uint32_t slot_num = old_row->GetRowId().GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetSlotState(slot_num) != SLOT_LIVE) {
+    return false;
+  }
+  // Copy out the old value, then overwrite the slot in place: every value has a fixed width.
+  GetTuple(old_row, schema, txn, lock_manager);
+  return WriteFields(new_row, schema, slot_num);
+}
+
+void PaxPage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+  SetSlotState(slot_num, SLOT_EMPTY);
+}
+
+void PaxPage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+  if (GetSlotState(slot_num) == SLOT_DELETED) {
+    SetSlotState(slot_num, SLOT_LIVE);
+  }
+}
+
+bool PaxPage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager) {
+  ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
+  uint32_t slot_num = row->GetRowId().GetSlotNum();
+  if (slot_num >= GetTupleCount() || GetSlotState(slot_num) != SLOT_LIVE) {
+    return false;
+  }
+  ASSERT(row->GetFields().empty(), "Row to read into should be empty.");
+  uint32_t column_offset = OFFSET_SLOTS + GetCapacity();
+  row->GetFields().reserve(schema->GetColumnCount());
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    row->GetFields().emplace_back(schema->GetColumn(i)->GetType());
+    ReadField(schema, i, column_offset, slot_num, &row->GetFields().back());
+    column_offset += GetCapacity() * (1 + GetColumnWidth(schema->GetColumn(i)));
+  }
+  return true;
+}
+
+bool PaxPage::GetFirstTupleRid(RowId *first_rid) {
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetSlotState(i) == SLOT_LIVE) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
+  ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
+    if (GetSlotState(i) == SLOT_LIVE) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+void PaxPage::Compact(Txn *txn, LogManager *log_manager) {
+  uint32_t tuple_count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetSlotState(i) == SLOT_DELETED) {
+      SetSlotState(i, SLOT_EMPTY);
+    } else if (GetSlotState(i) == SLOT_LIVE) {
+      tuple_count = i + 1;
+    }
+  }
+  SetTupleCount(tuple_count);
+}
+
+uint32_t PaxPage::GetLiveTupleCount() {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetSlotState(i) == SLOT_LIVE) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void PaxPage::GetLiveSlots(std::vector<uint32_t> *slots) {
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetSlotState(i) == SLOT_LIVE) {
+      slots->push_back(i);
+    }
+  }
+}
+
+void PaxPage::GetColumn(Schema *schema, uint32_t column_id, const std::vector<uint32_t> &slots,
+                        std::vector<Row> *rows) {
+  ASSERT(slots.size() == rows->size(), "Each slot needs a row to read into.");
+  uint32_t column_offset = GetColumnOffset(schema, column_id);
+  for (size_t i = 0; i < slots.size(); i++) {
+    ReadField(schema, column_id, column_offset, slots[i], (*rows)[i].GetField(column_id));
+  }
+}
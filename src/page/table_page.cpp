@@ -207,3 +207,47 @@ bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+void TablePage::GetDeletedTuples(Schema *schema, std::vector<Row> *rows) {
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size == 0 || !IsDeleted(tuple_size)) {
+      continue;
+    }
+    rows->emplace_back(RowId(GetTablePageId(), i));
+    rows->back().DeserializeFrom(GetData() + GetTupleOffsetAtSlot(i), schema);
+  }
+}
+
+void TablePage::Compact(Txn *txn, LogManager *log_manager) {
+  // Copy the page out and write the live tuples back contiguously from the end of the page.
+  char buf[PAGE_SIZE];
+  memcpy(buf, GetData(), PAGE_SIZE);
+  uint32_t free_space_pointer = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER;
+  uint32_t tuple_count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size)) {
+      SetTupleSize(i, 0);
+      SetTupleOffsetAtSlot(i, 0);
+      continue;
+    }
+    free_space_pointer -= tuple_size;
+    memcpy(GetData() + free_space_pointer, buf + GetTupleOffsetAtSlot(i), tuple_size);
+    SetTupleOffsetAtSlot(i, free_space_pointer);
+    tuple_count = i + 1;
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  // Trailing empty slots are not referenced by any RowId, give them back.
+  SetTupleCount(tuple_count);
+}
+
+uint32_t TablePage::GetLiveTupleCount() {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (!IsDeleted(GetTupleSize(i))) {
+      count++;
+    }
+  }
+  return count;
+}
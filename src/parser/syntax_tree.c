@@ -171,6 +171,10 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeVacuum:
+      return "kNodeVacuum";
+    case kNodeTableLayout:
+      return "kNodeTableLayout";
     default:
       return "error type";
   }
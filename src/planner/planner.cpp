@@ -3,6 +3,8 @@
 //
 #include "planner/planner.h"
 
+#include "index/skip_scan_iterator.h"
+
 void Planner::PlanQuery(pSyntaxNode ast) {
   switch (ast->type_) {
     case kNodeSelect: {
@@ -38,21 +40,37 @@ AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> stateme
   vector<IndexInfo *> indexes;
   vector<IndexInfo *> available_index;
   context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
+  // 哈希索引只能回答等值查询
+  vector<uint32_t> equality_columns;
+  if (statement->where_ != nullptr && !statement->has_or) {
+    CollectEqualityColumns(statement->where_, equality_columns);
+  }
   for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
-        available_index.push_back(index);
-      }
+    if (IsIndexUsable(index, statement->column_in_condition_, equality_columns)) {
+      available_index.push_back(index);
     }
   }
   if (available_index.empty() || statement->has_or) {
     return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
   }
+  // 查询用到的列都在索引键里时，直接从叶子页取值，不再回表
+  vector<IndexInfo *> covering_index;
+  for (auto index : available_index) {
+    const auto &key_map = index->GetKeyProjector().GetKeyMap();
+    auto in_key = [&key_map](uint32_t col_id) {
+      return std::find(key_map.begin(), key_map.end(), col_id) != key_map.end();
+    };
+    bool covered = std::all_of(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), in_key);
+    for (const auto &column : statement->column_list_) {
+      covered = covered && in_key(dynamic_pointer_cast<ColumnValueExpression>(column.second)->GetColIdx());
+    }
+    if (covered) {
+      covering_index.push_back(index);
+    }
+  }
   return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
                                         available_index.size() != statement->column_in_condition_.size(),
-                                        statement->where_);
+                                        statement->where_, covering_index);
 }
 
 AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> statement) {
@@ -75,6 +93,42 @@ AbstractPlanNodeRef Planner::PlanUpdate(std::shared_ptr<UpdateStatement> stateme
                                           statement->update_attrs);
 }
 
+void Planner::CollectEqualityColumns(const AbstractExpressionRef &predicate, std::vector<uint32_t> &columns) {
+  if (predicate->GetType() == ExpressionType::LogicExpression) {
+    CollectEqualityColumns(predicate->GetChildAt(0), columns);
+    CollectEqualityColumns(predicate->GetChildAt(1), columns);
+    return;
+  }
+  if (predicate->GetType() != ExpressionType::ComparisonExpression ||
+      dynamic_pointer_cast<ComparisonExpression>(predicate)->GetComparisonType() != "=" ||
+      predicate->GetChildAt(1)->GetType() != ExpressionType::ConstantExpression) {
+    return;
+  }
+  auto column = dynamic_pointer_cast<ColumnValueExpression>(predicate->GetChildAt(0));
+  if (column != nullptr) {
+    columns.push_back(column->GetColIdx());
+  }
+}
+
+bool Planner::IsIndexUsable(IndexInfo *index, const std::vector<uint32_t> &condition_columns,
+                            const std::vector<uint32_t> &equality_columns) {
+  const auto &key_map = index->GetKeyProjector().GetKeyMap();
+  auto has = [](const std::vector<uint32_t> &columns, uint32_t col_id) {
+    return std::find(columns.begin(), columns.end(), col_id) != columns.end();
+  };
+  if (index->GetIndexType() == "hash") {
+    return std::all_of(key_map.begin(), key_map.end(),
+                       [&](uint32_t col_id) { return has(equality_columns, col_id); });
+  }
+  if (has(condition_columns, key_map[0])) {
+    return true;
+  }
+  // 首列不在条件里时，只有它的取值足够少才值得跳跃扫描
+  bool later = std::any_of(key_map.begin() + 1, key_map.end(),
+                           [&](uint32_t col_id) { return has(condition_columns, col_id); });
+  return later && SkipScanIterator::CountValues(index->GetIndex(), SKIP_SCAN_MAX_VALUES) <= SKIP_SCAN_MAX_VALUES;
+}
+
 Schema *Planner::MakeOutputSchema(const vector<std::pair<std::string, AbstractExpressionRef>> &exprs) {
   std::vector<Column *> cols;
   cols.reserve(exprs.size());
@@ -15,20 +15,20 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   MACH_WRITE_UINT32(pos, field_count);
   pos += sizeof(uint32_t);
 
-  // 生成并写入null_bitmap:来记录哪些字段为空
-  std::vector<uint8_t> null_bitmap(bitmap_bytes_count, 0);
+  // 直接在buf上生成null_bitmap:来记录哪些字段为空
+  uint8_t *null_bitmap = reinterpret_cast<uint8_t *>(pos);
+  memset(null_bitmap, 0, bitmap_bytes_count);
   for (uint32_t i = 0; i < field_count; ++i) {
-    if (fields_[i]->IsNull()) {
+    if (fields_[i].IsNull()) {
       null_bitmap[i / 8] |= (1 << (i % 8));
     }
   }
-  memcpy(pos, null_bitmap.data(), bitmap_bytes_count);
   pos += bitmap_bytes_count;
 
   // 序列化
   for (uint32_t i = 0; i < field_count; ++i) {
-    if (!fields_[i]->IsNull()) {
-      uint32_t move = fields_[i]->SerializeTo(pos);
+    if (!fields_[i].IsNull()) {
+      uint32_t move = fields_[i].SerializeTo(pos);
       pos += move;
     }
   }
@@ -48,19 +48,19 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   pos += sizeof(uint32_t);
   ASSERT(field_count == schema->GetColumnCount(), "Fields in deserialization count dismatch!");
 
-  // 读取null_bitmap
+  // null_bitmap直接在buf上读取
   uint32_t bitmap_bytes_count = (field_count + 7) / 8; // 向上取整
-  std::vector<uint8_t> null_bitmap(bitmap_bytes_count);
-  memcpy(null_bitmap.data(), pos, bitmap_bytes_count);
+  const uint8_t *null_bitmap = reinterpret_cast<const uint8_t *>(pos);
   pos += bitmap_bytes_count;
 
-  //反序列化字段
+  //反序列化字段，直接构造在fields_中
+  fields_.reserve(field_count);
   for (uint32_t i = 0; i < field_count; ++i) {
     bool is_null = (null_bitmap[i / 8] >> (i % 8)) & 1; // 判断是否为空
-    Field *field = nullptr;
-    uint32_t move = Field::DeserializeFrom(pos, schema->GetColumn(i)->GetType(), &field, is_null); // 注意Filed::,调用的是Field类的静态函数
+    TypeId type = schema->GetColumn(i)->GetType();
+    fields_.emplace_back(type);
+    uint32_t move = Field::DeserializeFrom(pos, type, &fields_.back(), is_null); // 注意Filed::,调用的是Field类的静态函数
     pos += move;
-    fields_.push_back(field);
   }
 
   return pos - buf;
@@ -81,14 +81,26 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
   size += bitmap_bytes_count; 
 
   for (uint32_t i = 0; i < field_count; ++i) {
-    if (!fields_[i]->IsNull()) {
-      size += fields_[i]->GetSerializedSize();
+    if (!fields_[i].IsNull()) {
+      size += fields_[i].GetSerializedSize();
     }
   }
 
   return size;
 }
 
+const Column *Row::GetOverlongColumn(const Schema *schema) const {
+  ASSERT(schema->GetColumnCount() == fields_.size(), "Fields count mismatch.");
+  for (uint32_t i = 0; i < fields_.size(); i++) {
+    const Column *column = schema->GetColumn(i);
+    if (column->GetType() == TypeId::kTypeChar && !fields_[i].IsNull() &&
+        fields_[i].GetLength() > column->GetLength()) {
+      return column;
+    }
+  }
+  return nullptr;
+}
+
 /**
 * TODO: Student Implement
 */
@@ -96,11 +108,12 @@ void Row::GetKeyFromRow(const Schema *source_schema, const Schema *key_schema, R
   // 只提取key的字段，source_schema -> key_schema
   auto key_columns = key_schema->GetColumns();
   std::vector<Field> fields;
+  fields.reserve(key_columns.size());
   uint32_t idx;
 
   for (const auto& column : key_columns) {
     source_schema->GetColumnIndex(column->GetName(), idx);
     fields.emplace_back(*this->GetField(idx));
   }
-  key_row = Row(fields);
+  key_row = Row(std::move(fields));
 }
\ No newline at end of file
@@ -15,6 +15,20 @@ inline int CompareStrings(const char *str1, int len1, const char *str2, int len2
   return ret;
 }
 
+// Index keys are compared with memcmp, so fixed width values are written big-endian.
+inline void WriteKeyUint32(char *buf, uint32_t val) {
+  buf[0] = static_cast<char>(val >> 24);
+  buf[1] = static_cast<char>(val >> 16);
+  buf[2] = static_cast<char>(val >> 8);
+  buf[3] = static_cast<char>(val);
+}
+
+inline uint32_t ReadKeyUint32(const char *buf) {
+  auto *bytes = reinterpret_cast<const uint8_t *>(buf);
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
 // ==============================Type=============================
 
 Type *Type::type_singletons_[] = {new Type(TypeId::kTypeInvalid), new TypeInt(), new TypeFloat(), new TypeChar()};
@@ -24,7 +38,7 @@ uint32_t Type::SerializeTo(const Field &field, char *buf) const {
   return 0;
 }
 
-uint32_t Type::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t Type::DeserializeFrom(char *storage, Field *field, bool is_null) const {
   ASSERT(false, "DeserializeFrom not implemented.");
   return 0;
 }
@@ -34,6 +48,14 @@ uint32_t Type::GetSerializedSize(const Field &field, bool is_null) const {
   return 0;
 }
 
+void Type::SerializeKeyTo(const Field &, char *, uint32_t) const {
+  ASSERT(false, "SerializeKeyTo not implemented.");
+}
+
+void Type::DeserializeKeyFrom(const char *, uint32_t, Field *) const {
+  ASSERT(false, "DeserializeKeyFrom not implemented.");
+}
+
 const char *Type::GetData(const Field &val) const {
   ASSERT(false, "GetData not implemented.");
   return nullptr;
@@ -84,13 +106,13 @@ uint32_t TypeInt::SerializeTo(const Field &field, char *buf) const {
   return 0;
 }
 
-uint32_t TypeInt::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t TypeInt::DeserializeFrom(char *storage, Field *field, bool is_null) const {
   if (is_null) {
-    *field = new Field(TypeId::kTypeInt);
+    *field = Field(TypeId::kTypeInt);
     return 0;
   }
   int32_t val = MACH_READ_FROM(int32_t, storage);
-  *field = new Field(TypeId::kTypeInt, val);
+  *field = Field(TypeId::kTypeInt, val);
   return GetTypeSize(type_id_);
 }
 
@@ -101,6 +123,15 @@ uint32_t TypeInt::GetSerializedSize(const Field &field, bool is_null) const {
   return GetTypeSize(type_id_);
 }
 
+void TypeInt::SerializeKeyTo(const Field &field, char *buf, [[maybe_unused]] uint32_t width) const {
+  // flip the sign bit so that negative values sort before positive ones
+  WriteKeyUint32(buf, static_cast<uint32_t>(field.value_.integer_) ^ 0x80000000U);
+}
+
+void TypeInt::DeserializeKeyFrom(const char *storage, [[maybe_unused]] uint32_t width, Field *field) const {
+  *field = Field(TypeId::kTypeInt, static_cast<int32_t>(ReadKeyUint32(storage) ^ 0x80000000U));
+}
+
 CmpBool TypeInt::CompareEquals(const Field &left, const Field &right) const {
   ASSERT(left.CheckComparable(right), "Not comparable.");
   if (left.IsNull() || right.IsNull()) {
@@ -159,13 +190,13 @@ uint32_t TypeFloat::SerializeTo(const Field &field, char *buf) const {
   return 0;
 }
 
-uint32_t TypeFloat::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t TypeFloat::DeserializeFrom(char *storage, Field *field, bool is_null) const {
   if (is_null) {
-    *field = new Field(TypeId::kTypeFloat);
+    *field = Field(TypeId::kTypeFloat);
     return 0;
   }
   float_t val = MACH_READ_FROM(float_t, storage);
-  *field = new Field(TypeId::kTypeFloat, val);
+  *field = Field(TypeId::kTypeFloat, val);
   return GetTypeSize(type_id_);
 }
 
@@ -176,6 +207,24 @@ uint32_t TypeFloat::GetSerializedSize(const Field &field, bool is_null) const {
   return GetTypeSize(type_id_);
 }
 
+void TypeFloat::SerializeKeyTo(const Field &field, char *buf, [[maybe_unused]] uint32_t width) const {
+  // -0.0 equals 0.0, give both the same key
+  float_t val = field.value_.float_ == 0 ? 0 : field.value_.float_;
+  uint32_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  // negative: invert all bits so that larger magnitudes sort first; positive: set the sign bit
+  bits = (bits & 0x80000000U) ? ~bits : bits | 0x80000000U;
+  WriteKeyUint32(buf, bits);
+}
+
+void TypeFloat::DeserializeKeyFrom(const char *storage, [[maybe_unused]] uint32_t width, Field *field) const {
+  uint32_t bits = ReadKeyUint32(storage);
+  bits = (bits & 0x80000000U) ? bits & ~0x80000000U : ~bits;
+  float_t val;
+  memcpy(&val, &bits, sizeof(val));
+  *field = Field(TypeId::kTypeFloat, val);
+}
+
 CmpBool TypeFloat::CompareEquals(const Field &left, const Field &right) const {
   ASSERT(left.CheckComparable(right), "Not comparable.");
   if (left.IsNull() || right.IsNull()) {
@@ -226,22 +275,35 @@ CmpBool TypeFloat::CompareGreaterThanEquals(const Field &left, const Field &righ
 
 // ==============================TypeChar=============================
 uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
+  if (!field.IsNull() && field.IsOverflow()) {
+    // overflow reference: flagged length followed by the first overflow page
+    uint32_t len = GetLength(field) | OVERFLOW_LEN_FLAG;
+    page_id_t page_id = field.GetOverflowPageId();
+    memcpy(buf, &len, sizeof(uint32_t));
+    memcpy(buf + sizeof(uint32_t), &page_id, sizeof(page_id_t));
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
   if (!field.IsNull()) {
     uint32_t len = GetLength(field);
     memcpy(buf, &len, sizeof(uint32_t));
-    memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
+    memcpy(buf + sizeof(uint32_t), field.CharData(), len);
     return len + sizeof(uint32_t);
   }
   return 0;
 }
 
-uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t TypeChar::DeserializeFrom(char *storage, Field *field, bool is_null) const {
   if (is_null) {
-    *field = new Field(TypeId::kTypeChar);
+    *field = Field(TypeId::kTypeChar);
     return 0;
   }
   uint32_t len = MACH_READ_UINT32(storage);
-  *field = new Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  if (len & OVERFLOW_LEN_FLAG) {
+    page_id_t page_id = MACH_READ_FROM(page_id_t, storage + sizeof(uint32_t));
+    *field = Field(TypeId::kTypeChar, len & ~OVERFLOW_LEN_FLAG, page_id);
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
+  *field = Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
   return len + sizeof(uint32_t);
 }
 
@@ -249,12 +311,32 @@ uint32_t TypeChar::GetSerializedSize(const Field &field, bool is_null) const {
   if (is_null) {
     return 0;
   }
+  if (field.IsOverflow()) {
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
   uint32_t len = GetLength(field);
   return len + sizeof(uint32_t);
 }
 
+/*
+ * Stored values are never longer than the column (see Row::GetOverlongColumn), only a query bound can be. Such a
+ * bound is cut to the column length, which changes its meaning: a caller passing one has to widen its range to
+ * take in the cut key and recheck the values it reads.
+ */
+void TypeChar::SerializeKeyTo(const Field &field, char *buf, uint32_t width) const {
+  // padded with '\0' to the column length, a shorter string sorts before its extensions
+  ASSERT(!field.IsOverflow(), "Overflow value can not be an index key.");
+  uint32_t len = std::min(GetLength(field), width);
+  memcpy(buf, field.CharData(), len);
+  memset(buf + len, 0, width - len);
+}
+
+void TypeChar::DeserializeKeyFrom(const char *storage, uint32_t width, Field *field) const {
+  *field = Field(TypeId::kTypeChar, const_cast<char *>(storage), strnlen(storage, width), true);
+}
+
 const char *TypeChar::GetData(const Field &val) const {
-  return val.value_.chars_;
+  return val.CharData();
 }
 
 uint32_t TypeChar::GetLength(const Field &val) const {
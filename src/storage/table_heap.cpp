@@ -1,19 +1,47 @@
 #include "storage/table_heap.h"
 
-/**
- * TODO: Student Implement
- */
 bool TableHeap::InsertTuple(Row &row, Txn *txn) {
-  if (row.GetSerializedSize(schema_) >= TablePage::SIZE_MAX_ROW){
+  if (layout_ == TableLayout::kPax) {
+    // 放不进任何一页的行要在遍历和新建页之前拒绝，否则每次插入都会留下一个空页
+    if (PaxPage::ComputeCapacity(schema_) == 0 || !PaxPage::FitsColumns(row, schema_)) {
+      LOG(WARNING) << "Row for insert out of size.";
+      return false;
+    }
+    return InsertTupleImpl<PaxPage>(row, txn);
+  }
+  Row stored_row;
+  if (!MoveOverflowFields(row, &stored_row)) {
+    if (row.GetSerializedSize(schema_) >= TablePage::SIZE_MAX_ROW) {
+      LOG(WARNING) << "Row for insert out of size.";
+      return false;
+    }
+    return InsertTupleImpl<TablePage>(row, txn);
+  }
+  // 长字段已写入溢出页，页内只存引用
+  if (stored_row.GetSerializedSize(schema_) >= TablePage::SIZE_MAX_ROW) {
     LOG(WARNING) << "Row for insert out of size.";
+    FreeOverflowFields(stored_row, &row);
+    return false;
+  }
+  if (!InsertTupleImpl<TablePage>(stored_row, txn)) {
+    FreeOverflowFields(stored_row, &row);
     return false;
   }
+  row.SetRowId(stored_row.GetRowId());
+  return true;
+}
+
+/**
+ * TODO: Student Implement
+ */
+template <typename PageType>
+bool TableHeap::InsertTupleImpl(Row &row, Txn *txn) {
   page_id_t p = first_page_id_;
   page_id_t last_p = first_page_id_; //	last_p 记录当前页的前一个页，用于在插入失败后创建新页并连接链表尾部
 
   bool ok;
   while (p != INVALID_PAGE_ID) {
-    TablePage *page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(p));
+    auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(p));
     page->WLatch(); // 加写锁
     ok = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
     page->WUnlatch(); // 解锁
@@ -33,14 +61,14 @@ bool TableHeap::InsertTuple(Row &row, Txn *txn) {
 
   // 没找到插入位置，新建一页
   page_id_t new_page_id;
-  auto new_page_ = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  auto new_page_ = reinterpret_cast<PageType *>(buffer_pool_manager_->NewPage(new_page_id));
   if (new_page_ == nullptr) return false;
 
   // 初始化新页
-  new_page_->Init(new_page_id, last_p, log_manager_, txn);
+  InitPage(new_page_, new_page_id, last_p, txn);
   if (last_p != INVALID_PAGE_ID) {
     // 连接页
-    auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_p));
+    auto last_page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(last_p));
     last_page->WLatch();
     last_page->SetNextPageId(new_page_id);
     last_page->WUnlatch();
@@ -59,30 +87,73 @@ bool TableHeap::InsertTuple(Row &row, Txn *txn) {
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  return layout_ == TableLayout::kPax ? MarkDeleteImpl<PaxPage>(rid, txn) : MarkDeleteImpl<TablePage>(rid, txn);
+}
+
+template <typename PageType>
+bool TableHeap::MarkDeleteImpl(const RowId &rid, Txn *txn) {
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
     return false;
   }
 
   // 标记删除
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  bool ok = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (ok) {
+    dead_tuple_count_++;
+  }
+  return true;
+}
+
+bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
+  if (layout_ == TableLayout::kPax) {
+    // 新值放不进的话，旧行会被删掉而新行插不进去
+    if (!PaxPage::FitsColumns(row, schema_)) {
+      LOG(WARNING) << "Row for update out of size.";
+      return false;
+    }
+    return UpdateTupleImpl<PaxPage>(row, rid, txn);
+  }
+  // 还是引用的字段可能指向旧tuple的溢出页，先读出来，新旧版本不共享溢出页
+  Row loaded_row;
+  Row *source = &row;
+  for (const auto &field : row.GetFields()) {
+    if (!field.IsNull() && field.IsOverflow()) {
+      loaded_row = row;
+      LoadOverflowFields(&loaded_row);
+      source = &loaded_row;
+      break;
+    }
+  }
+  Row stored_row;
+  if (!MoveOverflowFields(*source, &stored_row)) {
+    bool ok = UpdateTupleImpl<TablePage>(*source, rid, txn);
+    row.SetRowId(source->GetRowId());
+    return ok;
+  }
+  if (!UpdateTupleImpl<TablePage>(stored_row, rid, txn)) {
+    FreeOverflowFields(stored_row);
+    return false;
+  }
+  row.SetRowId(stored_row.GetRowId());
   return true;
 }
 
 /**
  * TODO: Student Implement
  */
-bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
+template <typename PageType>
+bool TableHeap::UpdateTupleImpl(Row &row, const RowId &rid, Txn *txn) {
   if (rid.GetPageId() == INVALID_PAGE_ID) {
     LOG(WARNING) << "UpdateTuple called with invalid RowId.";
     return false;
   }
   
   // 目标页
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) return false;
 
   Row old_row_(rid); // 用于日志更新，记录旧数据
@@ -95,6 +166,8 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
 
   // 更新失败，标记删除，插入一个新的
   if (ok) {
+    // 旧tuple的溢出页不再被引用
+    FreeOverflowFields(old_row_, &row);
     row.SetRowId(rid);
     return true;
   } else {
@@ -103,14 +176,39 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
   }
 }
 
+void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
+  if (layout_ == TableLayout::kPax) {
+    ApplyDeleteImpl<PaxPage>(rid, txn);
+    return;
+  }
+  // 先释放tuple的溢出页：提交删除时tuple已被标记删除，回滚插入时tuple仍有效
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  assert(page != nullptr);
+  Row row(rid);
+  if (page->GetTuple(&row, schema_, txn, lock_manager_)) {
+    FreeOverflowFields(row);
+  } else {
+    std::vector<Row> deleted_rows;
+    page->GetDeletedTuples(schema_, &deleted_rows);
+    for (auto &deleted_row : deleted_rows) {
+      if (deleted_row.GetRowId() == rid) {
+        FreeOverflowFields(deleted_row);
+      }
+    }
+  }
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  ApplyDeleteImpl<TablePage>(rid, txn);
+}
+
 /**
  * TODO: Student Implement
  */
-void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
+template <typename PageType>
+void TableHeap::ApplyDeleteImpl(const RowId &rid, Txn *txn) {
   //目标页
   Page *page_id = buffer_pool_manager_->FetchPage(rid.GetPageId());
   assert(page_id != nullptr);
-  auto page = reinterpret_cast<TablePage *>(page_id);
+  auto page = reinterpret_cast<PageType *>(page_id);
 
   //删除tuple
   page->WLatch();
@@ -121,8 +219,17 @@ void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Txn *txn) {
+  if (layout_ == TableLayout::kPax) {
+    RollbackDeleteImpl<PaxPage>(rid, txn);
+  } else {
+    RollbackDeleteImpl<TablePage>(rid, txn);
+  }
+}
+
+template <typename PageType>
+void TableHeap::RollbackDeleteImpl(const RowId &rid, Txn *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
   // Rollback to delete.
   page->WLatch();
@@ -131,14 +238,28 @@ void TableHeap::RollbackDelete(const RowId &rid, Txn *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
+bool TableHeap::GetTuple(Row *row, Txn *txn, bool load_overflow) {
+  if (layout_ == TableLayout::kPax) {
+    return GetTupleImpl<PaxPage>(row, txn);
+  }
+  if (!GetTupleImpl<TablePage>(row, txn)) {
+    return false;
+  }
+  if (load_overflow) {
+    LoadOverflowFields(row);
+  }
+  return true;
+}
+
 /**
  * TODO: Student Implement
  */
-bool TableHeap::GetTuple(Row *row, Txn *txn) {
+template <typename PageType>
+bool TableHeap::GetTupleImpl(Row *row, Txn *txn) {
   const RowId rid = row->GetRowId();
   page_id_t page_id = rid.GetPageId();
 
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(page_id));
 
   if (page == nullptr) return false;
   bool ok = page->GetTuple(row, schema_, txn, lock_manager_);
@@ -150,6 +271,9 @@ bool TableHeap::GetTuple(Row *row, Txn *txn) {
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
+    if (layout_ == TableLayout::kRow) {
+      FreePageOverflow(temp_table_page);
+    }
     if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
       DeleteTable(temp_table_page->GetNextPageId());
     buffer_pool_manager_->UnpinPage(page_id, false);
@@ -159,18 +283,136 @@ void TableHeap::DeleteTable(page_id_t page_id) {
   }
 }
 
+uint32_t TableHeap::Vacuum(Txn *txn, std::vector<std::pair<RowId, RowId>> *moved_rows) {
+  return layout_ == TableLayout::kPax ? VacuumImpl<PaxPage>(txn, moved_rows) : VacuumImpl<TablePage>(txn, moved_rows);
+}
+
+template <typename PageType>
+uint32_t TableHeap::VacuumImpl(Txn *txn, std::vector<std::pair<RowId, RowId>> *moved_rows) {
+  uint32_t released = 0;
+  page_id_t prev_id = first_page_id_;
+  auto prev = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(prev_id));
+  if (prev == nullptr) return 0;
+  prev->WLatch();
+  FreePageOverflow(prev, false);
+  prev->Compact(txn, log_manager_);
+  page_id_t cur_id = prev->GetNextPageId();
+  while (cur_id != INVALID_PAGE_ID) {
+    auto cur = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(cur_id));
+    cur->WLatch();
+    FreePageOverflow(cur, false);
+    cur->Compact(txn, log_manager_);
+    // 当前页放不进前一页，前一页就此定型，继续往后合并
+    if (cur->GetUsedSpace() > prev->GetFreeSpaceRemaining()) {
+      prev->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev_id, true);
+      prev = cur;
+      prev_id = cur_id;
+      cur_id = cur->GetNextPageId();
+      continue;
+    }
+    // 把当前页的tuple全部搬到前一页
+    RowId rid, next_rid;
+    for (bool has_next = cur->GetFirstTupleRid(&rid); has_next; rid = next_rid) {
+      Row row(rid);
+      cur->GetTuple(&row, schema_, txn, lock_manager_);
+      bool __attribute__((unused)) ok = prev->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+      ASSERT(ok, "Tuple should fit in the previous page.");
+      if (moved_rows != nullptr) {
+        moved_rows->emplace_back(rid, row.GetRowId());
+      }
+      has_next = cur->GetNextTupleRid(rid, &next_rid);
+    }
+    // 当前页已空，从链表中摘除并释放
+    page_id_t next_id = cur->GetNextPageId();
+    prev->SetNextPageId(next_id);
+    if (next_id != INVALID_PAGE_ID) {
+      auto next = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(next_id));
+      next->WLatch();
+      next->SetPrevPageId(prev_id);
+      next->WUnlatch();
+      buffer_pool_manager_->UnpinPage(next_id, true);
+    }
+    cur->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_id, false);
+    buffer_pool_manager_->DeletePage(cur_id);
+    released++;
+    cur_id = next_id;
+  }
+  prev->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_id, true);
+  dead_tuple_count_ = 0;
+  return released;
+}
+
+page_id_t TableHeap::ScanPaxPage(page_id_t page_id, const std::vector<uint32_t> &filter_columns,
+                                 const std::function<bool(const Row &)> &filter, std::vector<Row> *rows, Txn *txn) {
+  ASSERT(layout_ == TableLayout::kPax, "Column scan needs a PAX table.");
+  auto page = reinterpret_cast<PaxPage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) return INVALID_PAGE_ID;
+  page->RLatch();
+  std::vector<uint32_t> slots;
+  page->GetLiveSlots(&slots);
+  if (filter != nullptr && !slots.empty()) {
+    // 先只读谓词涉及的列，逐列顺序扫描minipage，其余列保持为空
+    std::vector<Row> partial_rows(slots.size());
+    for (auto &partial_row : partial_rows) {
+      partial_row.GetFields().reserve(schema_->GetColumnCount());
+      for (auto column : schema_->GetColumns()) {
+        partial_row.GetFields().emplace_back(column->GetType());
+      }
+    }
+    for (auto column_id : filter_columns) {
+      page->GetColumn(schema_, column_id, slots, &partial_rows);
+    }
+    size_t qualified = 0;
+    for (size_t i = 0; i < slots.size(); i++) {
+      if (filter(partial_rows[i])) {
+        slots[qualified++] = slots[i];
+      }
+    }
+    slots.resize(qualified);
+  }
+  // 只为满足条件的tuple拼出整行
+  rows->reserve(rows->size() + slots.size());
+  for (auto slot : slots) {
+    rows->emplace_back(RowId(page_id, slot));
+    page->GetTuple(&rows->back(), schema_, txn, lock_manager_);
+  }
+  page_id_t next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return next_page_id;
+}
+
+TableIterator TableHeap::Begin(Txn *txn, bool load_overflow) {
+  RowId first_rid = GetFirstTupleRid(first_page_id_);
+  if (first_rid == INVALID_ROWID) {
+    return End();
+  }
+  return TableIterator(this, first_rid, txn, load_overflow);
+}
+
+RowId TableHeap::GetFirstTupleRid(page_id_t page_id) {
+  return layout_ == TableLayout::kPax ? GetFirstTupleRidImpl<PaxPage>(page_id)
+                                      : GetFirstTupleRidImpl<TablePage>(page_id);
+}
+
+RowId TableHeap::GetNextTupleRid(const RowId &rid) {
+  return layout_ == TableLayout::kPax ? GetNextTupleRidImpl<PaxPage>(rid) : GetNextTupleRidImpl<TablePage>(rid);
+}
+
 /**
  * TODO: Student Implement
  */
-TableIterator TableHeap::Begin(Txn *txn) {
-  page_id_t page_id = first_page_id_;
-
+template <typename PageType>
+RowId TableHeap::GetFirstTupleRidImpl(page_id_t page_id) {
   while (page_id != INVALID_PAGE_ID) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(page_id));
     RowId first_rid;
     if (page->GetFirstTupleRid(&first_rid)) {
       buffer_pool_manager_->UnpinPage(page_id, false);
-      return TableIterator(this, first_rid, txn);
+      return first_rid;
     }
 
     page_id_t next = page->GetNextPageId();
@@ -178,7 +420,154 @@ TableIterator TableHeap::Begin(Txn *txn) {
     page_id = next;
   }
 
-  return End();
+  return INVALID_ROWID;
+}
+
+template <typename PageType>
+RowId TableHeap::GetNextTupleRidImpl(const RowId &rid) {
+  page_id_t cur_page_id = rid.GetPageId();
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(cur_page_id));
+  RowId next_rid;
+  // 页内下一条
+  if (page->GetNextTupleRid(rid, &next_rid)) {
+    buffer_pool_manager_->UnpinPage(cur_page_id, false);
+    return next_rid;
+  }
+  // 找下一页
+  page_id_t next_page_id = page->GetNextPageId();
+  buffer_pool_manager_->UnpinPage(cur_page_id, false);
+  return GetFirstTupleRidImpl<PageType>(next_page_id);
+}
+
+void TableHeap::LoadOverflowFields(Row *row, const std::vector<uint32_t> *columns) {
+  auto &fields = row->GetFields();
+  auto load = [&](uint32_t column_id) {
+    Field &field = fields[column_id];
+    if (field.IsNull() || !field.IsOverflow()) {
+      return;
+    }
+    uint32_t len = field.GetLength();
+    std::vector<char> buf(len);
+    ReadOverflow(field.GetOverflowPageId(), buf.data(), len);
+    field = Field(TypeId::kTypeChar, buf.data(), len, true);
+  };
+  if (columns == nullptr) {
+    for (uint32_t i = 0; i < fields.size(); i++) {
+      load(i);
+    }
+  } else {
+    for (auto column_id : *columns) {
+      load(column_id);
+    }
+  }
+}
+
+page_id_t TableHeap::WriteOverflow(const char *data, uint32_t len) {
+  // 从最后一段往前写，初始化每一页时后继页已知
+  uint32_t page_count = (len + OverflowPage::MAX_DATA_SIZE - 1) / OverflowPage::MAX_DATA_SIZE;
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  for (uint32_t i = page_count; i > 0; i--) {
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(page_id));
+    if (page == nullptr) {
+      FreeOverflow(next_page_id);
+      return INVALID_PAGE_ID;
+    }
+    page->WLatch();
+    page->Init(next_page_id);
+    uint32_t offset = (i - 1) * OverflowPage::MAX_DATA_SIZE;
+    page->WriteData(data + offset, len - offset);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+void TableHeap::ReadOverflow(page_id_t page_id, char *buf, uint32_t len) {
+  uint32_t read = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Failed to fetch overflow page.");
+    page->RLatch();
+    ASSERT(read + page->GetDataSize() <= len, "Overflow pages hold more data than the value.");
+    read += page->ReadData(buf + read);
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  ASSERT(read == len, "Overflow pages hold less data than the value.");
+}
+
+void TableHeap::FreeOverflow(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Failed to fetch overflow page.");
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+bool TableHeap::MoveOverflowFields(const Row &row, Row *stored_row) {
+  bool moved = false;
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    const Field *field = row.GetField(i);
+    if (field->GetTypeId() != TypeId::kTypeChar || field->IsNull() || field->IsOverflow() ||
+        field->GetLength() <= OVERFLOW_THRESHOLD) {
+      continue;
+    }
+    page_id_t page_id = WriteOverflow(field->GetData(), field->GetLength());
+    if (page_id == INVALID_PAGE_ID) {
+      // 缓冲池分配不出页，保留在行内，由行大小检查决定能否插入
+      LOG(WARNING) << "Failed to allocate overflow pages.";
+      continue;
+    }
+    if (!moved) {
+      *stored_row = row;
+      moved = true;
+    }
+    stored_row->GetFields()[i] = Field(TypeId::kTypeChar, field->GetLength(), page_id);
+  }
+  return moved;
+}
+
+void TableHeap::FreeOverflowFields(const Row &row, const Row *keep) {
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    const Field *field = row.GetField(i);
+    if (field->IsNull() || !field->IsOverflow()) {
+      continue;
+    }
+    bool kept = false;
+    for (uint32_t j = 0; keep != nullptr && j < keep->GetFieldCount(); j++) {
+      const Field *keep_field = keep->GetField(j);
+      if (!keep_field->IsNull() && keep_field->GetOverflowPageId() == field->GetOverflowPageId()) {
+        kept = true;
+        break;
+      }
+    }
+    if (!kept) {
+      FreeOverflow(field->GetOverflowPageId());
+    }
+  }
+}
+
+void TableHeap::FreePageOverflow(TablePage *page, bool include_live) {
+  std::vector<Row> rows;
+  page->GetDeletedTuples(schema_, &rows);
+  if (include_live) {
+    RowId rid, next_rid;
+    for (bool has_next = page->GetFirstTupleRid(&rid); has_next; rid = next_rid) {
+      rows.emplace_back(rid);
+      page->GetTuple(&rows.back(), schema_, nullptr, lock_manager_);
+      has_next = page->GetNextTupleRid(rid, &next_rid);
+    }
+  }
+  for (const auto &row : rows) {
+    FreeOverflowFields(row);
+  }
 }
 
 /**
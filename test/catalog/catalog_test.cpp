@@ -91,6 +91,17 @@ TEST(CatalogTest, CatalogIndexTest) {
   ASSERT_EQ(DB_COLUMN_NAME_NOT_EXIST, r2);
   auto r3 = catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info, "bptree");
   ASSERT_EQ(DB_SUCCESS, r3);
+  // keys wider than 256 bytes, up to what an index page holds
+  std::vector<Column *> wide_columns = {
+      new Column("email", TypeId::kTypeChar, BPlusTreePage::MAX_KEY_SIZE, 0, false, false),
+      new Column("note", TypeId::kTypeChar, BPlusTreePage::MAX_KEY_SIZE + 1, 1, false, false)};
+  auto wide_schema = std::make_shared<Schema>(wide_columns);
+  TableInfo *wide_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-2", wide_schema.get(), &txn, wide_info));
+  IndexInfo *wide_index = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-2", "index-email", {"email"}, &txn, wide_index, "bptree"));
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("table-2", "index-note", {"note"}, &txn, wide_index, "bptree"));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-2", "index-note", {"note"}, &txn, wide_index, "hash"));
   for (int i = 0; i < 10; i++) {
     std::vector<Field> fields{Field(TypeId::kTypeInt, i),
                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
@@ -126,4 +137,37 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+TEST(CatalogTest, CatalogOldMetadataTest) {
+  // metadata pages written before the table layout, index uniqueness and index type were stored
+  const uint32_t old_magic_num = 344528;
+  char *buf = new char[PAGE_SIZE];
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char *p = buf;
+  MACH_WRITE_UINT32(p, old_magic_num);
+  p += 4;
+  MACH_WRITE_TO(table_id_t, p, 7);
+  p += 4;
+  MACH_WRITE_UINT32(p, 7);
+  p += 4;
+  MACH_WRITE_STRING(p, std::string("table-7"));
+  p += 7;
+  MACH_WRITE_TO(page_id_t, p, 42);
+  p += 4;
+  p += schema->SerializeTo(p);
+  TableMetadata *table_meta = nullptr;
+  ASSERT_EQ(p - buf, TableMetadata::DeserializeFrom(buf, table_meta));
+  ASSERT_NE(nullptr, table_meta);
+  EXPECT_EQ("table-7", table_meta->GetTableName());
+  EXPECT_EQ(42, table_meta->GetFirstPageId());
+  EXPECT_EQ(TableLayout::kRow, table_meta->GetLayout());
+  delete table_meta;
+  // the tree pages of an old index use the old key format and can not be read
+  p = buf;
+  MACH_WRITE_UINT32(p, old_magic_num);
+  IndexMetadata *index_meta = nullptr;
+  IndexMetadata::DeserializeFrom(buf, index_meta);
+  ASSERT_EQ(nullptr, index_meta);
+  delete[] buf;
+}
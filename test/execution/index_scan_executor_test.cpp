@@ -0,0 +1,110 @@
+#include "executor/executors/index_scan_executor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+
+// Comparisons against char constants longer than the indexed column, whose keys are cut to the column length
+TEST(IndexScanExecutorTest, OverlongCharBoundTest) {
+  DBStorageEngine engine("index_scan_executor_test.db");
+  auto catalog = engine.catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 3, 1, true, false)};
+  TableSchema schema(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", &schema, nullptr, table_info));
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "t_name", {"name"}, nullptr, index_info, "bptree"));
+  const char *names[] = {"abb", "abc", "abd", "ab"};
+  for (int i = 0; i < 4; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(names[i]), strlen(names[i]), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    ASSERT_EQ(DB_SUCCESS,
+              index_info->GetIndex()->InsertRowEntry(row, index_info->GetKeyProjector(), row.GetRowId(), nullptr));
+  }
+  ExecuteContext context(nullptr, catalog, engine.bpm_);
+  auto name = std::make_shared<ColumnValueExpression>(0, 1, TypeId::kTypeChar);
+  // names of the rows the index scan returns for name <op> value
+  auto scan = [&](const std::string &op, const char *value, bool covering) {
+    Field constant(TypeId::kTypeChar, const_cast<char *>(value), strlen(value), true);
+    auto value_expr = std::make_shared<ConstantValueExpression>(constant);
+    auto predicate = std::make_shared<ComparisonExpression>(name, value_expr, op);
+    std::vector<IndexInfo *> covering_indexes;
+    if (covering) covering_indexes.push_back(index_info);
+    IndexScanPlanNode plan(table_info->GetSchema(), "t", {index_info}, false, predicate, covering_indexes);
+    IndexScanExecutor executor(&context, &plan);
+    executor.Init();
+    std::vector<std::string> result;
+    Row row;
+    RowId rid;
+    while (executor.Next(&row, &rid)) {
+      result.push_back(row.GetField(1)->toString());
+    }
+    return result;
+  };
+  using Names = std::vector<std::string>;
+  for (bool covering : {false, true}) {
+    // "abcxyz" is cut to the key of "abc", which does not match it
+    ASSERT_EQ(Names{}, scan("=", "abcxyz", covering));
+    ASSERT_EQ((Names{"ab", "abb", "abc"}), scan("<", "abcxyz", covering));
+    ASSERT_EQ((Names{"ab", "abb", "abc"}), scan("<=", "abcxyz", covering));
+    ASSERT_EQ(Names{"abd"}, scan(">", "abcxyz", covering));
+    ASSERT_EQ(Names{"abd"}, scan(">=", "abcxyz", covering));
+    ASSERT_EQ(Names{"abc"}, scan("=", "abc", covering));
+  }
+}
+
+// Index scans over a char key cut from a longer value, stored before column lengths were checked
+TEST(IndexScanExecutorTest, OverlongCharKeyTest) {
+  DBStorageEngine engine("index_scan_executor_test.db");
+  auto catalog = engine.catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 3, 1, true, false)};
+  TableSchema schema(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", &schema, nullptr, table_info));
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "t_name", {"name"}, nullptr, index_info, "bptree", false));
+  const char *names[] = {"abc", "abcxyz", "ab"};
+  for (int i = 0; i < 3; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(names[i]), strlen(names[i]), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    ASSERT_EQ(DB_SUCCESS,
+              index_info->GetIndex()->InsertRowEntry(row, index_info->GetKeyProjector(), row.GetRowId(), nullptr));
+  }
+  ExecuteContext context(nullptr, catalog, engine.bpm_);
+  auto name = std::make_shared<ColumnValueExpression>(0, 1, TypeId::kTypeChar);
+  auto scan = [&](const std::string &op, const char *value, bool covering) {
+    Field constant(TypeId::kTypeChar, const_cast<char *>(value), strlen(value), true);
+    auto value_expr = std::make_shared<ConstantValueExpression>(constant);
+    auto predicate = std::make_shared<ComparisonExpression>(name, value_expr, op);
+    std::vector<IndexInfo *> covering_indexes;
+    if (covering) covering_indexes.push_back(index_info);
+    IndexScanPlanNode plan(table_info->GetSchema(), "t", {index_info}, false, predicate, covering_indexes);
+    IndexScanExecutor executor(&context, &plan);
+    executor.Init();
+    std::vector<std::string> result;
+    Row row;
+    RowId rid;
+    while (executor.Next(&row, &rid)) {
+      result.push_back(row.GetField(1)->toString());
+    }
+    return result;
+  };
+  using Names = std::vector<std::string>;
+  for (bool covering : {false, true}) {
+    ASSERT_EQ(Names{"abcxyz"}, scan("=", "abcxyz", covering));
+    ASSERT_EQ(Names{"abc"}, scan("=", "abc", covering));
+    ASSERT_EQ((Names{"ab", "abc", "abcxyz"}), scan("<=", "abd", covering));
+  }
+}
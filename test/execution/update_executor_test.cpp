@@ -0,0 +1,69 @@
+#include "executor/executors/update_executor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/instance.h"
+#include "executor/executors/seq_scan_executor.h"
+#include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+
+// An update that no longer fits its page moves the row, the indexes must point at where it went
+TEST(UpdateExecutorTest, MovedRowIndexTest) {
+  DBStorageEngine engine("update_executor_test.db");
+  auto catalog = engine.catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, OVERFLOW_THRESHOLD, 1, true, false)};
+  TableSchema schema(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", &schema, nullptr, table_info));
+  IndexInfo *id_index = nullptr;
+  IndexInfo *name_index = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "t_id", {"id"}, nullptr, id_index, "bptree"));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "t_name", {"name"}, nullptr, name_index, "bptree", false));
+  // short rows until the first page is full
+  const int n = 500;
+  RowId old_rid;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>("a"), 1, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    for (auto index : {id_index, name_index}) {
+      ASSERT_EQ(DB_SUCCESS, index->GetIndex()->InsertRowEntry(row, index->GetKeyProjector(), row.GetRowId(), nullptr));
+    }
+    if (i == 0) old_rid = row.GetRowId();
+  }
+  ExecuteContext context(nullptr, catalog, engine.bpm_);
+  // update t set name = <long> where id = 0
+  std::string long_name(OVERFLOW_THRESHOLD - 1, 'x');
+  Field long_field(TypeId::kTypeChar, const_cast<char *>(long_name.c_str()), long_name.length(), true);
+  auto id = std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt);
+  auto predicate =
+      std::make_shared<ComparisonExpression>(id, std::make_shared<ConstantValueExpression>(Field(kTypeInt, 0)), "=");
+  auto scan_plan = std::make_shared<SeqScanPlanNode>(table_info->GetSchema(), "t", predicate);
+  UpdatePlanNode update_plan(table_info->GetSchema(), scan_plan, "t",
+                             {{1, std::make_shared<ConstantValueExpression>(long_field)}});
+  UpdateExecutor executor(&context, &update_plan, std::make_unique<SeqScanExecutor>(&context, scan_plan.get()));
+  executor.Init();
+  Row result;
+  RowId result_rid;
+  ASSERT_TRUE(executor.Next(&result, &result_rid));
+  ASSERT_FALSE(executor.Next(&result, &result_rid));
+  // both indexes find the row at its new place
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 0), long_field};
+  Row key_row(fields);
+  std::vector<RowId> rids;
+  ASSERT_EQ(DB_SUCCESS, id_index->GetIndex()->ScanRowKey(key_row, id_index->GetKeyProjector(), rids, nullptr));
+  ASSERT_EQ(1, rids.size());
+  ASSERT_NE(old_rid.Get(), rids[0].Get());
+  Row row(rids[0]);
+  ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, nullptr));
+  ASSERT_EQ(long_name, row.GetField(1)->toString());
+  std::vector<RowId> name_rids;
+  ASSERT_EQ(DB_SUCCESS,
+            name_index->GetIndex()->ScanRowKey(key_row, name_index->GetKeyProjector(), name_rids, nullptr));
+  ASSERT_EQ(std::vector<RowId>{rids[0]}, name_rids);
+}
@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree.h"
+
+static const std::string db_name = "bp_tree_concurrent_test.db";
+
+namespace {
+// Small nodes so that splits and merges happen all the time
+constexpr int NODE_SIZE = 16;
+
+struct ConcurrentTreeFixture {
+  ConcurrentTreeFixture()
+      : engine_(db_name),
+        columns_({new Column("int", TypeId::kTypeInt, 0, false, false)}),
+        schema_(columns_),
+        km_(&schema_, 4) {}
+
+  std::vector<GenericKey *> MakeKeys(int n) {
+    std::vector<GenericKey *> keys(n);
+    for (int i = 0; i < n; i++) {
+      keys[i] = km_.InitKey();
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      km_.SerializeFromKey(keys[i], Row(fields), &schema_);
+    }
+    return keys;
+  }
+
+  // @return keys met by a full scan, checking that they come in order
+  int ScanCount(BPlusTree &tree) {
+    int count = 0;
+    // the iterator reuses its key buffer, the previous key is copied out
+    std::vector<char> last(km_.GetKeySize());
+    for (auto it = tree.Begin(); it != tree.End(); ++it) {
+      if (count > 0) {
+        EXPECT_LT(km_.CompareKeys(reinterpret_cast<GenericKey *>(last.data()), (*it).first), 0);
+      }
+      memcpy(last.data(), (*it).first, km_.GetKeySize());
+      count++;
+    }
+    return count;
+  }
+
+  DBStorageEngine engine_;
+  std::vector<Column *> columns_;
+  Schema schema_;
+  KeyManager km_;
+};
+
+template <typename F>
+void RunThreads(int thread_num, F &&work) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back(work, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+}  // namespace
+
+TEST(BPlusTreeConcurrentTests, ConcurrentInsertTest) {
+  ConcurrentTreeFixture fixture;
+  BPlusTree tree(0, fixture.engine_.bpm_, fixture.km_, NODE_SIZE, NODE_SIZE);
+  const int n = 20000;
+  const int thread_num = 4;
+  auto keys = fixture.MakeKeys(n);
+  RunThreads(thread_num, [&](int t) {
+    std::vector<int> mine;
+    for (int i = t; i < n; i += thread_num) {
+      mine.push_back(i);
+    }
+    std::shuffle(mine.begin(), mine.end(), std::mt19937(t));
+    for (int i : mine) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i), nullptr));
+    }
+  });
+  std::vector<RowId> result;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], result));
+    ASSERT_EQ(RowId(i), result.back());
+  }
+  ASSERT_EQ(n, fixture.ScanCount(tree));
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeConcurrentTests, ConcurrentMixedTest) {
+  ConcurrentTreeFixture fixture;
+  BPlusTree tree(0, fixture.engine_.bpm_, fixture.km_, NODE_SIZE, NODE_SIZE);
+  const int n = 20000;
+  auto keys = fixture.MakeKeys(n);
+  // even keys are there from the start and get removed, odd keys get inserted, readers look up anything
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i), nullptr));
+  }
+  std::atomic<bool> writing{true};
+  std::atomic<int> writers_left{4};
+  std::atomic<int> bad_reads{0};
+  RunThreads(6, [&](int t) {
+    if (t < 4) {
+      // t = 0, 1 remove, t = 2, 3 insert, each one half of its keys
+      std::mt19937 rng(t);
+      std::vector<int> mine;
+      for (int i = (t < 2 ? 0 : 1) + 2 * (t % 2); i < n; i += 4) {
+        mine.push_back(i);
+      }
+      std::shuffle(mine.begin(), mine.end(), rng);
+      for (int i : mine) {
+        if (t < 2) {
+          tree.Remove(keys[i], nullptr);
+        } else {
+          ASSERT_TRUE(tree.Insert(keys[i], RowId(i), nullptr));
+        }
+      }
+      if (--writers_left == 0) {
+        writing = false;
+      }
+      return;
+    }
+    std::mt19937 rng(t);
+    std::vector<RowId> result;
+    while (writing) {
+      int i = static_cast<int>(rng() % n);
+      result.clear();
+      // a key may or may not be there yet, but a value found must be its own
+      if (tree.GetValue(keys[i], result) && !(result.back() == RowId(i))) {
+        bad_reads++;
+      }
+    }
+  });
+  ASSERT_EQ(0, bad_reads.load());
+  std::vector<RowId> result;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 2 == 1, tree.GetValue(keys[i], result)) << "key " << i;
+  }
+  ASSERT_EQ(n / 2, fixture.ScanCount(tree));
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeConcurrentTests, ConcurrentVacuumTest) {
+  ConcurrentTreeFixture fixture;
+  BPlusTree tree(0, fixture.engine_.bpm_, fixture.km_, NODE_SIZE, NODE_SIZE);
+  const int n = 20000;
+  // keys below n are even at the start, past n they are appended in order
+  auto keys = fixture.MakeKeys(n + n / 4);
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i), nullptr));
+  }
+  std::atomic<bool> writing{true};
+  std::atomic<int> writers_left{3};
+  std::atomic<int> bad_reads{0};
+  std::atomic<int> vacuums{0};
+  RunThreads(6, [&](int t) {
+    if (t < 3) {
+      // t = 0 removes keys 2 mod 4, t = 1 inserts the odd keys, t = 2 appends
+      std::vector<int> mine;
+      for (int i = (t == 0 ? 2 : 1); t < 2 && i < n; i += (t == 0 ? 4 : 2)) {
+        mine.push_back(i);
+      }
+      std::shuffle(mine.begin(), mine.end(), std::mt19937(t));
+      for (int i = n; t == 2 && i < n + n / 4; i++) {
+        mine.push_back(i);
+      }
+      for (int i : mine) {
+        if (t == 0) {
+          tree.Remove(keys[i], nullptr);
+        } else {
+          ASSERT_TRUE(tree.Insert(keys[i], RowId(i), nullptr));
+        }
+      }
+      if (--writers_left == 0) {
+        writing = false;
+      }
+      return;
+    }
+    if (t == 3) {
+      while (writing) {
+        tree.Vacuum();
+        vacuums++;
+      }
+      return;
+    }
+    // the keys 0 mod 4 are there all along, a vacuum must not hide them
+    std::mt19937 rng(t);
+    std::vector<RowId> result;
+    while (writing) {
+      int i = static_cast<int>(rng() % (n / 4)) * 4;
+      result.clear();
+      if (!tree.GetValue(keys[i], result) || !(result.back() == RowId(i))) {
+        bad_reads++;
+      }
+    }
+  });
+  ASSERT_GT(vacuums.load(), 0);
+  ASSERT_EQ(0, bad_reads.load());
+  std::vector<RowId> result;
+  for (int i = 0; i < n + n / 4; i++) {
+    ASSERT_EQ(i >= n || i % 4 != 2, tree.GetValue(keys[i], result)) << "key " << i;
+  }
+  ASSERT_EQ(n / 4 * 3 + n / 4, fixture.ScanCount(tree));
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeConcurrentTests, ConcurrentStatsTest) {
+  ConcurrentTreeFixture fixture;
+  BPlusTree tree(0, fixture.engine_.bpm_, fixture.km_, NODE_SIZE, NODE_SIZE);
+  const int n = 20000;
+  auto keys = fixture.MakeKeys(n);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i), nullptr));
+  }
+  // removes merge pages away while the stats walk the tree, the odd keys stay
+  std::atomic<bool> writing{true};
+  std::atomic<int> writers_left{2};
+  std::atomic<int> bad_stats{0};
+  std::atomic<int> walks{0};
+  RunThreads(4, [&](int t) {
+    if (t < 2) {
+      std::vector<int> mine;
+      for (int i = 2 * t; i < n; i += 4) {
+        mine.push_back(i);
+      }
+      std::shuffle(mine.begin(), mine.end(), std::mt19937(t));
+      for (int i : mine) {
+        tree.Remove(keys[i], nullptr);
+      }
+      if (--writers_left == 0) {
+        writing = false;
+      }
+      return;
+    }
+    while (writing) {
+      IndexStats stats = tree.GetStats();
+      if (stats.entries_ < n / 2 || stats.entries_ > n || stats.height_ < 2 || stats.leaf_fill_factor_ > 1.0) {
+        bad_stats++;
+      }
+      walks++;
+    }
+  });
+  ASSERT_GT(walks.load(), 0);
+  ASSERT_EQ(0, bad_stats.load());
+  IndexStats stats = tree.GetStats();
+  ASSERT_EQ(n / 2, stats.entries_);
+  ASSERT_GT(stats.merges_, 0);
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeConcurrentTests, ConcurrentThroughputBenchmark) {
+  ConcurrentTreeFixture fixture;
+  BPlusTree tree(0, fixture.engine_.bpm_, fixture.km_);
+  const int n = 100000;
+  const int ops = 200000;
+  auto keys = fixture.MakeKeys(n);
+  for (int i = 0; i < n; i += 2) {
+    tree.Insert(keys[i], RowId(i), nullptr);
+  }
+  for (int thread_num : {1, 2, 4}) {
+    // lookups only
+    auto start = std::chrono::steady_clock::now();
+    RunThreads(thread_num, [&](int t) {
+      std::mt19937 rng(t);
+      std::vector<RowId> result;
+      for (int i = 0; i < ops / thread_num; i++) {
+        result.clear();
+        tree.GetValue(keys[rng() % n], result);
+      }
+    });
+    double lookup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    // 10% writes: insert then remove odd keys, the tree ends up as it started
+    start = std::chrono::steady_clock::now();
+    RunThreads(thread_num, [&](int t) {
+      std::mt19937 rng(t);
+      std::vector<RowId> result;
+      for (int i = 0; i < ops / thread_num; i++) {
+        int key = static_cast<int>(rng() % n);
+        if (i % 10 == 0) {
+          int odd = (key | 1) % n;
+          tree.Insert(keys[odd], RowId(odd), nullptr);
+          tree.Remove(keys[odd], nullptr);
+        } else {
+          result.clear();
+          tree.GetValue(keys[key], result);
+        }
+      }
+    });
+    double mixed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[ B+ tree ] " << thread_num << " threads: " << static_cast<int>(ops / lookup_ms * 1000)
+              << " lookups/s, " << static_cast<int>(ops / mixed_ms * 1000) << " ops/s with 10% writes" << std::endl;
+  }
+  ASSERT_EQ(n / 2, fixture.ScanCount(tree));
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
@@ -1,10 +1,17 @@
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <optional>
+#include <random>
 #include <string>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/generic_key.h"
+#include "index/skip_scan_iterator.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -27,6 +34,100 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, KP.CompareKeys(k1, k2));
 }
 
+TEST(BPlusTreeTests, BPlusTreeIndexNormalizedKeyTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 8, 2, true, false)};
+  TableSchema key_schema(columns);
+  KeyManager KP(&key_schema, 32);
+  const char *names[] = {"", "a", "ab", "abc", "b", "zzzzzzzz"};
+  std::vector<Row> keys;
+  for (int id : {INT32_MIN, -7, -1, 0, 1, 7, INT32_MAX}) {
+    for (float account : {-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 2.5f}) {
+      for (auto name : names) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeFloat, account),
+                                  Field(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true)};
+        keys.emplace_back(std::move(fields));
+      }
+    }
+  }
+  std::vector<Field> null_fields{Field(TypeId::kTypeInt), Field(TypeId::kTypeFloat), Field(TypeId::kTypeChar)};
+  keys.emplace_back(std::move(null_fields));
+  // Column by column comparison of the fields, null first
+  auto compare_rows = [](const Row &lhs, const Row &rhs) {
+    for (uint32_t i = 0; i < lhs.GetFieldCount(); i++) {
+      const Field *l = lhs.GetField(i);
+      const Field *r = rhs.GetField(i);
+      if (l->IsNull() || r->IsNull()) {
+        if (l->IsNull() != r->IsNull()) {
+          return l->IsNull() ? -1 : 1;
+        }
+        continue;
+      }
+      if (l->CompareLessThan(*r) == CmpBool::kTrue) {
+        return -1;
+      }
+      if (l->CompareGreaterThan(*r) == CmpBool::kTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  };
+  auto sign = [](int x) { return (x > 0) - (x < 0); };
+  std::vector<GenericKey *> encoded;
+  for (auto &key : keys) {
+    encoded.push_back(KP.InitKey());
+    KP.SerializeFromKey(encoded.back(), key, &key_schema);
+    // decoding gives back the key
+    Row decoded;
+    KP.DeserializeToKey(encoded.back(), decoded, &key_schema);
+    ASSERT_EQ(0, compare_rows(key, decoded));
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      ASSERT_EQ(compare_rows(keys[i], keys[j]), sign(KP.CompareKeys(encoded[i], encoded[j])));
+    }
+  }
+  for (auto key : encoded) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexFixedKeyComparatorTest) {
+  std::vector<Column *> int_columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<Column *> pair_columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                        new Column("account", TypeId::kTypeFloat, 1, false, false)};
+  Schema int_schema(int_columns);
+  Schema pair_schema(pair_columns);
+  // A not null INT key is stored as its raw 4 bytes, an INT and FLOAT pair in 8
+  KeyManager int_km(&int_schema, 4);
+  KeyManager pair_km(&pair_schema, 8);
+  auto sign = [](int x) { return (x > 0) - (x < 0); };
+  std::vector<int> values{INT32_MIN, -65536, -256, -1, 0, 1, 255, 256, 65536, INT32_MAX};
+  for (auto *km : {&int_km, &pair_km}) {
+    Schema *schema = km == &int_km ? &int_schema : &pair_schema;
+    std::vector<GenericKey *> keys;
+    for (int value : values) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, value)};
+      if (schema == &pair_schema) {
+        fields.emplace_back(TypeId::kTypeFloat, static_cast<float>(-value));
+      }
+      keys.push_back(km->InitKey());
+      km->SerializeFromKey(keys.back(), Row(fields), schema);
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+      for (size_t j = 0; j < keys.size(); j++) {
+        int expected = (i > j) - (i < j);
+        ASSERT_EQ(expected, sign(km->CompareKeys(keys[i], keys[j])));
+        ASSERT_EQ(expected, km->VisitComparator([&](const auto &cmp) { return sign(cmp(keys[i], keys[j])); }));
+      }
+    }
+    for (auto key : keys) {
+      free(key);
+    }
+  }
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   auto disk_mgr_ = new DiskManager(db_name);
   auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
@@ -78,4 +179,543 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   delete index;
   delete bpm_;
   delete disk_mgr_;
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BPlusTreeIndexKeyProjectorTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  if (bpm_->IsPageFree(CATALOG_META_PAGE_ID)) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == CATALOG_META_PAGE_ID);
+  }
+  if (bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID)) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == INDEX_ROOTS_PAGE_ID);
+  }
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  const TableSchema table_schema(columns);
+  // Key columns out of table order
+  std::vector<uint32_t> index_key_map{2, 0};
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  KeyProjector projector(key_schema, index_key_map);
+  KeyManager KP(key_schema, 64);
+  GenericKey *k1 = KP.InitKey();
+  GenericKey *k2 = KP.InitKey();
+  // The projected key has the bytes of the key row serialized with the key schema, nulls included
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 27), Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true),
+                            Field(TypeId::kTypeFloat)};
+  Row row(fields);
+  Row key_row;
+  row.GetKeyFromRow(&table_schema, key_schema, key_row);
+  KP.SerializeFromKey(k1, key_row, key_schema);
+  KP.SerializeFromRow(k2, row, projector);
+  ASSERT_LE(projector.GetKeySize(), (uint32_t)KP.GetKeySize());
+  ASSERT_EQ(0, memcmp(k1, k2, KP.GetKeySize()));
+  free(k1);
+  free(k2);
+  // Index maintenance through the projector and through key rows is interchangeable
+  const int row_nums = 20000;
+  auto *row_index = new BPlusTreeIndex(0, key_schema, 64, bpm_);
+  auto *key_row_index = new BPlusTreeIndex(1, key_schema, 64, bpm_);
+  std::vector<Row> rows;
+  rows.reserve(row_nums);
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> row_fields{Field(TypeId::kTypeInt, i),
+                                  Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true),
+                                  Field(TypeId::kTypeFloat, static_cast<float>(i % 100))};
+    rows.emplace_back(std::move(row_fields));
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < row_nums; i++) {
+    Row index_key_row;
+    rows[i].GetKeyFromRow(&table_schema, key_schema, index_key_row);
+    ASSERT_EQ(DB_SUCCESS, key_row_index->InsertEntry(index_key_row, RowId(1000, i), nullptr));
+  }
+  auto key_row_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < row_nums; i++) {
+    ASSERT_EQ(DB_SUCCESS, row_index->InsertRowEntry(rows[i], projector, RowId(1000, i), nullptr));
+  }
+  auto projector_time = std::chrono::steady_clock::now() - start;
+  std::cout << "[ KeyProjector ] " << row_nums << " inserts, key row "
+            << std::chrono::duration<double, std::milli>(key_row_time).count() << " ms, projector "
+            << std::chrono::duration<double, std::milli>(projector_time).count() << " ms" << std::endl;
+  for (int i = 0; i < row_nums; i += 7) {
+    Row index_key_row;
+    rows[i].GetKeyFromRow(&table_schema, key_schema, index_key_row);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, row_index->ScanKey(index_key_row, ret, nullptr));
+    ASSERT_EQ(RowId(1000, i), ret[0]);
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, key_row_index->ScanRowKey(rows[i], projector, ret, nullptr));
+    ASSERT_EQ(RowId(1000, i), ret[0]);
+    ASSERT_EQ(DB_SUCCESS, row_index->RemoveRowEntry(rows[i], projector, RowId(1000, i), nullptr));
+    ret.clear();
+    ASSERT_EQ(DB_KEY_NOT_FOUND, row_index->ScanRowKey(rows[i], projector, ret, nullptr));
+  }
+  row_index->Destroy();
+  key_row_index->Destroy();
+  delete row_index;
+  delete key_row_index;
+  delete key_schema;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  for (page_id_t page_id : {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID}) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == page_id);
+    bpm_->UnpinPage(id, true);
+  }
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new BPlusTreeIndex(0, &key_schema, 16, bpm_);
+  const int n = 5000;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i * 2)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i), nullptr));
+  }
+  // row ids between the bounds, given as even keys
+  auto scan = [&](std::optional<int> lower, bool lower_inclusive, std::optional<int> upper, bool upper_inclusive) {
+    std::optional<Row> lower_row;
+    std::optional<Row> upper_row;
+    if (lower) lower_row.emplace(std::vector<Field>{Field(TypeId::kTypeInt, *lower)});
+    if (upper) upper_row.emplace(std::vector<Field>{Field(TypeId::kTypeInt, *upper)});
+    auto iter = index->Scan(lower ? &*lower_row : nullptr, lower_inclusive, upper ? &*upper_row : nullptr,
+                            upper_inclusive, nullptr);
+    std::vector<int64_t> result;
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.push_back(row_id.Get());
+    }
+    EXPECT_FALSE(iter->Next(&row_id));
+    return result;
+  };
+  auto expect = [](int64_t begin, int64_t end) {
+    std::vector<int64_t> result;
+    for (int64_t i = begin; i < end; i++) {
+      result.push_back(RowId(i).Get());
+    }
+    return result;
+  };
+  ASSERT_EQ(expect(10, 21), scan(20, true, 40, true));
+  ASSERT_EQ(expect(11, 20), scan(20, false, 40, false));
+  ASSERT_EQ(expect(11, 21), scan(21, true, 41, false));
+  ASSERT_EQ(expect(0, 3), scan(std::nullopt, false, 4, true));
+  ASSERT_EQ(expect(n - 2, n), scan(n * 2 - 6, false, std::nullopt, false));
+  ASSERT_EQ(expect(0, n), scan(std::nullopt, false, std::nullopt, false));
+  ASSERT_EQ(expect(7, 8), scan(14, true, 14, true));
+  ASSERT_TRUE(scan(14, false, 14, true).empty());
+  ASSERT_TRUE(scan(40, true, 20, true).empty());
+  ASSERT_TRUE(scan(n * 2, true, std::nullopt, false).empty());
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  // a scan stopped early holds one leaf until it goes away
+  {
+    auto iter = index->Scan(nullptr, false, nullptr, false, nullptr);
+    RowId row_id;
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(iter->Next(&row_id));
+      ASSERT_EQ(RowId(i), row_id);
+    }
+    ASSERT_FALSE(bpm_->CheckAllUnpinned());
+  }
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  // the keys are read back from the leaves along with the row ids
+  {
+    Row lower(std::vector<Field>{Field(TypeId::kTypeInt, 100)});
+    auto iter = index->Scan(&lower, true, nullptr, false, nullptr);
+    RowId row_id;
+    Row key;
+    for (int i = 50; i < 60; i++) {
+      ASSERT_TRUE(iter->NextEntry(&row_id, &key));
+      ASSERT_EQ(RowId(i), row_id);
+      ASSERT_EQ(1, key.GetFieldCount());
+      ASSERT_EQ(CmpBool::kTrue, key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i * 2)));
+    }
+  }
+  // the comparison operators of ScanKey are ranges too
+  std::vector<RowId> ret;
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 100)};
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), ret, nullptr, "<>"));
+  ASSERT_EQ(n - 1, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), ret, nullptr, "<="));
+  ASSERT_EQ(51, ret.size());
+  index->Destroy();
+  delete index;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexCompositeScanTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  for (page_id_t page_id : {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID}) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == page_id);
+    bpm_->UnpinPage(id, true);
+  }
+  std::vector<Column *> columns = {new Column("a", TypeId::kTypeInt, 0, false, false),
+                                   new Column("b", TypeId::kTypeInt, 1, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new BPlusTreeIndex(0, &key_schema, 16, bpm_);
+  const int values = 10;
+  const int n = 200;
+  for (int a = 0; a < values; a++) {
+    for (int b = 0; b < n; b++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, a), Field(TypeId::kTypeInt, b)};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(a * n + b), nullptr));
+    }
+  }
+  auto make_row = [](const std::vector<int> &values) {
+    std::vector<Field> fields;
+    for (int value : values) {
+      fields.emplace_back(TypeId::kTypeInt, value);
+    }
+    return Row(std::move(fields));
+  };
+  auto collect = [](IndexScanIterator *iter) {
+    std::vector<int64_t> result;
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.push_back(row_id.Get());
+    }
+    return result;
+  };
+  // row ids of the keys (a, b) for a in [a_begin, a_end) and b in [b_begin, b_end)
+  auto expect = [](int a_begin, int a_end, int b_begin, int b_end) {
+    std::vector<int64_t> result;
+    for (int a = a_begin; a < a_end; a++) {
+      for (int b = b_begin; b < b_end; b++) {
+        result.push_back(RowId(a * n + b).Get());
+      }
+    }
+    return result;
+  };
+  // bounds on the first column only stand for every key starting with them
+  auto scan = [&](const std::vector<int> &lower, bool lower_inclusive, const std::vector<int> &upper,
+                  bool upper_inclusive) {
+    Row lower_row = make_row(lower);
+    Row upper_row = make_row(upper);
+    auto iter = index->Scan(&lower_row, lower_inclusive, &upper_row, upper_inclusive, nullptr);
+    return collect(iter.get());
+  };
+  ASSERT_EQ(expect(3, 4, 0, n), scan({3}, true, {3}, true));
+  ASSERT_EQ(expect(3, 4, 0, n), scan({2}, false, {4}, false));
+  ASSERT_EQ(expect(2, 5, 0, n), scan({2}, true, {4}, true));
+  ASSERT_EQ(expect(3, 4, 10, 20), scan({3, 10}, true, {3, 20}, false));
+  ASSERT_EQ(expect(3, 4, 11, 21), scan({3, 10}, false, {3, 20}, true));
+  ASSERT_TRUE(scan({3}, false, {3}, true).empty());
+  ASSERT_TRUE(scan({values}, true, {values}, true).empty());
+  // skip-scan: the range on b under every value of a
+  {
+    SkipScanIterator iter(index, {Field(TypeId::kTypeInt, 5)}, true, {Field(TypeId::kTypeInt, 7)}, false);
+    ASSERT_EQ(expect(0, values, 5, 7), collect(&iter));
+    ASSERT_EQ(values, iter.GetValueCount());
+  }
+  {
+    SkipScanIterator iter(index, {}, true, {Field(TypeId::kTypeInt, 1)}, true);
+    ASSERT_EQ(expect(0, values, 0, 2), collect(&iter));
+  }
+  {
+    SkipScanIterator iter(index, {Field(TypeId::kTypeInt, n)}, true, {}, true);
+    ASSERT_TRUE(collect(&iter).empty());
+  }
+  ASSERT_EQ(values, SkipScanIterator::CountValues(index, 64));
+  ASSERT_EQ(6, SkipScanIterator::CountValues(index, 5));
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexNonUniqueTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  for (page_id_t page_id : {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID}) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == page_id);
+    bpm_->UnpinPage(id, true);
+  }
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new BPlusTreeIndex(0, &key_schema, 12, bpm_, false);
+  auto key_of = [](int status) { return Row(std::vector<Field>{Field(TypeId::kTypeInt, status)}); };
+  // ten distinct keys, row ids spread over pages and slots
+  const int n = 3000;
+  auto row_id_of = [](int i) { return RowId(i / 50, i % 50); };
+  for (int i = n - 1; i >= 0; i--) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(key_of(i % 10), row_id_of(i), nullptr));
+  }
+  // only the very same entry is a duplicate
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(key_of(3), row_id_of(3), nullptr));
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key_of(3), ret, nullptr));
+  ASSERT_EQ(n / 10, ret.size());
+  for (size_t i = 0; i < ret.size(); i++) {
+    // the entries of a key are in row id order
+    ASSERT_EQ(row_id_of(i * 10 + 3), ret[i]);
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(key_of(10), ret, nullptr));
+  // ranges take every entry of their bounds, or none
+  auto count = [&](int lower, bool lower_inclusive, int upper, bool upper_inclusive) {
+    Row lower_row = key_of(lower);
+    Row upper_row = key_of(upper);
+    auto iter = index->Scan(&lower_row, lower_inclusive, &upper_row, upper_inclusive, nullptr);
+    int result = 0;
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result++;
+    }
+    return result;
+  };
+  ASSERT_EQ(n / 10 * 3, count(2, true, 4, true));
+  ASSERT_EQ(n / 10, count(2, false, 4, false));
+  ASSERT_EQ(0, count(3, false, 3, true));
+  // the same ranges backwards, the entries of a key in descending row id order
+  auto reverse_entries = [&](int lower, bool lower_inclusive, int upper, bool upper_inclusive) {
+    Row lower_row = key_of(lower);
+    Row upper_row = key_of(upper);
+    auto iter = index->ScanReverse(&lower_row, lower_inclusive, &upper_row, upper_inclusive, nullptr);
+    std::vector<RowId> result;
+    RowId row_id;
+    while (iter->Next(&row_id)) {
+      result.push_back(row_id);
+    }
+    return result;
+  };
+  auto entries = reverse_entries(2, true, 4, true);
+  ASSERT_EQ(n / 10 * 3, entries.size());
+  for (int j = 0; j < n / 10; j++) {
+    ASSERT_EQ(row_id_of((n / 10 - 1 - j) * 10 + 4), entries[j]);
+    ASSERT_EQ(row_id_of((n / 10 - 1 - j) * 10 + 2), entries[n / 10 * 2 + j]);
+  }
+  ASSERT_EQ(n / 10, reverse_entries(2, false, 4, false).size());
+  ASSERT_EQ(0, reverse_entries(3, false, 3, true).size());
+  auto newest = index->ScanReverse(nullptr, false, nullptr, false, nullptr);
+  RowId last_row_id;
+  ASSERT_TRUE(newest->Next(&last_row_id));
+  ASSERT_EQ(row_id_of(n - 1), last_row_id);
+  newest.reset();
+  // removal is by key and row id
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(key_of(3), row_id_of(13), nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(key_of(4), row_id_of(13), nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key_of(3), ret, nullptr));
+  ASSERT_EQ(n / 10 - 1, ret.size());
+  ASSERT_TRUE(std::find(ret.begin(), ret.end(), row_id_of(13)) == ret.end());
+  ASSERT_EQ(n / 10, count(4, true, 4, true));
+  for (int i = 0; i < n; i++) {
+    index->RemoveEntry(key_of(i % 10), row_id_of(i), nullptr);
+  }
+  ASSERT_EQ(0, count(0, true, 9, true));
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBloomFilterTest) {
+  // no false negatives, about 1% false positives at 10 bits per key
+  BloomFilter filter(10000, 10);
+  for (uint64_t i = 0; i < 10000; i++) {
+    filter.Add(std::hash<uint64_t>()(i) * 0x9e3779b97f4a7c15ULL);
+  }
+  int false_positives = 0;
+  for (uint64_t i = 0; i < 20000; i++) {
+    bool contained = filter.MayContain(std::hash<uint64_t>()(i) * 0x9e3779b97f4a7c15ULL);
+    if (i < 10000) {
+      ASSERT_TRUE(contained);
+    } else {
+      false_positives += contained;
+    }
+  }
+  ASSERT_LT(false_positives, 300);
+
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  for (page_id_t page_id : {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID}) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == page_id);
+    bpm_->UnpinPage(id, true);
+  }
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto key_of = [](int i) { return Row(std::vector<Field>{Field(TypeId::kTypeInt, i)}); };
+  // insert with a uniqueness check first, the way the insert executor does
+  const int n = 20000;
+  auto load = [&](BPlusTreeIndex *index) {
+    std::vector<RowId> ret;
+    auto start_time = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+      if (index->ScanKey(key_of(i * 2), ret, nullptr) != DB_KEY_NOT_FOUND) {
+        return std::chrono::steady_clock::duration::max();
+      }
+      if (index->InsertEntry(key_of(i * 2), RowId(i), nullptr) != DB_SUCCESS) {
+        return std::chrono::steady_clock::duration::max();
+      }
+    }
+    return std::chrono::steady_clock::now() - start_time;
+  };
+  auto *plain_index = new BPlusTreeIndex(0, &key_schema, 4, bpm_, true, 0);
+  auto plain_time = load(plain_index);
+  auto *index = new BPlusTreeIndex(1, &key_schema, 4, bpm_);
+  auto filtered_time = load(index);
+  ASSERT_NE(std::chrono::steady_clock::duration::max(), filtered_time);
+  ASSERT_NE(std::chrono::steady_clock::duration::max(), plain_time);
+  std::cout << "checked inserts without bloom filter: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(plain_time).count()
+            << " ms, with: " << std::chrono::duration_cast<std::chrono::milliseconds>(filtered_time).count() << " ms"
+            << std::endl;
+  auto check = [&](BPlusTreeIndex *index, int removed) {
+    std::vector<RowId> ret;
+    for (int i = 0; i < n; i++) {
+      ret.clear();
+      ASSERT_EQ(i < removed ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(key_of(i * 2), ret, nullptr));
+      ret.clear();
+      ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(key_of(i * 2 + 1), ret, nullptr));
+    }
+  };
+  check(index, 0);
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(key_of(2), RowId(1), nullptr));
+  // removes rebuild the filter without the removed keys
+  for (int i = 0; i < n * 3 / 4; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(key_of(i * 2), RowId(i), nullptr));
+  }
+  check(index, n * 3 / 4);
+  // the filter of a reopened index is built from its leaves
+  delete index;
+  index = new BPlusTreeIndex(1, &key_schema, 4, bpm_);
+  check(index, n * 3 / 4);
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  plain_index->Destroy();
+  index->Destroy();
+  delete plain_index;
+  delete index;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBatchTest) {
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  page_id_t id;
+  for (page_id_t page_id : {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID}) {
+    ASSERT_TRUE(bpm_->NewPage(id) != nullptr && id == page_id);
+    bpm_->UnpinPage(id, true);
+  }
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("status", TypeId::kTypeInt, 1, false, false)};
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> id_key_map{0};
+  std::vector<uint32_t> status_key_map{1};
+  auto *id_schema = Schema::ShallowCopySchema(&table_schema, id_key_map);
+  auto *status_schema = Schema::ShallowCopySchema(&table_schema, status_key_map);
+  KeyProjector id_projector(id_schema, id_key_map);
+  KeyProjector status_projector(status_schema, status_key_map);
+  // rows of one statement come in any key order
+  const int n = 20000;
+  std::vector<Row> rows;
+  rows.reserve(n);
+  for (int i = 0; i < n; i++) {
+    rows.emplace_back(std::vector<Field>{Field(TypeId::kTypeInt, i * 2), Field(TypeId::kTypeInt, i % 10)});
+    rows.back().SetRowId(RowId(i / 50, i % 50));
+  }
+  std::shuffle(rows.begin(), rows.end(), std::mt19937(0));
+  std::vector<const Row *> batch;
+  for (const auto &row : rows) {
+    batch.push_back(&row);
+  }
+  auto *row_index = new BPlusTreeIndex(0, id_schema, 4, bpm_);
+  auto *index = new BPlusTreeIndex(1, id_schema, 4, bpm_);
+  auto start = std::chrono::steady_clock::now();
+  for (auto row : batch) {
+    ASSERT_EQ(DB_SUCCESS, row_index->InsertRowEntry(*row, id_projector, row->GetRowId(), nullptr));
+  }
+  auto row_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  ASSERT_EQ(DB_SUCCESS, index->InsertRowEntries(batch, id_projector, nullptr));
+  auto batch_time = std::chrono::steady_clock::now() - start;
+  std::cout << "[ Batch ] " << n << " inserts, row by row "
+            << std::chrono::duration<double, std::milli>(row_time).count() << " ms, batched "
+            << std::chrono::duration<double, std::milli>(batch_time).count() << " ms" << std::endl;
+  std::vector<std::vector<RowId>> result;
+  ASSERT_EQ(DB_SUCCESS, index->ScanRowKeys(batch, id_projector, result, nullptr));
+  ASSERT_EQ(batch.size(), result.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    ASSERT_EQ(1, result[i].size());
+    ASSERT_EQ(batch[i]->GetRowId(), result[i][0]);
+  }
+  // keys taken by the index or by an earlier row of the batch are not inserted, the other rows are
+  std::vector<Row> more;
+  more.emplace_back(std::vector<Field>{Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeInt, 0)});
+  more.emplace_back(std::vector<Field>{Field(TypeId::kTypeInt, 4), Field(TypeId::kTypeInt, 0)});
+  more.emplace_back(std::vector<Field>{Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeInt, 0)});
+  more.emplace_back(std::vector<Field>{Field(TypeId::kTypeInt, n * 2 + 1), Field(TypeId::kTypeInt, 0)});
+  for (int i = 0; i < 4; i++) {
+    more[i].SetRowId(RowId(n, i));
+  }
+  std::vector<const Row *> more_batch{&more[0], &more[1], &more[2], &more[3]};
+  ASSERT_EQ(DB_FAILED, index->InsertRowEntries(more_batch, id_projector, nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->ScanRowKeys(more_batch, id_projector, result, nullptr));
+  ASSERT_EQ(RowId(n, 0), result[0][0]);
+  ASSERT_EQ(RowId(0, 2), result[1][0]);
+  ASSERT_EQ(RowId(n, 0), result[2][0]);
+  ASSERT_EQ(RowId(n, 3), result[3][0]);
+  // a non-unique index finds every entry of a key
+  auto *status_index = new BPlusTreeIndex(2, status_schema, 12, bpm_, false);
+  ASSERT_EQ(DB_SUCCESS, status_index->InsertRowEntries(batch, status_projector, nullptr));
+  std::vector<const Row *> probes(batch.begin(), batch.begin() + 100);
+  ASSERT_EQ(DB_SUCCESS, status_index->ScanRowKeys(probes, status_projector, result, nullptr));
+  for (size_t i = 0; i < probes.size(); i++) {
+    ASSERT_EQ(n / 10, result[i].size());
+    ASSERT_TRUE(std::find(result[i].begin(), result[i].end(), probes[i]->GetRowId()) != result[i].end());
+  }
+  // remove every other row, by key and row id in the non-unique index
+  std::vector<const Row *> removed;
+  std::vector<const Row *> kept;
+  for (size_t i = 0; i < batch.size(); i++) {
+    (i % 2 == 0 ? removed : kept).push_back(batch[i]);
+  }
+  ASSERT_EQ(DB_SUCCESS, index->RemoveRowEntries(removed, id_projector, nullptr));
+  ASSERT_EQ(DB_SUCCESS, status_index->RemoveRowEntries(removed, status_projector, nullptr));
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanRowKeys(removed, id_projector, result, nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->ScanRowKeys(kept, id_projector, result, nullptr));
+  for (size_t i = 0; i < kept.size(); i++) {
+    ASSERT_EQ(1, result[i].size());
+    ASSERT_EQ(kept[i]->GetRowId(), result[i][0]);
+  }
+  auto status_of = [](const Row *row) {
+    return (row->GetRowId().GetPageId() * 50 + row->GetRowId().GetSlotNum()) % 10;
+  };
+  std::vector<size_t> kept_count(10, 0);
+  for (auto row : kept) {
+    kept_count[status_of(row)]++;
+  }
+  ASSERT_EQ(DB_SUCCESS, status_index->ScanRowKeys(probes, status_projector, result, nullptr));
+  for (size_t i = 0; i < probes.size(); i++) {
+    ASSERT_EQ(kept_count[status_of(probes[i])], result[i].size());
+  }
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  row_index->Destroy();
+  index->Destroy();
+  status_index->Destroy();
+  delete row_index;
+  delete index;
+  delete status_index;
+  delete id_schema;
+  delete status_schema;
+  delete bpm_;
+  delete disk_mgr_;
+}
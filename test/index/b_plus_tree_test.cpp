@@ -1,8 +1,12 @@
 #include "index/b_plus_tree.h"
 
+#include <chrono>
+#include <random>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "index/key_sorter.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -69,4 +73,550 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+static int CountLeaves(BPlusTree &tree, BufferPoolManager *bpm) {
+  Page *page = tree.FindLeafPage(nullptr, true);
+  page_id_t page_id = page->GetPageId();
+  page->RUnlatch();
+  bpm->UnpinPage(page_id, false);
+  int leaves = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(bpm->FetchPage(page_id)->GetData());
+    bpm->UnpinPage(page_id, false);
+    page_id = leaf->GetNextPageId();
+    leaves++;
+  }
+  return leaves;
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine("bp_tree_bulk_load_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<GenericKey *> shuffled(keys);
+  ShuffleArray(shuffled);
+  // a small sort buffer spills several runs to be merged
+  auto start_time = std::chrono::steady_clock::now();
+  KeySorter sorter(KP, 32 << 10);
+  for (int i = 0; i < n; i++) {
+    int value;
+    memcpy(&value, shuffled[i], sizeof(int));
+    sorter.Add(shuffled[i], RowId(value));
+  }
+  sorter.Sort();
+  ASSERT_GT(sorter.GetSpilledRunCount(), 1);
+  ASSERT_EQ(n, sorter.GetSize());
+  BPlusTree bulk_tree(0, engine.bpm_, KP);
+  ASSERT_TRUE(bulk_tree.BulkLoad(n, [&sorter](GenericKey *key, RowId *row_id) { return sorter.Next(key, row_id); }));
+  auto bulk_time = std::chrono::steady_clock::now() - start_time;
+  ASSERT_TRUE(bulk_tree.Check());
+  // every key is found, in order when scanned
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(bulk_tree.GetValue(keys[i], ans));
+    int value;
+    memcpy(&value, keys[i], sizeof(int));
+    ASSERT_EQ(RowId(value), ans.back());
+  }
+  int i = 0;
+  for (auto iter = bulk_tree.Begin(); iter != bulk_tree.End(); ++iter, i++) {
+    ASSERT_EQ(0, KP.CompareKeys(keys[i], (*iter).first));
+  }
+  ASSERT_EQ(n, i);
+  ASSERT_TRUE(bulk_tree.Check());
+  ASSERT_FALSE(bulk_tree.BulkLoad(0, [](GenericKey *, RowId *) { return false; }));
+
+  start_time = std::chrono::steady_clock::now();
+  BPlusTree insert_tree(1, engine.bpm_, KP);
+  for (int j = 0; j < n; j++) {
+    int value;
+    memcpy(&value, shuffled[j], sizeof(int));
+    insert_tree.Insert(shuffled[j], RowId(value));
+  }
+  auto insert_time = std::chrono::steady_clock::now() - start_time;
+  int bulk_leaves = CountLeaves(bulk_tree, engine.bpm_);
+  int insert_leaves = CountLeaves(insert_tree, engine.bpm_);
+  std::cout << "bulk load: " << std::chrono::duration_cast<std::chrono::milliseconds>(bulk_time).count() << " ms, "
+            << bulk_leaves << " leaves; one by one insert: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(insert_time).count() << " ms, " << insert_leaves
+            << " leaves" << std::endl;
+  ASSERT_LT(bulk_leaves, insert_leaves);
+
+  // the bulk loaded tree takes regular removes and inserts
+  for (int j = 0; j < n; j += 2) {
+    bulk_tree.Remove(keys[j]);
+  }
+  for (int j = 0; j < n; j += 2) {
+    ASSERT_TRUE(bulk_tree.Insert(keys[j], RowId(j)));
+  }
+  ans.clear();
+  for (int j = 0; j < n; j++) {
+    ASSERT_TRUE(bulk_tree.GetValue(keys[j], ans));
+  }
+  ASSERT_TRUE(bulk_tree.Check());
+
+  // a duplicate key leaves the tree empty
+  BPlusTree dup_tree(2, engine.bpm_, KP);
+  int pos = 0;
+  auto next = [&](GenericKey *key, RowId *row_id) {
+    if (pos == n) return false;
+    int index = pos == n / 2 ? pos - 1 : pos;
+    memcpy(key, keys[index], KP.GetKeySize());
+    *row_id = RowId(index);
+    pos++;
+    return true;
+  };
+  ASSERT_FALSE(dup_tree.BulkLoad(n, next));
+  ASSERT_TRUE(dup_tree.IsEmpty());
+  ASSERT_TRUE(dup_tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, PrefixCompressionTest) {
+  DBStorageEngine engine("bp_tree_prefix_test.db");
+  std::vector<Column *> columns = {
+      new Column("name", TypeId::kTypeChar, 48, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 64);
+  BPlusTree tree(0, engine.bpm_, KP);
+  // long keys sharing a long prefix, the leaves keep it once
+  const std::string prefix = "customer/region-eu-west/account-";
+  const int n = 10000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%08d", prefix.c_str(), i * 7);
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeChar, name, strlen(name), true)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  ASSERT_FALSE(tree.Insert(keys[order[0]], RowId(0)));
+  ASSERT_TRUE(tree.Check());
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+
+  // fewer leaves than uncompressed full leaves would take
+  int leaves = CountLeaves(tree, engine.bpm_);
+  int uncompressed_capacity = (PAGE_SIZE - BPLUS_TREE_PAGE_HEADER_SIZE) / (KP.GetKeySize() + sizeof(RowId));
+  std::cout << "leaves: " << leaves << ", uncompressed full leaves: " << n / uncompressed_capacity << std::endl;
+  ASSERT_LT(leaves, n / uncompressed_capacity);
+  Page *page = tree.FindLeafPage(keys[n / 2]);
+  auto *leaf = reinterpret_cast<BPlusTreeLeafPage *>(page->GetData());
+  ASSERT_GE(leaf->GetPrefixSize(), static_cast<int>(prefix.size()));
+  page->RUnlatch();
+  engine.bpm_->UnpinPage(page->GetPageId(), false);
+
+  // removes merge and rebalance pages under new fences
+  ShuffleArray(order);
+  for (int i = 0; i < n * 3 / 4; i++) {
+    tree.Remove(keys[order[i]]);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i >= n * 3 / 4, tree.GetValue(keys[order[i]], ans));
+  }
+  int count = 0;
+  std::vector<char> last(KP.GetKeySize());
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, count++) {
+    if (count > 0) {
+      ASSERT_LT(KP.CompareKeys(reinterpret_cast<GenericKey *>(last.data()), (*iter).first), 0);
+    }
+    memcpy(last.data(), (*iter).first, KP.GetKeySize());
+  }
+  ASSERT_EQ(n - n * 3 / 4, count);
+  for (int i = 0; i < n * 3 / 4; i++) {
+    ASSERT_TRUE(tree.Insert(keys[order[i]], RowId(order[i])));
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, WideKeyTest) {
+  DBStorageEngine engine("bp_tree_wide_key_test.db");
+  std::vector<Column *> columns = {
+      new Column("email", TypeId::kTypeChar, BPlusTreePage::MAX_KEY_SIZE, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, BPlusTreePage::MAX_KEY_SIZE);
+  BPlusTree tree(0, engine.bpm_, KP);
+  // mostly short values of the widest key column, with a value of every length up to the full width in between
+  const int n = 6000;
+  std::mt19937 rng(0);
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    std::string name;
+    if (i % 20 == 0) {
+      name.resize(1 + rng() % BPlusTreePage::MAX_KEY_SIZE);
+      for (auto &c : name) {
+        c = static_cast<char>('a' + rng() % 26);
+      }
+      name += std::to_string(i);
+      name.resize(std::min<size_t>(name.size(), BPlusTreePage::MAX_KEY_SIZE));
+    } else {
+      name = "user" + std::to_string(i) + "@example.com";
+    }
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeChar, name.data(), name.size(), true)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  ASSERT_TRUE(tree.Check());
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+  }
+  // the leaves fill up by the bytes of the values, not by the width of the column
+  int leaves = CountLeaves(tree, engine.bpm_);
+  int padded_capacity = BPlusTreePage::DATA_SIZE / (KP.GetKeySize() + sizeof(RowId) + BPlusTreePage::SLOT_SIZE);
+  std::cout << "leaves: " << leaves << ", leaves of padded keys: " << n / padded_capacity << std::endl;
+  ASSERT_LT(leaves * 5, n / padded_capacity);
+
+  ShuffleArray(order);
+  for (int i = 0; i < n * 3 / 4; i++) {
+    tree.Remove(keys[order[i]]);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i >= n * 3 / 4, tree.GetValue(keys[order[i]], ans));
+  }
+  for (int i = 0; i < n * 3 / 4; i++) {
+    ASSERT_TRUE(tree.Insert(keys[order[i]], RowId(order[i])));
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+  }
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, SequentialInsertTest) {
+  DBStorageEngine engine("bp_tree_sequential_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // ascending keys are appended to the rightmost leaf, which keeps most of the page when it splits
+  auto start_time = std::chrono::steady_clock::now();
+  BPlusTree ascending_tree(0, engine.bpm_, KP);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ascending_tree.Insert(keys[i], RowId(i)));
+  }
+  auto ascending_time = std::chrono::steady_clock::now() - start_time;
+  ASSERT_FALSE(ascending_tree.Insert(keys[n - 1], RowId(0)));
+  ASSERT_TRUE(ascending_tree.Check());
+  // descending keys split every leaf evenly
+  start_time = std::chrono::steady_clock::now();
+  BPlusTree descending_tree(1, engine.bpm_, KP);
+  for (int i = n - 1; i >= 0; i--) {
+    ASSERT_TRUE(descending_tree.Insert(keys[i], RowId(i)));
+  }
+  auto descending_time = std::chrono::steady_clock::now() - start_time;
+  int ascending_leaves = CountLeaves(ascending_tree, engine.bpm_);
+  int descending_leaves = CountLeaves(descending_tree, engine.bpm_);
+  std::cout << "ascending insert: " << std::chrono::duration_cast<std::chrono::milliseconds>(ascending_time).count()
+            << " ms, " << ascending_leaves << " leaves; descending insert: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(descending_time).count() << " ms, "
+            << descending_leaves << " leaves" << std::endl;
+  ASSERT_LT(ascending_leaves * 3, descending_leaves * 2);
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ascending_tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  int count = 0;
+  for (auto iter = ascending_tree.Begin(); iter != ascending_tree.End(); ++iter, count++) {
+    ASSERT_EQ(0, KP.CompareKeys(keys[count], (*iter).first));
+  }
+  ASSERT_EQ(n, count);
+
+  // removing the tail merges the rightmost leaves away, appends find the new rightmost leaf
+  for (int i = n / 2; i < n; i++) {
+    ascending_tree.Remove(keys[i]);
+  }
+  ASSERT_TRUE(ascending_tree.Check());
+  for (int i = n / 2; i < n; i++) {
+    ASSERT_TRUE(ascending_tree.Insert(keys[i], RowId(i)));
+  }
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ascending_tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  // an emptied tree starts over
+  for (int i = 0; i < n; i++) {
+    ascending_tree.Remove(keys[i]);
+  }
+  ASSERT_TRUE(ascending_tree.IsEmpty());
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(ascending_tree.Insert(keys[i], RowId(i)));
+  }
+  ASSERT_EQ(ascending_leaves, CountLeaves(ascending_tree, engine.bpm_));
+  ASSERT_TRUE(ascending_tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, SearchTest) {
+  DBStorageEngine engine("bp_tree_search_test.db");
+  std::vector<Column *> columns = {
+      new Column("id", TypeId::kTypeInt, 0, false, false),
+      new Column("name", TypeId::kTypeChar, 16, 1, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 32);
+  BPlusTree tree(0, engine.bpm_, KP);
+  // negative and positive ids, each under a few names: runs of keys share their head
+  const int n = 6000;
+  const int names = 6;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    int id = (i / names - n / names / 2) * 3;
+    std::string name = "name-" + std::to_string(i % names);
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()),
+                                                                 name.size(), true)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  ASSERT_TRUE(tree.Check());
+  auto start_time = std::chrono::steady_clock::now();
+  vector<RowId> ans;
+  for (int round = 0; round < 10; round++) {
+    for (int i : order) {
+      ASSERT_TRUE(tree.GetValue(keys[i], ans));
+      ASSERT_EQ(RowId(i), ans.back());
+    }
+  }
+  auto lookup_time = std::chrono::steady_clock::now() - start_time;
+  std::cout << "search kernel: " << BPlusTreePage::GetSearchKernel() << ", " << n * 10 << " lookups: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(lookup_time).count() << " ms" << std::endl;
+  // keys between the stored ones are not found, a scan from them starts at the next stored key
+  for (int i = 0; i + names < n; i += names) {
+    int id = (i / names - n / names / 2) * 3 + 1;
+    std::string name = "name-" + std::to_string(names);
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()),
+                                                                 name.size(), true)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    ASSERT_FALSE(tree.GetValue(key, ans));
+    auto iter = tree.Begin(key);
+    ASSERT_TRUE(iter != tree.End());
+    ASSERT_EQ(RowId(i + names), (*iter).second);
+    free(key);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, LazyMergeTest) {
+  DBStorageEngine engine("bp_tree_lazy_merge_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  // merged as soon as half empty, and at the default threshold
+  BPlusTree eager_tree(0, engine.bpm_, KP, UNDEFINED_SIZE, UNDEFINED_SIZE, 0.5);
+  BPlusTree lazy_tree(1, engine.bpm_, KP);
+  for (int i : order) {
+    ASSERT_TRUE(eager_tree.Insert(keys[i], RowId(i)));
+    ASSERT_TRUE(lazy_tree.Insert(keys[i], RowId(i)));
+  }
+  // remove every other key of the middle half and insert them again, a few times over
+  uint64_t eager_changes = eager_tree.GetSplitCount() + eager_tree.GetMergeCount();
+  uint64_t lazy_changes = lazy_tree.GetSplitCount() + lazy_tree.GetMergeCount();
+  for (int round = 0; round < 4; round++) {
+    for (auto *tree : {&eager_tree, &lazy_tree}) {
+      for (int i = n / 4 + round % 2; i < n * 3 / 4; i += 2) {
+        tree->Remove(keys[i]);
+      }
+      for (int i = n / 4 + round % 2; i < n * 3 / 4; i += 2) {
+        ASSERT_TRUE(tree->Insert(keys[i], RowId(i)));
+      }
+    }
+  }
+  eager_changes = eager_tree.GetSplitCount() + eager_tree.GetMergeCount() - eager_changes;
+  lazy_changes = lazy_tree.GetSplitCount() + lazy_tree.GetMergeCount() - lazy_changes;
+  std::cout << "splits and merges of remove/insert rounds, eager: " << eager_changes << ", lazy: " << lazy_changes
+            << std::endl;
+  ASSERT_LT(lazy_changes * 2, eager_changes);
+  ASSERT_TRUE(eager_tree.Check());
+  ASSERT_TRUE(lazy_tree.Check());
+
+  // underfull leaves are left behind by removes, a vacuum packs them again
+  for (int i = 0; i < n; i++) {
+    if (i % 4 != 0) {
+      lazy_tree.Remove(keys[i]);
+    }
+  }
+  int leaves = CountLeaves(lazy_tree, engine.bpm_);
+  int released = lazy_tree.Vacuum();
+  ASSERT_GT(released, 0);
+  ASSERT_LT(CountLeaves(lazy_tree, engine.bpm_), leaves);
+  ASSERT_TRUE(lazy_tree.Check());
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_EQ(i % 4 == 0, lazy_tree.GetValue(keys[i], ans));
+    if (i % 4 == 0) {
+      ASSERT_EQ(RowId(i), ans[0]);
+    }
+  }
+  int count = 0;
+  for (auto iter = lazy_tree.Begin(); iter != lazy_tree.End(); ++iter) {
+    ASSERT_EQ(RowId(count * 4), (*iter).second);
+    count++;
+  }
+  ASSERT_EQ(n / 4, count);
+  // the rebuilt tree takes inserts and removes as usual
+  for (int i = 1; i < n; i += 4) {
+    ASSERT_TRUE(lazy_tree.Insert(keys[i], RowId(i)));
+  }
+  for (int i = 0; i < n; i += 4) {
+    lazy_tree.Remove(keys[i]);
+  }
+  ASSERT_TRUE(lazy_tree.Check());
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_EQ(i % 4 == 1, lazy_tree.GetValue(keys[i], ans));
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, StatsTest) {
+  DBStorageEngine engine("bp_tree_stats_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  IndexStats stats = tree.GetStats();
+  ASSERT_EQ(0, stats.height_);
+  ASSERT_EQ(0, stats.leaf_pages_ + stats.internal_pages_ + stats.entries_);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int i : order) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  stats = tree.GetStats();
+  ASSERT_EQ(n, stats.entries_);
+  ASSERT_EQ(CountLeaves(tree, engine.bpm_), stats.leaf_pages_);
+  ASSERT_GE(stats.height_, 2);
+  ASSERT_GE(stats.internal_pages_, 1);
+  // every page but the first leaf and the first root comes from a split
+  ASSERT_EQ(stats.leaf_pages_ + stats.internal_pages_ - 2, stats.splits_);
+  // random inserts leave the leaves between half and fully filled
+  ASSERT_GT(stats.leaf_fill_factor_, 0.5);
+  ASSERT_LE(stats.leaf_fill_factor_, 1.0);
+  ASSERT_GT(stats.internal_fill_factor_, 0.0);
+  double full = stats.leaf_fill_factor_;
+  // removes leave the leaves bloated until a vacuum packs them again
+  for (int i = 0; i < n; i++) {
+    if (i % 4 != 0) {
+      tree.Remove(keys[i]);
+    }
+  }
+  stats = tree.GetStats();
+  ASSERT_EQ(n / 4, stats.entries_);
+  ASSERT_LT(stats.leaf_fill_factor_, full);
+  uint64_t leaves = stats.leaf_pages_;
+  tree.Vacuum();
+  stats = tree.GetStats();
+  ASSERT_EQ(n / 4, stats.entries_);
+  ASSERT_LT(stats.leaf_pages_, leaves);
+  ASSERT_GT(stats.leaf_fill_factor_, INDEX_FILL_FACTOR - 0.1);
+  std::cout << "height " << stats.height_ << ", " << stats.leaf_pages_ << " leaves and " << stats.internal_pages_
+            << " internal pages after vacuum, leaf fill " << stats.leaf_fill_factor_ << std::endl;
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
@@ -0,0 +1,114 @@
+#include "index/hash_index.h"
+
+#include <algorithm>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+static Row IntKey(int i) { return Row(std::vector<Field>{Field(TypeId::kTypeInt, i)}); }
+
+TEST(HashIndexTests, UniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new HashIndex(0, &key_schema, 4, engine.bpm_);
+  const int n = 20000;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(key), RowId(key), nullptr));
+  }
+  // the directory grew as the buckets split
+  ASSERT_LT(0, index->GetGlobalDepth());
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(IntKey(7), RowId(n), nullptr));
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(i), ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(i), ret[0]);
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(IntKey(n), ret, nullptr));
+  // ranges read every bucket, in no order
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(100), ret, nullptr, "<"));
+  std::sort(ret.begin(), ret.end(), [](const RowId &a, const RowId &b) { return a.Get() < b.Get(); });
+  ASSERT_EQ(100, ret.size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(RowId(i), ret[i]);
+  }
+  // removal is by key and row id
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(IntKey(5), RowId(6), nullptr));
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(5), ret, nullptr));
+  for (int i = 0; i < n; i += 2) {
+    index->RemoveEntry(IntKey(i), RowId(i), nullptr);
+  }
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(IntKey(i), ret, nullptr));
+  }
+  // emptied buckets merge back and the directory shrinks
+  uint32_t depth = index->GetGlobalDepth();
+  for (int i = 1; i < n; i += 2) {
+    index->RemoveEntry(IntKey(i), RowId(i), nullptr);
+  }
+  ASSERT_GT(depth, index->GetGlobalDepth());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+}
+
+TEST(HashIndexTests, NonUniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new HashIndex(0, &key_schema, 4, engine.bpm_, false);
+  // a few keys with many rows each: their buckets can not be split and take overflow pages
+  const int n = 6000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(i % 3), RowId(i), nullptr));
+  }
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(IntKey(1), RowId(1), nullptr));
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(1), ret, nullptr));
+  ASSERT_EQ(n / 3, ret.size());
+  // equality scans read a single bucket chain and keep the keys
+  {
+    Row key = IntKey(2);
+    auto iter = index->Scan(&key, true, &key, true, nullptr);
+    RowId row_id;
+    Row entry_key;
+    int count = 0;
+    while (iter->NextEntry(&row_id, &entry_key)) {
+      ASSERT_EQ(2, row_id.Get() % 3);
+      ASSERT_EQ(CmpBool::kTrue, entry_key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 2)));
+      count++;
+    }
+    ASSERT_EQ(n / 3, count);
+  }
+  for (int i = 0; i < n; i++) {
+    if (i % 3 == 1) {
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(IntKey(1), RowId(i), nullptr));
+    }
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(IntKey(1), ret, nullptr));
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(0), ret, nullptr));
+  ASSERT_EQ(n / 3, ret.size());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // the directory is found again through the index roots page
+  auto *reopened = new HashIndex(0, &key_schema, 4, engine.bpm_, false);
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, reopened->ScanKey(IntKey(2), ret, nullptr));
+  ASSERT_EQ(n / 3, ret.size());
+  delete reopened;
+  index->Destroy();
+  delete index;
+}
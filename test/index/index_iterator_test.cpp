@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <random>
+#include <set>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/b_plus_tree.h"
@@ -54,3 +58,77 @@ TEST(BPlusTreeTests, IndexIteratorTest) {
   }
   ASSERT_EQ(25, i);
 }
+
+TEST(BPlusTreeTests, ReverseIndexIteratorTest) {
+  DBStorageEngine engine("bp_tree_reverse_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  ASSERT_TRUE(tree.RBegin() == tree.End());
+  auto key_of = [&](int i) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    return key;
+  };
+  // even keys, inserted in random order, then a third of them removed: leaves split, merge and borrow
+  const int n = 10000;
+  vector<int> order;
+  for (int i = 0; i < n; i++) {
+    order.push_back(i);
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(7));
+  for (int i : order) {
+    GenericKey *key = key_of(i * 2);
+    ASSERT_TRUE(tree.Insert(key, RowId(i)));
+    free(key);
+  }
+  std::set<int> removed;
+  for (int j = 0; j < n / 3; j++) {
+    GenericKey *key = key_of(order[j] * 2);
+    tree.Remove(key);
+    removed.insert(order[j]);
+    free(key);
+  }
+  ASSERT_TRUE(tree.Check());
+  // the whole tree backwards
+  vector<int> expected;
+  for (int i = n - 1; i >= 0; i--) {
+    if (removed.count(i) == 0) {
+      expected.push_back(i);
+    }
+  }
+  size_t count = 0;
+  for (auto iter = tree.RBegin(); iter != tree.End(); --iter, count++) {
+    ASSERT_LT(count, expected.size());
+    ASSERT_EQ(RowId(expected[count]), (*iter).second);
+  }
+  ASSERT_EQ(expected.size(), count);
+  // from a stored key, and from a key between two stored ones
+  for (int i = 0; i < n; i += 97) {
+    for (int k : {i * 2, i * 2 + 1}) {
+      GenericKey *key = key_of(k);
+      auto iter = tree.RBegin(key);
+      auto first = std::find_if(expected.begin(), expected.end(), [&](int e) { return e * 2 <= k; });
+      if (first == expected.end()) {
+        ASSERT_TRUE(iter == tree.End());
+      } else {
+        ASSERT_EQ(RowId(*first), (*iter).second);
+        --iter;
+        if (first + 1 == expected.end()) {
+          ASSERT_TRUE(iter == tree.End());
+        } else {
+          ASSERT_EQ(RowId(*(first + 1)), (*iter).second);
+        }
+      }
+      free(key);
+    }
+  }
+  GenericKey *key = key_of(-1);
+  ASSERT_TRUE(tree.RBegin(key) == tree.End());
+  free(key);
+  ASSERT_TRUE(tree.Check());
+}
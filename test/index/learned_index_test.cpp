@@ -0,0 +1,162 @@
+#include "index/learned_index.h"
+
+#include <random>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "learned_index_test.db";
+
+static Row IntKey(int i) { return Row(std::vector<Field>{Field(TypeId::kTypeInt, i)}); }
+
+TEST(LearnedIndexTests, UniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new LearnedIndex(0, &key_schema, 4, engine.bpm_);
+  const int n = 20000;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i * 3 - n;
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(key), RowId(key + n), nullptr));
+  }
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(IntKey(keys[0]), RowId(0), nullptr));
+  ASSERT_LT(0, index->GetRebuildCount());
+  index->Rebuild();
+  // evenly spaced keys lie on a single line
+  ASSERT_EQ(1, index->GetSegmentCount());
+  ASSERT_EQ(0, index->GetDeltaSize());
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(i * 3 - n), ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(i * 3), ret[0]);
+    ret.clear();
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(IntKey(i * 3 - n + 1), ret, nullptr));
+  }
+  // ranges come in key order, negative keys first
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(-n + 300), ret, nullptr, "<"));
+  ASSERT_EQ(100, ret.size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(RowId(i * 3), ret[i]);
+  }
+  // removes and inserts are merged in until the next rebuild
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(IntKey(i * 3 - n), RowId(i * 3), nullptr));
+  }
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(-n + 1), RowId(1), nullptr));
+  Row lower = IntKey(-n);
+  Row upper = IntKey(-n + 30);
+  auto scan = index->Scan(&lower, true, &upper, false, nullptr);
+  std::vector<RowId> expected = {RowId(1), RowId(3), RowId(9), RowId(15), RowId(21), RowId(27)};
+  RowId row_id;
+  for (auto &value : expected) {
+    ASSERT_TRUE(scan->Next(&row_id));
+    ASSERT_EQ(value, row_id);
+  }
+  ASSERT_FALSE(scan->Next(&row_id));
+  scan.reset();
+
+  // the delta is folded in when the index is closed, the model is read back from its pages
+  delete index;
+  index = new LearnedIndex(0, &key_schema, 4, engine.bpm_);
+  ASSERT_EQ(0, index->GetDeltaSize());
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(IntKey(i * 3 - n), ret, nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(-n + 1), ret, nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+}
+
+TEST(LearnedIndexTests, RandomKeysTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new LearnedIndex(0, &key_schema, 4, engine.bpm_);
+  const int n = 50000;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> dist(-1000000000, 1000000000);
+  std::set<int> keys;
+  while (keys.size() < n) {
+    int key = dist(rng);
+    if (keys.insert(key).second) {
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(key), RowId(key), nullptr));
+    }
+  }
+  index->Rebuild();
+  std::cout << "segments: " << index->GetSegmentCount() << ", model bytes: " << index->GetModelSize() << std::endl;
+  // a few segments cover thousands of keys
+  ASSERT_GT(n / 256, index->GetSegmentCount());
+  ASSERT_GT(n, index->GetModelSize());
+  for (int key : keys) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(key), ret, nullptr));
+    ASSERT_EQ(RowId(key), ret[0]);
+  }
+  // every range starts at the right place, whether its bound is a key or not
+  for (int i = 0; i < 1000; i++) {
+    int bound = dist(rng);
+    Row lower = IntKey(bound);
+    auto scan = index->Scan(&lower, false, nullptr, false, nullptr);
+    RowId row_id;
+    auto expected = keys.upper_bound(bound);
+    for (int j = 0; j < 3 && expected != keys.end(); j++, ++expected) {
+      ASSERT_TRUE(scan->Next(&row_id));
+      ASSERT_EQ(RowId(*expected), row_id);
+    }
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+}
+
+TEST(LearnedIndexTests, NonUniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new LearnedIndex(0, &key_schema, 4, engine.bpm_, false);
+  const int n = 6000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(i % 3 * 100), RowId(i), nullptr));
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(100), ret, nullptr));
+  ASSERT_EQ(n / 3, ret.size());
+  ret.clear();
+  // keys between the long runs of one key are found missing
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(IntKey(50), ret, nullptr));
+  // an entry is removed by key and row id
+  for (int i = 0; i < n; i += 6) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(IntKey(i % 3 * 100), RowId(i), nullptr));
+  }
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(0), ret, nullptr));
+  ASSERT_EQ(n / 6, ret.size());
+  int pages_released;
+  ASSERT_EQ(DB_SUCCESS, index->Vacuum(&pages_released, nullptr));
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(0), ret, nullptr));
+  ASSERT_EQ(n / 6, ret.size());
+  // a range scan restores the keys of its entries
+  Row lower = IntKey(1);
+  auto scan = index->Scan(&lower, true, nullptr, false, nullptr);
+  RowId row_id;
+  Row key;
+  int count = 0;
+  while (scan->NextEntry(&row_id, &key)) {
+    ASSERT_EQ(CmpBool::kTrue, key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count < n / 3 ? 100 : 200)));
+    count++;
+  }
+  ASSERT_EQ(n / 3 * 2, count);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+}
@@ -0,0 +1,122 @@
+#include "index/lsm_index.h"
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "lsm_index_test.db";
+
+static Row IntKey(int i) { return Row(std::vector<Field>{Field(TypeId::kTypeInt, i)}); }
+
+TEST(LsmIndexTests, UniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  // a small memtable is written out many times
+  const uint32_t memtable_size = 16 << 10;
+  auto *index = new LsmIndex(0, &key_schema, 4, engine.bpm_, true, memtable_size);
+  const int n = 20000;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(key), RowId(key), nullptr));
+  }
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(IntKey(7), RowId(n), nullptr));
+  index->GetContainer().WaitForCompaction();
+  std::cout << "flushes: " << index->GetContainer().GetFlushCount()
+            << ", compactions: " << index->GetContainer().GetCompactionCount()
+            << ", runs: " << index->GetContainer().GetRunCount() << std::endl;
+  ASSERT_LT(10, index->GetContainer().GetFlushCount());
+  ASSERT_LT(0, index->GetContainer().GetCompactionCount());
+  ASSERT_GT(8, index->GetContainer().GetRunCount());
+  for (int i = 0; i < n; i++) {
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(i), ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(i), ret[0]);
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(IntKey(n), ret, nullptr));
+  // ranges come in key order
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(100), ret, nullptr, "<"));
+  ASSERT_EQ(100, ret.size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(RowId(i), ret[i]);
+  }
+  // removes hide the entries of the older runs
+  for (int i = 0; i < n; i += 2) {
+    index->RemoveEntry(IntKey(i), RowId(i), nullptr);
+  }
+  ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(10), RowId(n + 10), nullptr));
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 && i != 10 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(IntKey(i), ret, nullptr));
+  }
+  Row lower = IntKey(n / 2);
+  Row upper = IntKey(n / 2 + 100);
+  auto scan = index->Scan(&lower, false, &upper, true, nullptr);
+  RowId row_id;
+  int count = 0;
+  for (int i = n / 2 + 1; scan->Next(&row_id); i += 2) {
+    ASSERT_EQ(RowId(i), row_id);
+    count++;
+  }
+  ASSERT_EQ(50, count);
+
+  // the memtable is written out when the index is closed, the runs are found again through the manifest
+  index->GetContainer().WaitForCompaction();
+  delete index;
+  index = new LsmIndex(0, &key_schema, 4, engine.bpm_, true, memtable_size);
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 && i != 10 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(IntKey(i), ret, nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(10), ret, nullptr));
+  ASSERT_EQ(RowId(n + 10), ret[0]);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+}
+
+TEST(LsmIndexTests, NonUniqueTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("status", TypeId::kTypeInt, 0, false, false)};
+  TableSchema key_schema(columns);
+  auto *index = new LsmIndex(0, &key_schema, 12, engine.bpm_, false, 16 << 10);
+  const int n = 6000;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(IntKey(i % 3), RowId(i), nullptr));
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(1), ret, nullptr));
+  ASSERT_EQ(n / 3, ret.size());
+  for (int i = 0; i < n / 3; i++) {
+    ASSERT_EQ(RowId(i * 3 + 1), ret[i]);
+  }
+  // an entry is removed by key and row id
+  for (int i = 0; i < n; i += 6) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(IntKey(i % 3), RowId(i), nullptr));
+  }
+  index->GetContainer().WaitForCompaction();
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(IntKey(0), ret, nullptr));
+  ASSERT_EQ(n / 6, ret.size());
+  // a range scan restores the keys of its entries
+  Row lower = IntKey(1);
+  auto scan = index->Scan(&lower, true, nullptr, false, nullptr);
+  RowId row_id;
+  Row key;
+  int count = 0;
+  while (scan->NextEntry(&row_id, &key)) {
+    ASSERT_EQ(CmpBool::kTrue, key.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count < n / 3 ? 1 : 2)));
+    count++;
+  }
+  ASSERT_EQ(n / 3 * 2, count);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+  delete index;
+}
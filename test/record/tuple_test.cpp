@@ -93,11 +93,58 @@ TEST(TupleTest, RowTest) {
   ASSERT_EQ(row.GetRowId(), first_tuple_rid);
   Row row2(row.GetRowId());
   ASSERT_TRUE(table_page.GetTuple(&row2, schema.get(), nullptr, nullptr));
-  std::vector<Field *> &row2_fields = row2.GetFields();
+  std::vector<Field> &row2_fields = row2.GetFields();
   ASSERT_EQ(3, row2_fields.size());
   for (size_t i = 0; i < row2_fields.size(); i++) {
-    ASSERT_EQ(CmpBool::kTrue, row2_fields[i]->CompareEquals(fields[i]));
+    ASSERT_EQ(CmpBool::kTrue, row2_fields[i].CompareEquals(fields[i]));
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+  // char values may fill their column but not go past it
+  ASSERT_EQ(nullptr, row.GetOverlongColumn(schema.get()));
+  std::string full(64, 'a');
+  std::vector<Field> full_fields = {Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar, &full[0], 64, false),
+                                    Field(TypeId::kTypeFloat)};
+  ASSERT_EQ(nullptr, Row(full_fields).GetOverlongColumn(schema.get()));
+  std::string too_long(65, 'a');
+  std::vector<Field> long_fields = {Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar, &too_long[0], 65, false),
+                                    Field(TypeId::kTypeFloat)};
+  ASSERT_EQ(schema->GetColumn(1), Row(long_fields).GetOverlongColumn(schema.get()));
+}
+TEST(TupleTest, FieldCopyMoveTest) {
+  char short_str[] = "minisql";
+  char long_str[] = "a char value longer than the inline buffer";
+  ASSERT_LE(strlen(short_str), Field::INLINE_LEN);
+  ASSERT_GT(strlen(long_str), Field::INLINE_LEN);
+  Field short_field(TypeId::kTypeChar, short_str, strlen(short_str), true);
+  Field long_field(TypeId::kTypeChar, long_str, strlen(long_str), true);
+  // Owned values are copies, changing the source buffer does not affect them
+  short_str[0] = long_str[0] = '#';
+  ASSERT_EQ("minisql", short_field.toString());
+  ASSERT_EQ('a', long_field.GetData()[0]);
+  // Copies are deep, moves take the buffer over
+  Field short_copy(short_field);
+  Field long_copy(long_field);
+  ASSERT_NE(long_field.GetData(), long_copy.GetData());
+  ASSERT_EQ(CmpBool::kTrue, long_copy.CompareEquals(long_field));
+  const char *long_data = long_copy.GetData();
+  Field long_moved(std::move(long_copy));
+  ASSERT_EQ(long_data, long_moved.GetData());
+  Field short_moved(std::move(short_copy));
+  ASSERT_EQ(CmpBool::kTrue, short_moved.CompareEquals(short_field));
+  // Assignment copies and leaves the source untouched
+  Field assigned(TypeId::kTypeInt, 1);
+  assigned = long_moved;
+  ASSERT_EQ(CmpBool::kTrue, assigned.CompareEquals(long_field));
+  ASSERT_EQ(CmpBool::kTrue, long_moved.CompareEquals(long_field));
+  // Rows hold their fields by value and move them as a whole
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 7), short_field, long_field};
+  Row row(std::move(fields));
+  const char *row_data = row.GetField(2)->GetData();
+  Row moved_row(std::move(row));
+  ASSERT_EQ(3, moved_row.GetFieldCount());
+  ASSERT_EQ(row_data, moved_row.GetField(2)->GetData());
+  Row copied_row(moved_row);
+  ASSERT_NE(row_data, copied_row.GetField(2)->GetData());
+  ASSERT_EQ(CmpBool::kTrue, copied_row.GetField(1)->CompareEquals(short_field));
+}
@@ -61,3 +61,230 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+static uint32_t CountTablePages(BufferPoolManager *bpm, page_id_t first_page_id) {
+  uint32_t count = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; count++) {
+    auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return count;
+}
+
+TEST(TableHeapTest, TableHeapVacuumTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 5000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::unordered_map<int64_t, int32_t> rid_to_id;
+  char characters[64];
+  RandomUtils::RandomString(characters, 64);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rid_to_id.emplace(row.GetRowId().Get(), i);
+  }
+  uint32_t pages_before = CountTablePages(bpm_, table_heap->GetFirstPageId());
+  // Delete 9 of every 10 rows
+  for (auto it = rid_to_id.begin(); it != rid_to_id.end();) {
+    if (it->second % 10 != 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(RowId(it->first), nullptr));
+      it = rid_to_id.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ASSERT_EQ(row_nums - row_nums / 10, table_heap->GetDeadTupleCount());
+  std::vector<std::pair<RowId, RowId>> moved_rows;
+  uint32_t released = table_heap->Vacuum(nullptr, &moved_rows);
+  uint32_t pages_after = CountTablePages(bpm_, table_heap->GetFirstPageId());
+  ASSERT_EQ(0, table_heap->GetDeadTupleCount());
+  ASSERT_EQ(pages_before - released, pages_after);
+  ASSERT_LE(pages_after, pages_before / 5);
+  // Re-point the moved rows
+  for (const auto &moved : moved_rows) {
+    auto it = rid_to_id.find(moved.first.Get());
+    ASSERT_TRUE(it != rid_to_id.end());
+    int32_t id = it->second;
+    rid_to_id.erase(it);
+    rid_to_id.emplace(moved.second.Get(), id);
+  }
+  // Every live row is still reachable by its (new) RowId, and a scan sees only live rows
+  for (auto rid_kv : rid_to_id) {
+    Row row(RowId(rid_kv.first));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rid_kv.second)));
+  }
+  uint32_t scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    scanned++;
+  }
+  ASSERT_EQ(rid_to_id.size(), scanned);
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+static uint32_t GetAllocatedPages(DiskManager *disk_mgr) {
+  return reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData())->GetAllocatedPages();
+}
+
+TEST(TableHeapTest, TableHeapPaxLayoutTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr, TableLayout::kPax);
+  std::unordered_map<int64_t, int32_t> rid_to_id;
+  for (int i = 0; i < row_nums; i++) {
+    int32_t len = RandomUtils::RandomInt(0, 32);
+    char characters[32];
+    RandomUtils::RandomString(characters, len);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, len, true),
+                  i % 7 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rid_to_id.emplace(row.GetRowId().Get(), i);
+  }
+  // Values longer than the declared column length do not fit a PAX slot, no page is added for them
+  char too_long[33];
+  RandomUtils::RandomString(too_long, 33);
+  Fields wide{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, too_long, 33, true), Field(TypeId::kTypeFloat)};
+  Row wide_row(wide);
+  uint32_t pages_before = GetAllocatedPages(disk_mgr_);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_FALSE(table_heap->InsertTuple(wide_row, nullptr));
+  }
+  ASSERT_EQ(pages_before, GetAllocatedPages(disk_mgr_));
+  // Point reads and full scans assemble whole rows
+  for (auto rid_kv : rid_to_id) {
+    Row row(RowId(rid_kv.first));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rid_kv.second)));
+    ASSERT_EQ(rid_kv.second % 7 == 0, row.GetField(2)->IsNull());
+  }
+  uint32_t scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    scanned++;
+  }
+  ASSERT_EQ(row_nums, scanned);
+  // Column scan: the filter only sees the id column, qualifying rows come back complete
+  std::vector<uint32_t> filter_columns{0};
+  auto filter = [](const Row &row) {
+    EXPECT_TRUE(row.GetField(1)->IsNull());
+    return row.GetField(0)->CompareLessThan(Field(TypeId::kTypeInt, 100)) == CmpBool::kTrue;
+  };
+  std::vector<Row> rows;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+    page_id = table_heap->ScanPaxPage(page_id, filter_columns, filter, &rows, nullptr);
+  }
+  ASSERT_EQ(100, rows.size());
+  for (auto &row : rows) {
+    ASSERT_EQ(CmpBool::kTrue,
+              row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rid_to_id[row.GetRowId().Get()])));
+    ASSERT_EQ(3, row.GetFieldCount());
+  }
+  // Deleted tuples disappear from scans and vacuum packs the remaining ones
+  for (auto rid_kv : rid_to_id) {
+    if (rid_kv.second % 2 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(RowId(rid_kv.first), nullptr));
+    }
+  }
+  std::vector<std::pair<RowId, RowId>> moved_rows;
+  ASSERT_LT(0, table_heap->Vacuum(nullptr, &moved_rows));
+  scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    ASSERT_EQ(1, std::stoi(iter->GetField(0)->toString()) % 2);
+    scanned++;
+  }
+  ASSERT_EQ(row_nums / 2, scanned);
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+}
+
+TEST(TableHeapTest, TableHeapOverflowTest) {
+  remove(db_file_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_file_name);
+  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  const int row_nums = 200;
+  const uint32_t body_len = 3 * PAGE_SIZE;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("tag", TypeId::kTypeChar, 16, 1, true, false),
+                                   new Column("body", TypeId::kTypeChar, body_len, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  uint32_t pages_before = GetAllocatedPages(disk_mgr_);
+  std::vector<std::string> bodies(row_nums);
+  std::unordered_map<int64_t, int32_t> rid_to_id;
+  char tag[16];
+  RandomUtils::RandomString(tag, 16);
+  for (int i = 0; i < row_nums; i++) {
+    uint32_t len = OVERFLOW_THRESHOLD + 1 + RandomUtils::RandomInt(0, body_len - OVERFLOW_THRESHOLD - 1);
+    bodies[i].resize(len);
+    RandomUtils::RandomString(&bodies[i][0], len);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, tag, 16, false),
+                  Field(TypeId::kTypeChar, &bodies[i][0], len, false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    // The caller's row keeps its values
+    ASSERT_FALSE(row.GetField(2)->IsOverflow());
+    rid_to_id.emplace(row.GetRowId().Get(), i);
+  }
+  // Only the references live in the heap, so a page holds dozens of rows
+  ASSERT_LE(CountTablePages(bpm_, table_heap->GetFirstPageId()), row_nums / 50);
+  for (auto rid_kv : rid_to_id) {
+    Row row(RowId(rid_kv.first));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    const std::string &body = bodies[rid_kv.second];
+    ASSERT_FALSE(row.GetField(2)->IsOverflow());
+    ASSERT_EQ(body.size(), row.GetField(2)->GetLength());
+    ASSERT_EQ(0, memcmp(body.data(), row.GetField(2)->GetData(), body.size()));
+  }
+  // A lazy scan reads the long values only when asked to
+  std::vector<uint32_t> body_column{2};
+  uint32_t scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr, false); iter != table_heap->End(); ++iter) {
+    ASSERT_TRUE(iter->GetField(2)->IsOverflow());
+    ASSERT_EQ(0, memcmp(tag, iter->GetField(1)->GetData(), 16));
+    table_heap->LoadOverflowFields(iter.operator->(), &body_column);
+    const std::string &body = bodies[rid_to_id[iter->GetRowId().Get()]];
+    ASSERT_EQ(0, memcmp(body.data(), iter->GetField(2)->GetData(), body.size()));
+    scanned++;
+  }
+  ASSERT_EQ(row_nums, scanned);
+  // Update in place with another long value, the old overflow pages are released
+  RowId update_rid(rid_to_id.begin()->first);
+  int32_t update_id = rid_to_id.begin()->second;
+  uint32_t pages_in_use = GetAllocatedPages(disk_mgr_);
+  std::string new_body(bodies[update_id].size(), 'x');
+  Fields new_fields{Field(TypeId::kTypeInt, update_id), Field(TypeId::kTypeChar, tag, 16, false),
+                    Field(TypeId::kTypeChar, &new_body[0], new_body.size(), false)};
+  Row new_row(new_fields);
+  ASSERT_TRUE(table_heap->UpdateTuple(new_row, update_rid, nullptr));
+  ASSERT_EQ(pages_in_use, GetAllocatedPages(disk_mgr_));
+  Row updated_row(update_rid);
+  ASSERT_TRUE(table_heap->GetTuple(&updated_row, nullptr));
+  ASSERT_EQ(0, memcmp(new_body.data(), updated_row.GetField(2)->GetData(), new_body.size()));
+  // Deleted tuples give their overflow pages back on vacuum
+  for (auto rid_kv : rid_to_id) {
+    ASSERT_TRUE(table_heap->MarkDelete(RowId(rid_kv.first), nullptr));
+  }
+  table_heap->Vacuum(nullptr, nullptr);
+  ASSERT_EQ(pages_before, GetAllocatedPages(disk_mgr_));
+  ASSERT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+}